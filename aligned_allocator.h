@@ -0,0 +1,99 @@
+/***********************************************************************
+ * Module:
+ *    Aligned Allocator
+ * Summary:
+ *    An allocator whose blocks start on a cache line (or any power
+ *    of two), so SIMD code can use aligned loads on a vector's elements
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       aligned_allocator     : blocks aligned to ALIGNMENT bytes,
+ *                               optionally padded to whole lines
+ *
+ *    The alignment is Align or alignof(T), whichever is more, so an
+ *    alignas(64) element is never short-changed.  With PadToLine, every
+ *    block is rounded up to a whole number of lines and good_size says
+ *    how many elements that really holds; vector::reserve takes that as
+ *    its capacity, so a SIMD loop may read the last line whole.
+ *
+ *    For a stack:
+ *       custom::stack<float, custom::vector<float, custom::aligned_allocator<float>>>
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>      // for size_t
+#include <limits>       // for std::numeric_limits
+#include <new>          // for std::align_val_t, std::bad_alloc
+#include <type_traits>  // for std::true_type
+
+namespace custom
+{
+
+   /**************************************************
+    * ALIGNED ALLOCATOR
+    * Every block starts on an ALIGNMENT-byte boundary
+    *************************************************/
+   template <class T, size_t Align = 64, bool PadToLine = true>
+   class aligned_allocator
+   {
+   public:
+      using value_type = T;
+      using is_always_equal = std::true_type;
+
+      static const size_t ALIGNMENT = Align > alignof(T) ? Align : alignof(T);
+      static_assert((ALIGNMENT & (ALIGNMENT - 1)) == 0, "alignment must be a power of two");
+
+      // the size and padding are not type parameters, so say how to rebind
+      template <class U>
+      struct rebind
+      {
+         using other = aligned_allocator<U, Align, PadToLine>;
+      };
+
+      aligned_allocator() {}
+      template <class U>
+      aligned_allocator(const aligned_allocator<U, Align, PadToLine>&) {}
+
+      T* allocate(size_t num)
+      {
+         void* p = ::operator new(bytesFor(num), std::align_val_t(ALIGNMENT));
+         return static_cast<T*>(p);
+      }
+      void deallocate(T* p, size_t)
+      {
+         ::operator delete(p, std::align_val_t(ALIGNMENT));
+      }
+
+      // how many elements the block for num holds, padding and all
+      size_t good_size(size_t num) const
+      {
+         return bytesFor(num) / sizeof(T);
+      }
+
+      template <class U>
+      bool operator == (const aligned_allocator<U, Align, PadToLine>&) const { return true; }
+      template <class U>
+      bool operator != (const aligned_allocator<U, Align, PadToLine>&) const { return false; }
+
+   private:
+      static size_t bytesFor(size_t num)
+      {
+         if (num > (std::numeric_limits<size_t>::max() - ALIGNMENT) / sizeof(T))
+            throw std::bad_alloc();
+         size_t numBytes = num * sizeof(T);
+         if (PadToLine)
+            numBytes = (numBytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+         return numBytes;
+      }
+   };
+
+} // custom namespace
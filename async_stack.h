@@ -0,0 +1,422 @@
+/***********************************************************************
+ * Module:
+ *    Async Stack
+ * Summary:
+ *    A stack that a coroutine can wait on, and the executors to run
+ *    the coroutines that wait
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       executor              : somewhere to resume a coroutine
+ *       manual_executor       : resumes on whichever thread calls run()
+ *       thread_pool_executor  : resumes on a fixed set of worker threads
+ *       detached_task         : a coroutine nobody waits for
+ *       schedule_on           : co_await it to move onto an executor
+ *       async_stack           : a stack whose pop can be co_await-ed
+ *
+ *    co_await s.pop_async() hands back the top element right away if
+ *    there is one.  Otherwise the coroutine is parked on the stack and
+ *    the next push gives its element straight to the longest waiter and
+ *    schedules it on the stack's executor.  push_range() hands out a
+ *    whole batch under one lock and schedules every waiter it woke in a
+ *    single call.
+ *
+ *    This needs coroutines: C++20, or -fcoroutines on gcc in C++17 mode.
+ *    Without them the header is empty.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#if defined(__cpp_impl_coroutine)
+
+#include <cassert>             // because I am paranoid
+#include <condition_variable>  // for std::condition_variable
+#include <coroutine>           // for std::coroutine_handle
+#include <deque>               // for std::deque
+#include <exception>           // for std::terminate
+#include <mutex>               // for std::mutex
+#include <optional>            // for std::optional
+#include <thread>              // for std::thread
+#include <utility>             // for std::move
+#include <vector>              // for std::vector
+#include "stack.h"
+
+class TestAsyncStack; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /**************************************************
+    * EXECUTOR
+    * Something that will resume a suspended coroutine later
+    *************************************************/
+   class executor
+   {
+   public:
+      virtual ~executor() {}
+      virtual void schedule(std::coroutine_handle<> h) = 0;
+
+      // schedule several at once; override to do it under one lock
+      virtual void schedule(const std::coroutine_handle<>* first, size_t num)
+      {
+         for (size_t i = 0; i < num; i++)
+            schedule(first[i]);
+      }
+   };
+
+   /**************************************************
+    * MANUAL EXECUTOR
+    * Single threaded: coroutines wait in a queue until run()
+    *************************************************/
+   class manual_executor : public executor
+   {
+      friend class ::TestAsyncStack;
+   public:
+      void schedule(std::coroutine_handle<> h) override
+      {
+         ready.push_back(h);
+      }
+
+      // resume one coroutine, returning false if there was none
+      bool run_one()
+      {
+         if (ready.empty())
+            return false;
+         std::coroutine_handle<> h = ready.front();
+         ready.pop_front();
+         h.resume();
+         return true;
+      }
+
+      // resume until nothing is left, including whatever those schedule
+      size_t run()
+      {
+         size_t num = 0;
+         while (run_one())
+            num++;
+         return num;
+      }
+
+      size_t size() const { return ready.size(); }
+
+   private:
+      std::deque<std::coroutine_handle<>> ready;
+   };
+
+   /**************************************************
+    * THREAD POOL EXECUTOR
+    * Multi threaded: workers resume coroutines as they arrive
+    *************************************************/
+   class thread_pool_executor : public executor
+   {
+   public:
+      thread_pool_executor(size_t numThreads) : stopping(false)
+      {
+         for (size_t i = 0; i < numThreads; i++)
+            workers.emplace_back([this]() { work(); });
+      }
+      ~thread_pool_executor()
+      {
+         {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+         }
+         wake.notify_all();
+         for (auto& worker : workers)
+            worker.join();
+      }
+
+      void schedule(std::coroutine_handle<> h) override
+      {
+         {
+            std::lock_guard<std::mutex> guard(lock);
+            ready.push_back(h);
+         }
+         wake.notify_one();
+      }
+      void schedule(const std::coroutine_handle<>* first, size_t num) override
+      {
+         {
+            std::lock_guard<std::mutex> guard(lock);
+            ready.insert(ready.end(), first, first + num);
+         }
+         if (num == 1)
+            wake.notify_one();
+         else if (num > 1)
+            wake.notify_all();
+      }
+
+   private:
+      // run coroutines until the pool is destroyed and the queue is empty
+      void work()
+      {
+         for (;;)
+         {
+            std::coroutine_handle<> h;
+            {
+               std::unique_lock<std::mutex> guard(lock);
+               wake.wait(guard, [this]() { return stopping || !ready.empty(); });
+               if (ready.empty())
+                  return;
+               h = ready.front();
+               ready.pop_front();
+            }
+            h.resume();
+         }
+      }
+
+      std::mutex lock;
+      std::condition_variable wake;
+      std::deque<std::coroutine_handle<>> ready;
+      std::vector<std::thread> workers;
+      bool stopping;
+   };
+
+   /**************************************************
+    * DETACHED TASK
+    * The return type of a coroutine that starts right away and
+    * cleans up after itself when it finishes
+    *************************************************/
+   struct detached_task
+   {
+      struct promise_type
+      {
+         detached_task get_return_object() { return {}; }
+         std::suspend_never initial_suspend() noexcept { return {}; }
+         std::suspend_never final_suspend() noexcept { return {}; }
+         void return_void() {}
+         void unhandled_exception() { std::terminate(); }
+      };
+   };
+
+   /**************************************************
+    * SCHEDULE ON
+    * co_await schedule_on(ex) to continue on ex
+    *************************************************/
+   class schedule_on
+   {
+   public:
+      schedule_on(executor& ex) : ex(ex) {}
+      bool await_ready() const noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> h) { ex.schedule(h); }
+      void await_resume() const noexcept {}
+   private:
+      executor& ex;
+   };
+
+   /**************************************************
+    * ASYNC STACK
+    * First-in-Last-out, and a consumer can wait for a push
+    *************************************************/
+   template <class T, class Container = custom::vector<T>>
+   class async_stack
+   {
+      friend class ::TestAsyncStack; // give unit tests access to private members
+   public:
+
+      /**************************************************
+       * POP AWAITER
+       * What pop_async() returns: co_await it for the top element
+       *************************************************/
+      class pop_awaiter
+      {
+         friend class async_stack;
+         friend class ::TestAsyncStack;
+      public:
+         bool await_ready() const noexcept { return false; }
+         bool await_suspend(std::coroutine_handle<> h) { return s.suspend(*this, h); }
+         T await_resume()
+         {
+            assert(value.has_value());
+            return std::move(*value);
+         }
+
+      private:
+         pop_awaiter(async_stack& s) : s(s), next(nullptr) {}
+
+         async_stack&            s;
+         std::optional<T>        value;    // filled in before we resume
+         std::coroutine_handle<> handle;   // who is waiting
+         pop_awaiter*            next;     // the waiter after this one
+      };
+
+      //
+      // Construct
+      //
+
+      async_stack(executor* ex = nullptr) : ex(ex), first(nullptr), last(nullptr), numWaiting(0) {}
+      async_stack(const async_stack& rhs) = delete;
+      async_stack& operator = (const async_stack& rhs) = delete;
+      ~async_stack()
+      {
+         assert(first == nullptr);  // nobody may still be waiting
+      }
+
+      //
+      // Insert
+      //
+
+      void push(const T& t)
+      {
+         T copy(t);
+         push(std::move(copy));
+      }
+      void push(T&& t);
+      template <class Iterator>
+      void push_range(Iterator begin, Iterator end);
+
+      //
+      // Remove
+      //
+
+      pop_awaiter pop_async()
+      {
+         return pop_awaiter(*this);
+      }
+      bool try_pop(T& t)
+      {
+         std::lock_guard<std::mutex> guard(lock);
+         if (items.empty())
+            return false;
+         t = std::move(items.top());
+         items.pop();
+         return true;
+      }
+
+      //
+      // Status
+      //
+
+      size_t size() const
+      {
+         std::lock_guard<std::mutex> guard(lock);
+         return items.size();
+      }
+      bool empty() const { return size() == 0; }
+      size_t num_waiting() const
+      {
+         std::lock_guard<std::mutex> guard(lock);
+         return numWaiting;
+      }
+
+   private:
+
+      // take the top element now or join the waiters; true means we suspended
+      bool suspend(pop_awaiter& waiter, std::coroutine_handle<> h);
+
+      // take the longest waiter off the list; the lock must be held
+      pop_awaiter* popWaiter()
+      {
+         pop_awaiter* waiter = first;
+         first = waiter->next;
+         if (first == nullptr)
+            last = nullptr;
+         numWaiting--;
+         return waiter;
+      }
+
+      // resume the waiters we handed elements to, after the lock is released
+      void resume(std::coroutine_handle<>* handles, size_t num)
+      {
+         if (ex)
+            ex->schedule(handles, num);
+         else
+            for (size_t i = 0; i < num; i++)
+               handles[i].resume();
+      }
+
+      mutable std::mutex   lock;
+      custom::stack<T, Container> items;   // elements nobody was waiting for
+      executor*    ex;                     // where waiters resume, or inline
+      pop_awaiter* first;                  // the waiter to serve next
+      pop_awaiter* last;                   // the waiter that came last
+      size_t       numWaiting;
+   };
+
+   /*****************************************
+    * ASYNC STACK :: PUSH
+    * Give t to a waiter if there is one, otherwise keep it
+    ****************************************/
+   template <class T, class Container>
+   void async_stack<T, Container>::push(T&& t)
+   {
+      std::coroutine_handle<> handle;
+      {
+         std::lock_guard<std::mutex> guard(lock);
+         if (first == nullptr)
+         {
+            items.push(std::move(t));
+            return;
+         }
+         pop_awaiter* waiter = popWaiter();
+         waiter->value.emplace(std::move(t));
+         handle = waiter->handle;
+      }
+      resume(&handle, 1);
+   }
+
+   /*****************************************
+    * ASYNC STACK :: PUSH RANGE
+    * Push a batch under one lock.  Waiters take elements from the
+    * end of the batch, as if each had been pushed and popped; the
+    * rest stay on the stack.  Every waiter woken is scheduled at once.
+    ****************************************/
+   template <class T, class Container>
+   template <class Iterator>
+   void async_stack<T, Container>::push_range(Iterator begin, Iterator end)
+   {
+      custom::vector<std::coroutine_handle<>> handles;
+      {
+         std::lock_guard<std::mutex> guard(lock);
+         for (Iterator it = begin; it != end; ++it)
+            items.push(*it);
+         while (first != nullptr && !items.empty())
+         {
+            pop_awaiter* waiter = popWaiter();
+            waiter->value.emplace(std::move(items.top()));
+            items.pop();
+            handles.push_back(waiter->handle);
+         }
+      }
+      if (!handles.empty())
+         resume(&handles[0], handles.size());
+   }
+
+   /*****************************************
+    * ASYNC STACK :: SUSPEND
+    * Called from co_await: take the top element without suspending
+    * if there is one, otherwise wait at the end of the line
+    ****************************************/
+   template <class T, class Container>
+   bool async_stack<T, Container>::suspend(pop_awaiter& waiter, std::coroutine_handle<> h)
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      if (!items.empty())
+      {
+         waiter.value.emplace(std::move(items.top()));
+         items.pop();
+         return false;
+      }
+
+      waiter.handle = h;
+      waiter.next = nullptr;
+      if (last)
+         last->next = &waiter;
+      else
+         first = &waiter;
+      last = &waiter;
+      numWaiting++;
+      return true;
+   }
+
+} // custom namespace
+
+#endif // __cpp_impl_coroutine
@@ -0,0 +1,1716 @@
+/***********************************************************************
+ * Source:
+ *    Benchmark
+ * Summary:
+ *    Driver to time the custom containers against their std:: cousins.
+ *    Build this one on its own, with optimizations and without DEBUG:
+ *       g++ -std=c++20 -O2 -DNDEBUG -pthread benchStack.cpp -o benchStack
+ *       benchStack [name|all] [largest power of ten]
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#include <algorithm>  // for std::remove_if
+#include <atomic>     // for std::atomic
+#include <chrono>     // for std::chrono::steady_clock
+#include <condition_variable> // for std::condition_variable
+#include <cstddef>    // for std::max_align_t
+#include <cstdint>    // for uint32_t
+#include <cstdio>     // for std::tmpfile, std::fwrite
+#include <deque>      // for std::deque
+#include <functional> // for std::function
+#include <cstdlib>    // for std::atoi, std::malloc
+#include <cstring>    // for std::strcmp, std::memset
+#include <iostream>   // for std::cout
+#include <memory>     // for std::unique_ptr
+#include <mutex>      // for std::mutex
+#include <new>        // for std::bad_alloc
+#include <iomanip>    // for std::setw
+#include <queue>      // for std::priority_queue
+#include <random>     // for std::mt19937_64
+#include <stack>      // for std::stack
+#include <string>     // for std::string
+#include <thread>     // for std::thread
+#include <tuple>      // for std::tuple
+#include <unordered_map> // for std::unordered_map
+#include <vector>     // for std::vector
+
+#include "stack.h"
+#include "priority_queue.h"
+#include "hash.h"
+#include "persistent_stack.h"
+#include "frame_stack.h"
+#include "soa_stack.h"
+#include "concurrent_array_stack.h"
+#include "async_stack.h"
+#include "synchronized_stack.h"
+#include "per_thread_stacks.h"
+#include "spilling_stack.h"
+#include "compressed_stack.h"
+#include "packed_stack.h"
+#include "bounded_stack.h"
+#include "hinted_stack.h"
+#include "realloc_allocator.h"
+#include "aligned_allocator.h"
+#include "compact_vector.h"
+
+/**********************************************************************
+ * SECONDS
+ * Run a piece of code once and report how long it took
+ ***********************************************************************/
+template <class Function>
+double seconds(Function f)
+{
+   auto begin = std::chrono::steady_clock::now();
+   f();
+   std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+   return elapsed.count();
+}
+
+/**********************************************************************
+ * REPORT
+ * One line per measurement: what, how many, custom vs the baseline
+ * (usually the std:: container)
+ ***********************************************************************/
+void report(const char* what, size_t num, double timeCustom, double timeStd)
+{
+   std::cout << std::left  << std::setw(28) << what
+             << std::right << std::setw(12) << num
+             << std::fixed << std::setprecision(2)
+             << std::setw(10) << timeCustom * 1.0e9 / (double)num << " ns"
+             << std::setw(10) << timeStd    * 1.0e9 / (double)num << " ns (baseline)"
+             << "\n";
+}
+
+/**********************************************************************
+ * MEMORY
+ * Every global new and delete goes through here so the workloads can
+ * report their peak heap use.  Each block is malloc'd with a header in
+ * front carrying its size, and freed from that same header.  The
+ * threaded workloads allocate too, so the counts are atomic; relaxed
+ * is enough, as nothing else is ordered by them.
+ ***********************************************************************/
+static std::atomic<size_t> bytesNow;
+static std::atomic<size_t> bytesPeak;
+static std::atomic<size_t> numNew;       // calls to new, to count reallocations
+
+struct alignas(std::max_align_t) BlockHeader
+{
+   size_t size;
+};
+
+void* allocateCounted(size_t size)
+{
+   BlockHeader* header = static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + size));
+   if (header == nullptr)
+      throw std::bad_alloc();
+   header->size = size;
+   numNew.fetch_add(1, std::memory_order_relaxed);
+   size_t now = bytesNow.fetch_add(size, std::memory_order_relaxed) + size;
+   size_t peak = bytesPeak.load(std::memory_order_relaxed);
+   while (now > peak && !bytesPeak.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+      ;
+   return header + 1;
+}
+
+void freeCounted(void* p) noexcept
+{
+   if (p == nullptr)
+      return;
+   BlockHeader* header = static_cast<BlockHeader*>(p) - 1;
+   bytesNow.fetch_sub(header->size, std::memory_order_relaxed);
+   std::free(header);
+}
+
+void* operator new(size_t size)
+{
+   return allocateCounted(size);
+}
+void operator delete(void* p) noexcept
+{
+   freeCounted(p);
+}
+void operator delete(void* p, size_t) noexcept
+{
+   freeCounted(p);
+}
+
+/**********************************************************************
+ * MEASURE
+ * Run a piece of code once, timing it and noting how far the heap
+ * grew above where it started
+ ***********************************************************************/
+template <class Function>
+double measure(Function f, size_t& peak)
+{
+   size_t before = bytesNow.load(std::memory_order_relaxed);
+   bytesPeak.store(before, std::memory_order_relaxed);
+   double time = seconds(f);
+   peak = bytesPeak.load(std::memory_order_relaxed) - before;
+   return time;
+}
+
+/**********************************************************************
+ * REPORT MEMORY
+ * Peak heap use of the custom run and the baseline run
+ ***********************************************************************/
+void reportMemory(const char* what, size_t peakCustom, size_t peakStd)
+{
+   std::cout << std::left  << std::setw(28) << what
+             << std::right << std::setw(12) << ""
+             << std::fixed << std::setprecision(1)
+             << std::setw(10) << (double)peakCustom / 1024.0 << " KB"
+             << std::setw(10) << (double)peakStd    / 1024.0 << " KB (baseline)"
+             << "\n";
+}
+
+/**********************************************************************
+ * SINK
+ * Keep the optimizer from discarding the work we are timing
+ ***********************************************************************/
+static volatile unsigned long long sink;
+
+/**********************************************************************
+ * BENCH PQUEUE
+ * push n random keys, pop them all, and build from a range
+ ***********************************************************************/
+void bench_pqueue(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      std::vector<unsigned long long> keys(num);
+      std::mt19937_64 random(num);
+      for (auto& key : keys)
+         key = random();
+
+      custom::priority_queue<unsigned long long> pq;
+      std::priority_queue<unsigned long long> pqStd;
+      double timeCustom = seconds([&]() {
+         for (auto key : keys)
+            pq.push(key);
+         });
+      double timeStd = seconds([&]() {
+         for (auto key : keys)
+            pqStd.push(key);
+         });
+      report("pqueue push", num, timeCustom, timeStd);
+
+      timeCustom = seconds([&]() {
+         while (!pq.empty())
+         {
+            sink = sink + pq.top();
+            pq.pop();
+         }
+         });
+      timeStd = seconds([&]() {
+         while (!pqStd.empty())
+         {
+            sink = sink + pqStd.top();
+            pqStd.pop();
+         }
+         });
+      report("pqueue pop", num, timeCustom, timeStd);
+
+      timeCustom = seconds([&]() {
+         custom::priority_queue<unsigned long long> pqRange(keys.begin(), keys.end());
+         sink = sink + pqRange.top();
+         });
+      timeStd = seconds([&]() {
+         std::priority_queue<unsigned long long> pqRange(keys.begin(), keys.end());
+         sink = sink + pqRange.top();
+         });
+      report("pqueue build from range", num, timeCustom, timeStd);
+   }
+}
+
+/**********************************************************************
+ * BENCH HASH MAP
+ * insert n keys, find each of them plus n misses, erase them all
+ ***********************************************************************/
+template <class Key, class MakeKey>
+void bench_hashMap(const char* name, int maxPower, MakeKey makeKey)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      std::vector<Key> keys;
+      std::vector<Key> misses;
+      std::mt19937_64 random(num);
+      for (size_t i = 0; i < num; i++)
+      {
+         keys.push_back(makeKey(random()));
+         misses.push_back(makeKey(random()));
+      }
+
+      custom::unordered_map<Key, size_t> map;
+      std::unordered_map<Key, size_t> mapStd;
+      std::string what;
+
+      double timeCustom = seconds([&]() {
+         for (size_t i = 0; i < num; i++)
+            map.try_emplace(keys[i], i);
+         });
+      double timeStd = seconds([&]() {
+         for (size_t i = 0; i < num; i++)
+            mapStd.try_emplace(keys[i], i);
+         });
+      report((what = std::string(name) + " insert").c_str(), num, timeCustom, timeStd);
+
+      timeCustom = seconds([&]() {
+         for (size_t i = 0; i < num; i++)
+            sink = sink + (map.find(keys[i]) != map.end()) + (map.find(misses[i]) != map.end());
+         });
+      timeStd = seconds([&]() {
+         for (size_t i = 0; i < num; i++)
+            sink = sink + (mapStd.find(keys[i]) != mapStd.end()) + (mapStd.find(misses[i]) != mapStd.end());
+         });
+      report((what = std::string(name) + " find hit+miss").c_str(), num, timeCustom, timeStd);
+
+      timeCustom = seconds([&]() {
+         for (size_t i = 0; i < num; i++)
+            sink = sink + map.erase(keys[i]);
+         });
+      timeStd = seconds([&]() {
+         for (size_t i = 0; i < num; i++)
+            sink = sink + mapStd.erase(keys[i]);
+         });
+      report((what = std::string(name) + " erase").c_str(), num, timeCustom, timeStd);
+   }
+}
+
+/**********************************************************************
+ * BENCH HASH
+ * integer keys and string keys
+ ***********************************************************************/
+void bench_hash(int maxPower)
+{
+   bench_hashMap<unsigned long long>("hash int", maxPower,
+      [](unsigned long long r) { return r; });
+   bench_hashMap<std::string>("hash string", maxPower,
+      [](unsigned long long r) { return "key-" + std::to_string(r); });
+}
+
+/**********************************************************************
+ * BENCH PERSISTENT
+ * A backtracking search keeps every version of its stack: push one
+ * element per step and remember the stack as it was.  Copying a
+ * custom::stack at each step is O(n^2), so stop comparing at 10^4.
+ ***********************************************************************/
+void bench_persistent(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2 && num <= 10000; num *= 10)
+   {
+      double timeCustom = seconds([&]() {
+         std::vector<custom::persistent_stack<size_t>> versions;
+         versions.reserve(num + 1);
+         versions.push_back(custom::persistent_stack<size_t>());
+         for (size_t i = 0; i < num; i++)
+            versions.push_back(versions.back().push(i));
+         sink = sink + versions.back().size();
+         });
+      double timeStd = seconds([&]() {
+         std::vector<custom::stack<size_t>> versions;
+         versions.reserve(num + 1);
+         versions.push_back(custom::stack<size_t>());
+         for (size_t i = 0; i < num; i++)
+         {
+            versions.push_back(versions.back());
+            versions.back().push(i);
+         }
+         sink = sink + versions.back().size();
+         });
+      report("persistent vs copied stack", num, timeCustom, timeStd);
+   }
+}
+
+/**********************************************************************
+ * BENCH FRAME
+ * An interpreter's call stack holds frames of a few different sizes.
+ * Push and pop a random mix of them, then push n and throw them all
+ * away at once, against the boxed stack<unique_ptr<Frame>> we would
+ * otherwise write.
+ ***********************************************************************/
+struct Frame
+{
+   virtual ~Frame() {}
+   size_t pc = 0;
+};
+template <size_t N>
+struct FrameOf : public Frame
+{
+   FrameOf(size_t pc) { this->pc = pc; locals[0] = pc; }
+   size_t locals[N];
+};
+
+void bench_frame(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      std::vector<unsigned char> ops(num);
+      std::mt19937_64 random(num);
+      for (auto& op : ops)
+         op = (unsigned char)(random() % 5);   // 0..2 push a frame, 3..4 pop
+
+      custom::frame_stack frames;
+      custom::stack<std::unique_ptr<Frame>> boxed;
+      double timeCustom = seconds([&]() {
+         for (size_t i = 0; i < num; i++)
+            switch (ops[i])
+            {
+               case 0: frames.push<FrameOf<2>>(i);  break;
+               case 1: frames.push<FrameOf<6>>(i);  break;
+               case 2: frames.push<FrameOf<14>>(i); break;
+               default:
+                  if (!frames.empty())
+                     frames.pop();
+            }
+         sink = sink + frames.size();
+         });
+      double timeStd = seconds([&]() {
+         for (size_t i = 0; i < num; i++)
+            switch (ops[i])
+            {
+               case 0: boxed.push(std::unique_ptr<Frame>(new FrameOf<2>(i)));  break;
+               case 1: boxed.push(std::unique_ptr<Frame>(new FrameOf<6>(i)));  break;
+               case 2: boxed.push(std::unique_ptr<Frame>(new FrameOf<14>(i))); break;
+               default:
+                  if (!boxed.empty())
+                     boxed.pop();
+            }
+         sink = sink + boxed.size();
+         });
+      report("frame push/pop mix", num, timeCustom, timeStd);
+
+      timeCustom = seconds([&]() {
+         custom::frame_stack::mark_type mark = frames.mark();
+         for (size_t i = 0; i < num; i++)
+            sink = sink + frames.push<FrameOf<6>>(i).pc;
+         frames.unwind(mark);
+         });
+      timeStd = seconds([&]() {
+         size_t size = boxed.size();
+         for (size_t i = 0; i < num; i++)
+         {
+            boxed.push(std::unique_ptr<Frame>(new FrameOf<6>(i)));
+            sink = sink + boxed.top()->pc;
+         }
+         boxed.pop_to(size);
+         });
+      report("frame push n, unwind", num, timeCustom, timeStd);
+   }
+}
+
+/**********************************************************************
+ * BENCH SOA
+ * An evaluation stack of (value, tag, source position) rows where the
+ * hot loop only sums the values.  The baseline is the vector of tuples
+ * underneath custom::stack<std::tuple<...>>, scanned the same way.
+ ***********************************************************************/
+struct SourcePos
+{
+   const char* file;
+   int line;
+   int column;
+};
+
+void bench_soa(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      custom::soa_stack<long long, char, SourcePos> soa;
+      custom::vector<std::tuple<long long, char, SourcePos>> aos;
+      const int numScans = 20;
+
+      double timeCustom = seconds([&]() {
+         for (size_t i = 0; i < num; i++)
+            soa.push((long long)i, 'i', SourcePos{ "bench", (int)i, 1 });
+         });
+      double timeStd = seconds([&]() {
+         for (size_t i = 0; i < num; i++)
+            aos.push_back(std::make_tuple((long long)i, 'i', SourcePos{ "bench", (int)i, 1 }));
+         });
+      report("soa push", num, timeCustom, timeStd);
+
+      timeCustom = seconds([&]() {
+         for (int scan = 0; scan < numScans; scan++)
+         {
+            long long sum = 0;
+            for (long long value : soa.column<0>())
+               sum += value;
+            sink = sink + sum;
+         }
+         });
+      timeStd = seconds([&]() {
+         for (int scan = 0; scan < numScans; scan++)
+         {
+            long long sum = 0;
+            for (size_t i = 0; i < aos.size(); i++)
+               sum += std::get<0>(aos[i]);
+            sink = sink + sum;
+         }
+         });
+      report("soa scan value column", num * numScans, timeCustom, timeStd);
+
+      timeCustom = seconds([&]() {
+         while (!soa.empty())
+         {
+            sink = sink + std::get<0>(soa.top());
+            soa.pop();
+         }
+         });
+      timeStd = seconds([&]() {
+         while (!aos.empty())
+         {
+            sink = sink + std::get<0>(aos.back());
+            aos.pop_back();
+         }
+         });
+      report("soa top/pop", num, timeCustom, timeStd);
+   }
+}
+
+/**********************************************************************
+ * RPN
+ * Evaluate a reverse-Polish token stream.  Arithmetic is unsigned so
+ * overflow wraps instead of being undefined.
+ ***********************************************************************/
+struct Token
+{
+   char op;                    // '+', '-', '*', or 0 for a number
+   unsigned long long value;
+};
+
+template <class Stack>
+unsigned long long evaluateRPN(const std::vector<Token>& tokens)
+{
+   Stack operands;
+   for (const Token& token : tokens)
+   {
+      if (token.op == 0)
+      {
+         operands.push(token.value);
+         continue;
+      }
+      unsigned long long rhs = operands.top();
+      operands.pop();
+      unsigned long long& lhs = operands.top();
+      switch (token.op)
+      {
+         case '+': lhs += rhs; break;
+         case '-': lhs -= rhs; break;
+         default:  lhs *= rhs; break;
+      }
+   }
+   return operands.empty() ? 0 : operands.top();
+}
+
+/**********************************************************************
+ * BENCH RPN
+ * A well-formed expression of n tokens whose depth wanders up and down
+ ***********************************************************************/
+void bench_rpn(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      std::vector<Token> tokens;
+      tokens.reserve(num);
+      std::mt19937_64 random(num);
+      size_t depth = 0;
+      while (tokens.size() < num)
+      {
+         unsigned long long r = random();
+         if (depth < 2 || r % 16 < 9)
+         {
+            tokens.push_back(Token{ 0, r >> 40 });
+            depth++;
+         }
+         else
+         {
+            tokens.push_back(Token{ "+-*"[r % 3], 0 });
+            depth--;
+         }
+      }
+
+      size_t peakCustom;
+      size_t peakStd;
+      double timeCustom = measure([&]() {
+         sink = sink + evaluateRPN<custom::stack<unsigned long long>>(tokens);
+         }, peakCustom);
+      double timeStd = measure([&]() {
+         sink = sink + evaluateRPN<std::stack<unsigned long long>>(tokens);
+         }, peakStd);
+      report("rpn per token", num, timeCustom, timeStd);
+      reportMemory("rpn peak heap", peakCustom, peakStd);
+   }
+}
+
+/**********************************************************************
+ * DFS
+ * Visit every vertex of a graph stored as compressed adjacency lists,
+ * pushing every neighbor the way a textbook iterative DFS does
+ ***********************************************************************/
+struct Graph
+{
+   std::vector<size_t>   offsets;   // neighbors of v are [offsets[v], offsets[v+1])
+   std::vector<uint32_t> targets;
+};
+
+template <class Stack>
+size_t depthFirst(const Graph& graph, std::vector<char>& visited)
+{
+   size_t numVisited = 0;
+   uint32_t numVertices = (uint32_t)graph.offsets.size() - 1;
+   Stack pending;
+   for (uint32_t start = 0; start < numVertices; start++)
+   {
+      if (visited[start])
+         continue;
+      pending.push(start);
+      while (!pending.empty())
+      {
+         uint32_t v = pending.top();
+         pending.pop();
+         if (visited[v])
+            continue;
+         visited[v] = 1;
+         numVisited++;
+         for (size_t e = graph.offsets[v]; e < graph.offsets[v + 1]; e++)
+            if (!visited[graph.targets[e]])
+               pending.push(graph.targets[e]);
+      }
+   }
+   return numVisited;
+}
+
+/**********************************************************************
+ * BENCH DFS
+ * A random graph with n edges and n/8 vertices
+ ***********************************************************************/
+void bench_dfs(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      uint32_t numVertices = (uint32_t)(num / 8);
+      std::mt19937_64 random(num);
+      std::vector<uint32_t> sources(num);
+      Graph graph;
+      graph.offsets.assign(numVertices + 1, 0);
+      graph.targets.resize(num);
+      for (size_t e = 0; e < num; e++)
+      {
+         sources[e] = (uint32_t)(random() % numVertices);
+         graph.offsets[sources[e] + 1]++;
+      }
+      for (uint32_t v = 0; v < numVertices; v++)
+         graph.offsets[v + 1] += graph.offsets[v];
+      std::vector<size_t> fill(graph.offsets.begin(), graph.offsets.end() - 1);
+      for (size_t e = 0; e < num; e++)
+         graph.targets[fill[sources[e]]++] = (uint32_t)(random() % numVertices);
+
+      std::vector<char> visited(numVertices);
+      size_t peakCustom;
+      size_t peakStd;
+      double timeCustom = measure([&]() {
+         sink = sink + depthFirst<custom::stack<uint32_t>>(graph, visited);
+         }, peakCustom);
+      visited.assign(numVertices, 0);
+      double timeStd = measure([&]() {
+         sink = sink + depthFirst<std::stack<uint32_t>>(graph, visited);
+         }, peakStd);
+      report("dfs per edge", num, timeCustom, timeStd);
+      reportMemory("dfs peak heap", peakCustom, peakStd);
+   }
+}
+
+/**********************************************************************
+ * BRACKETS
+ * Check that every bracket in a JSON-like document is matched and
+ * return how deep the nesting went, or -1 when it is malformed
+ ***********************************************************************/
+template <class Stack>
+long long bracketDepth(const std::string& text)
+{
+   Stack open;
+   size_t depth = 0;
+   bool inString = false;
+   for (char c : text)
+   {
+      if (inString)
+      {
+         inString = c != '"';
+         continue;
+      }
+      switch (c)
+      {
+         case '"':
+            inString = true;
+            break;
+         case '[':
+         case '{':
+            open.push(c);
+            if (open.size() > depth)
+               depth = open.size();
+            break;
+         case ']':
+         case '}':
+            if (open.empty() || open.top() != (c == ']' ? '[' : '{'))
+               return -1;
+            open.pop();
+            break;
+      }
+   }
+   return open.empty() ? (long long)depth : -1;
+}
+
+/**********************************************************************
+ * BENCH BRACKETS
+ * A document of n characters of nested arrays, objects and strings
+ ***********************************************************************/
+void bench_brackets(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      std::string text;
+      text.reserve(num + 1024);
+      std::vector<char> nesting;
+      std::mt19937_64 random(num);
+      while (text.size() < num)
+      {
+         unsigned long long r = random();
+         if (nesting.empty() || (nesting.size() < 1000 && r % 8 < 3))
+         {
+            nesting.push_back(r & 8 ? '[' : '{');
+            text += nesting.back();
+         }
+         else if (r % 8 < 6)
+            text += (r & 8) ? "\"k[]{}\"," : "12,";
+         else
+         {
+            text += nesting.back() == '[' ? ']' : '}';
+            nesting.pop_back();
+         }
+      }
+      while (!nesting.empty())
+      {
+         text += nesting.back() == '[' ? ']' : '}';
+         nesting.pop_back();
+      }
+
+      size_t peakCustom;
+      size_t peakStd;
+      double timeCustom = measure([&]() {
+         sink = sink + bracketDepth<custom::stack<char>>(text);
+         }, peakCustom);
+      double timeStd = measure([&]() {
+         sink = sink + bracketDepth<std::stack<char>>(text);
+         }, peakStd);
+      report("brackets per char", text.size(), timeCustom, timeStd);
+      reportMemory("brackets peak heap", peakCustom, peakStd);
+   }
+}
+
+/**********************************************************************
+ * ON THREADS
+ * Split n iterations of body(thread, iteration) across some threads
+ * and wait for them all
+ ***********************************************************************/
+template <class Body>
+void onThreads(int numThreads, size_t num, Body body)
+{
+   std::vector<std::thread> threads;
+   for (int t = 0; t < numThreads; t++)
+      threads.emplace_back([=]() {
+         for (size_t i = t; i < num; i += numThreads)
+            body(t, i);
+         });
+   for (auto& thread : threads)
+      thread.join();
+}
+
+/**********************************************************************
+ * BENCH CONCURRENT
+ * An object pool: every thread takes something from the stack and puts
+ * something back, n times in all.  The baseline is custom::stack
+ * behind a std::mutex.
+ ***********************************************************************/
+void bench_concurrent(int maxPower)
+{
+   const size_t numCapacity = 1024;
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+      for (int numThreads = 1; numThreads <= 8; numThreads *= 2)
+      {
+         custom::concurrent_array_stack<size_t> pool(numCapacity);
+         custom::stack<size_t> poolLocked;
+         std::mutex lock;
+         for (size_t i = 0; i < numCapacity / 2; i++)
+         {
+            pool.try_push(i);
+            poolLocked.push(i);
+         }
+
+         double timeCustom = seconds([&]() {
+            onThreads(numThreads, num, [&](int, size_t i) {
+               size_t value = i;
+               if (pool.try_pop(value))
+                  value++;
+               pool.try_push(value);
+               });
+            });
+         double timeStd = seconds([&]() {
+            onThreads(numThreads, num, [&](int, size_t i) {
+               size_t value = i;
+               std::lock_guard<std::mutex> guard(lock);
+               if (!poolLocked.empty())
+               {
+                  value = poolLocked.top() + 1;
+                  poolLocked.pop();
+               }
+               if (poolLocked.size() < numCapacity)
+                  poolLocked.push(value);
+               });
+            });
+         std::string what = "concurrent " + std::to_string(numThreads) + " threads";
+         report(what.c_str(), num, timeCustom, timeStd);
+      }
+}
+
+#ifdef __cpp_impl_coroutine
+/**********************************************************************
+ * NOW
+ * Nanoseconds on the steady clock, to stamp an element when it is pushed
+ ***********************************************************************/
+long long now()
+{
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**********************************************************************
+ * AWAIT STAMPS
+ * Pop num timestamps, adding up how long each one waited
+ ***********************************************************************/
+custom::detached_task awaitStamps(custom::async_stack<long long>& s, size_t num,
+                                  std::atomic<long long>& latency,
+                                  std::atomic<size_t>& numReceived)
+{
+   for (size_t i = 0; i < num; i++)
+   {
+      long long stamp = co_await s.pop_async();
+      latency += now() - stamp;
+      numReceived++;
+   }
+}
+
+/**********************************************************************
+ * BENCH ASYNC
+ * Wake-up latency: a consumer waits on an empty stack and the producer
+ * pushes one timestamp at a time, waiting for it to be received.  The
+ * consumer is a coroutine on a one-thread pool, against a thread
+ * sleeping on a condition variable.
+ ***********************************************************************/
+void bench_async(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2 && num <= 100000; num *= 10)
+   {
+      std::atomic<long long> latencyCustom(0);
+      std::atomic<size_t> numReceived(0);
+      {
+         custom::thread_pool_executor ex(1);
+         custom::async_stack<long long> s(&ex);
+         awaitStamps(s, num, latencyCustom, numReceived);
+         for (size_t i = 0; i < num; i++)
+         {
+            s.push(now());
+            while (numReceived <= i)
+               std::this_thread::yield();
+         }
+      }
+
+      std::atomic<long long> latencyStd(0);
+      numReceived = 0;
+      {
+         custom::stack<long long> s;
+         std::mutex lock;
+         std::condition_variable pushed;
+         std::thread consumer([&]() {
+            for (size_t i = 0; i < num; i++)
+            {
+               std::unique_lock<std::mutex> guard(lock);
+               pushed.wait(guard, [&]() { return !s.empty(); });
+               long long stamp = s.top();
+               s.pop();
+               guard.unlock();
+               latencyStd += now() - stamp;
+               numReceived++;
+            }
+            });
+         for (size_t i = 0; i < num; i++)
+         {
+            {
+               std::lock_guard<std::mutex> guard(lock);
+               s.push(now());
+            }
+            pushed.notify_one();
+            while (numReceived <= i)
+               std::this_thread::yield();
+         }
+         consumer.join();
+      }
+      report("async wake-up latency", num, latencyCustom * 1.0e-9, latencyStd * 1.0e-9);
+   }
+}
+#endif // __cpp_impl_coroutine
+
+/**********************************************************************
+ * SYNC ROUND TRIPS
+ * Every thread pushes one and then waits for one, n times in all
+ ***********************************************************************/
+template <class LockPolicy>
+double syncRoundTrips(int numThreads, size_t num)
+{
+   custom::synchronized_stack<size_t, custom::vector<size_t>, LockPolicy> s;
+   return seconds([&]() {
+      onThreads(numThreads, num, [&](int, size_t i) {
+         s.push(i);
+         sink = sink + s.pop_wait();
+         });
+      });
+}
+
+/**********************************************************************
+ * BENCH SYNC
+ * Each lock policy against std::mutex, at 1 to 8 threads
+ ***********************************************************************/
+void bench_sync(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+      for (int numThreads = 1; numThreads <= 8; numThreads *= 2)
+      {
+         double timeMutex  = syncRoundTrips<custom::mutex_policy>(numThreads, num);
+         double timeSpin   = syncRoundTrips<custom::spinlock_policy>(numThreads, num);
+         double timeTicket = syncRoundTrips<custom::ticket_lock_policy>(numThreads, num);
+         std::string what = "sync spinlock " + std::to_string(numThreads) + " threads";
+         report(what.c_str(), num, timeSpin, timeMutex);
+         what = "sync ticket " + std::to_string(numThreads) + " threads";
+         report(what.c_str(), num, timeTicket, timeMutex);
+      }
+}
+
+/**********************************************************************
+ * BENCH PER THREAD
+ * False sharing: every thread pushes and pops on a stack of its own,
+ * n times in all.  The baseline keeps the stacks side by side in a
+ * plain array, so several share a cache line.
+ ***********************************************************************/
+void bench_perthread(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+      for (int numThreads = 1; numThreads <= 8; numThreads *= 2)
+      {
+         custom::per_thread_stacks<size_t> padded(numThreads);
+         custom::stack<size_t> packed[8];
+
+         double timeCustom = seconds([&]() {
+            onThreads(numThreads, num, [&](int, size_t i) {
+               if (i / numThreads % 2 == 0)
+                  padded.push(i);
+               else
+                  padded.pop();
+               });
+            });
+         double timeStd = seconds([&]() {
+            onThreads(numThreads, num, [&](int t, size_t i) {
+               if (i / numThreads % 2 == 0)
+                  packed[t].push(i);
+               else
+                  packed[t].pop();
+               });
+            });
+         sink = sink + padded.size();
+         std::string what = "perthread " + std::to_string(numThreads) + " threads";
+         report(what.c_str(), num, timeCustom, timeStd);
+      }
+}
+
+/**********************************************************************
+ * BENCH INSERT
+ * Insert 1000 elements into the middle of a vector of n, then erase
+ * them again, against std::vector.  Numbers slide over with memmove;
+ * strings are moved one at a time.
+ ***********************************************************************/
+template <class T, class MakeValue>
+void benchInsertMiddle(const char* name, size_t num, MakeValue makeValue)
+{
+   const size_t numOps = 1000;
+   custom::vector<T> v;
+   std::vector<T> sv;
+   for (size_t i = 0; i < num; i++)
+   {
+      v.push_back(makeValue(i));
+      sv.push_back(makeValue(i));
+   }
+
+   double timeCustom = seconds([&]() {
+      for (size_t i = 0; i < numOps; i++)
+         v.insert(typename custom::vector<T>::iterator(&v[0] + v.size() / 2), makeValue(i));
+      for (size_t i = 0; i < numOps; i++)
+         v.erase(typename custom::vector<T>::iterator(&v[0] + v.size() / 2));
+      });
+   double timeStd = seconds([&]() {
+      for (size_t i = 0; i < numOps; i++)
+         sv.insert(sv.begin() + sv.size() / 2, makeValue(i));
+      for (size_t i = 0; i < numOps; i++)
+         sv.erase(sv.begin() + sv.size() / 2);
+      });
+   std::string what = std::string("insert/erase ") + name + " " + std::to_string(num);
+   report(what.c_str(), 2 * numOps, timeCustom, timeStd);
+}
+
+void bench_insert(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      benchInsertMiddle<int>("int", num, [](size_t i) { return (int)i; });
+      if (num <= 100000)
+         benchInsertMiddle<std::string>("string", num,
+                                        [](size_t i) { return std::to_string(i); });
+   }
+}
+
+/**********************************************************************
+ * BENCH ERASE IF
+ * Remove the odd numbers from n random ones, so the branch on the
+ * predicate is a coin toss.  The baseline is erase(remove_if()).
+ ***********************************************************************/
+void bench_eraseif(int maxPower)
+{
+   std::mt19937_64 random(235);
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      custom::vector<unsigned int> v;
+      std::vector<unsigned int> sv;
+      for (size_t i = 0; i < num; i++)
+      {
+         unsigned int value = (unsigned int)random();
+         v.push_back(value);
+         sv.push_back(value);
+      }
+
+      auto isOdd = [](unsigned int value) { return (value & 1) != 0; };
+      double timeCustom = seconds([&]() {
+         sink = sink + v.erase_if(isOdd);
+         });
+      double timeStd = seconds([&]() {
+         sv.erase(std::remove_if(sv.begin(), sv.end(), isOdd), sv.end());
+         });
+      sink = sink + sv.size();
+      report("erase_if odd", num, timeCustom, timeStd);
+   }
+}
+
+/**********************************************************************
+ * FILL WORDS
+ * Stand-in for read(): called through a volatile pointer so the
+ * compiler cannot see that it overwrites the zeroes resize() wrote
+ ***********************************************************************/
+static size_t fillWords(uint32_t* first, size_t num)
+{
+   std::memset(first, 0xAB, num * sizeof(uint32_t));
+   return num;
+}
+static size_t (* volatile fill)(uint32_t*, size_t) = fillWords;
+
+/**********************************************************************
+ * BENCH OVERWRITE
+ * An I/O buffer of n 32-bit words: size it, then fill it the way
+ * read() would.  resize() zeroes every word first; resize_for_overwrite
+ * leaves the pages untouched until the fill.  Then the same buffer is
+ * built from 64K-word chunks with reserve_and_write, against
+ * std::vector resized a chunk at a time.  Each is the best of three,
+ * taking turns, so neither always gets the pages the other freed.
+ * Try a power of 9 or 10 for multi-gigabyte buffers.
+ ***********************************************************************/
+void bench_overwrite(int maxPower)
+{
+   const size_t numChunk = 65536;
+   auto bestOfThree = [](auto fCustom, auto fStd, double& timeCustom, double& timeStd) {
+      timeCustom = timeStd = 1.0e30;
+      for (int i = 0; i < 3; i++)
+      {
+         double time = seconds(fCustom);
+         timeCustom = time < timeCustom ? time : timeCustom;
+         time = seconds(fStd);
+         timeStd = time < timeStd ? time : timeStd;
+      }
+   };
+
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      double timeCustom;
+      double timeStd;
+      bestOfThree([&]() {
+            custom::vector<uint32_t> v;
+            v.resize_for_overwrite(num);
+            sink = sink + fill(&v[0], num);
+         }, [&]() {
+            std::vector<uint32_t> sv;
+            sv.resize(num);
+            sink = sink + fill(&sv[0], num);
+         }, timeCustom, timeStd);
+      report("resize_for_overwrite+fill", num, timeCustom, timeStd);
+
+      bestOfThree([&]() {
+            custom::vector<uint32_t> v;
+            for (size_t numLeft = num; numLeft != 0; )
+               numLeft -= v.reserve_and_write(numLeft < numChunk ? numLeft : numChunk, fill);
+            sink = sink + v.size();
+         }, [&]() {
+            std::vector<uint32_t> sv;
+            for (size_t numLeft = num; numLeft != 0; )
+            {
+               size_t numWrite = numLeft < numChunk ? numLeft : numChunk;
+               size_t size = sv.size();
+               sv.resize(size + numWrite);
+               numLeft -= fill(&sv[size], numWrite);
+            }
+            sink = sink + sv.size();
+         }, timeCustom, timeStd);
+      report("reserve_and_write 64K", num, timeCustom, timeStd);
+   }
+}
+
+/**********************************************************************
+ * BENCH FD I/O
+ * Spill n numbers to a scratch file and load them back.  The stack
+ * writes and reads its storage directly; the baseline goes through
+ * stdio one element at a time.  A stack over std::deque writes its
+ * blocks with writev.
+ ***********************************************************************/
+void bench_fdio(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      std::FILE* file = std::tmpfile();
+      if (file == nullptr)
+         return;
+#ifdef _WIN32
+      int fd = _fileno(file);
+#else
+      int fd = fileno(file);
+#endif
+      custom::stack<unsigned long long> s;
+      custom::stack<unsigned long long, std::deque<unsigned long long>> sDeque;
+      std::vector<unsigned long long> sv;
+      for (size_t i = 0; i < num; i++)
+      {
+         s.push(i);
+         sDeque.push(i);
+         sv.push_back(i);
+      }
+
+      std::fseek(file, 0, SEEK_SET);
+      double timeCustom = seconds([&]() {
+         s.write_to(fd);
+         });
+      std::fseek(file, 0, SEEK_SET);
+      double timeDeque = seconds([&]() {
+         sDeque.write_to(fd);
+         });
+      std::fseek(file, 0, SEEK_SET);
+      double timeStd = seconds([&]() {
+         for (size_t i = 0; i < sv.size(); i++)
+            std::fwrite(&sv[i], sizeof(sv[i]), 1, file);
+         std::fflush(file);
+         });
+      report("fd write_to", num, timeCustom, timeStd);
+      report("fd write_to deque", num, timeDeque, timeStd);
+
+      custom::stack<unsigned long long> sLoad;
+      std::vector<unsigned long long> svLoad;
+      std::fseek(file, 0, SEEK_SET);
+      timeCustom = seconds([&]() {
+         sLoad.read_from(fd, num);
+         });
+      std::fseek(file, 0, SEEK_SET);
+      timeStd = seconds([&]() {
+         unsigned long long value;
+         while (svLoad.size() < num && std::fread(&value, sizeof(value), 1, file) == 1)
+            svLoad.push_back(value);
+         });
+      sink = sink + sLoad.size() + svLoad.size();
+      report("fd read_from", num, timeCustom, timeStd);
+      std::fclose(file);
+   }
+}
+
+/**********************************************************************
+ * BENCH SPILL
+ * Push n numbers into a stack whose memory budget is a tenth of
+ * that, then pop them all.  The baseline keeps everything in memory.
+ ***********************************************************************/
+void bench_spill(int maxPower)
+{
+   for (size_t num = 100000; maxPower-- > 4; num *= 10)
+   {
+      size_t budget = num * sizeof(unsigned long long) / 10;
+      size_t segment = budget / 8 < 4096 ? 4096 : budget / 8;
+      size_t peakCustom = 0;
+      size_t peakStd = 0;
+      size_t numSpilled = 0;
+
+      double timeCustom = measure([&]() {
+         custom::spilling_stack<unsigned long long> s(budget, segment);
+         for (size_t i = 0; i < num; i++)
+            s.push(i);
+         numSpilled = s.spilled_size();
+         unsigned long long sum = 0;
+         while (!s.empty())
+         {
+            sum += s.top();
+            s.pop();
+         }
+         sink = sink + sum;
+         }, peakCustom);
+      double timeStd = measure([&]() {
+         custom::stack<unsigned long long> s;
+         for (size_t i = 0; i < num; i++)
+            s.push(i);
+         unsigned long long sum = 0;
+         while (!s.empty())
+         {
+            sum += s.top();
+            s.pop();
+         }
+         sink = sink + sum;
+         }, peakStd);
+
+      report("spill push+pop", num, timeCustom, timeStd);
+      reportMemory("spill peak memory", peakCustom, peakStd);
+      std::cout << std::left << std::setw(28) << "spill on disk at top"
+                << std::right << std::setw(12) << numSpilled
+                << " of " << num << "\n";
+   }
+}
+
+/**********************************************************************
+ * BENCH COMPRESSED
+ * Push n integers and pop them all, compressed and not, for IDs
+ * that go up a little at a time, small numbers, and random words.
+ * Also the peak heap per element.
+ ***********************************************************************/
+template <class Next>
+void bench_compressedOne(const char* name, size_t num, Next next)
+{
+   std::vector<uint64_t> values(num);
+   for (size_t i = 0; i < num; i++)
+      values[i] = next();
+
+   size_t peakCustom = 0;
+   size_t peakStd = 0;
+   double timeCustom = measure([&]() {
+      custom::compressed_stack<uint64_t> s;
+      for (size_t i = 0; i < num; i++)
+         s.push(values[i]);
+      unsigned long long sum = 0;
+      while (!s.empty())
+      {
+         sum += s.top();
+         s.pop();
+      }
+      sink = sink + sum;
+      }, peakCustom);
+   double timeStd = measure([&]() {
+      custom::stack<uint64_t> s;
+      for (size_t i = 0; i < num; i++)
+         s.push(values[i]);
+      unsigned long long sum = 0;
+      while (!s.empty())
+      {
+         sum += s.top();
+         s.pop();
+      }
+      sink = sink + sum;
+      }, peakStd);
+
+   std::string label = std::string("compressed ") + name;
+   report(label.c_str(), num, timeCustom, timeStd);
+   std::cout << std::left  << std::setw(28) << (label + " bytes").c_str()
+             << std::right << std::setw(12) << ""
+             << std::fixed << std::setprecision(2)
+             << std::setw(10) << (double)peakCustom / (double)num << " B "
+             << std::setw(10) << (double)peakStd    / (double)num << " B  (baseline)"
+             << "\n";
+}
+
+void bench_compressed(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      std::mt19937_64 random(235);
+      uint64_t id = 1000000000000ULL;
+      bench_compressedOne("ids", num, [&]() { return id += 1 + random() % 7; });
+      bench_compressedOne("small", num, [&]() { return random() % 1000; });
+      bench_compressedOne("random", num, [&]() { return random(); });
+   }
+}
+
+/**********************************************************************
+ * BENCH PACKED
+ * Push n random flags and pop them all, a bit each against a byte
+ * each, one at a time and a word at a time.  Then the same with
+ * 4-bit values against bytes.
+ ***********************************************************************/
+void bench_packed(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      std::mt19937_64 random(235);
+      std::vector<uint64_t> bits((num + 15) / 16);     // enough for 4 bits each
+      for (size_t i = 0; i < bits.size(); i++)
+         bits[i] = random();
+      size_t peakCustom = 0;
+      size_t peakStd = 0;
+
+      double timeCustom = measure([&]() {
+         custom::bit_stack s;
+         for (size_t i = 0; i < num; i++)
+            s.push((bits[i / 64] >> (i % 64)) & 1);
+         unsigned long long count = 0;
+         while (!s.empty())
+         {
+            count += s.top();
+            s.pop();
+         }
+         sink = sink + count;
+         }, peakCustom);
+      double timeStd = measure([&]() {
+         custom::stack<bool> s;
+         for (size_t i = 0; i < num; i++)
+            s.push((bits[i / 64] >> (i % 64)) & 1);
+         unsigned long long count = 0;
+         while (!s.empty())
+         {
+            count += s.top();
+            s.pop();
+         }
+         sink = sink + count;
+         }, peakStd);
+      report("bit_stack push+pop", num, timeCustom, timeStd);
+      reportMemory("bit_stack peak memory", peakCustom, peakStd);
+
+      // a word of flags per call, against a byte a flag
+      size_t numWords = num / 64;
+      timeCustom = seconds([&]() {
+         custom::bit_stack s;
+         for (size_t i = 0; i < numWords; i++)
+            s.push_many(bits[i], 64);
+         unsigned long long count = 0;
+         while (!s.empty())
+            count += s.pop_many(64);
+         sink = sink + count;
+         });
+      timeStd = seconds([&]() {
+         custom::stack<bool> s;
+         for (size_t i = 0; i < numWords * 64; i++)
+            s.push((bits[i / 64] >> (i % 64)) & 1);
+         unsigned long long count = 0;
+         while (!s.empty())
+         {
+            count += s.top();
+            s.pop();
+         }
+         sink = sink + count;
+         });
+      report("bit_stack push_many 64", numWords * 64, timeCustom, timeStd);
+
+      timeCustom = measure([&]() {
+         custom::packed_stack<4> s;
+         for (size_t i = 0; i < num; i++)
+            s.push((uint8_t)(bits[i / 16] >> (i % 16 * 4)) & 0xF);
+         unsigned long long sum = 0;
+         while (!s.empty())
+         {
+            sum += s.top();
+            s.pop();
+         }
+         sink = sink + sum;
+         }, peakCustom);
+      timeStd = measure([&]() {
+         custom::stack<uint8_t> s;
+         for (size_t i = 0; i < num; i++)
+            s.push((uint8_t)(bits[i / 16] >> (i % 16 * 4)) & 0xF);
+         unsigned long long sum = 0;
+         while (!s.empty())
+         {
+            sum += s.top();
+            s.pop();
+         }
+         sink = sink + sum;
+         }, peakStd);
+      report("packed_stack<4> push+pop", num, timeCustom, timeStd);
+      reportMemory("packed_stack<4> peak memory", peakCustom, peakStd);
+   }
+}
+
+/**********************************************************************
+ * BENCH BOUNDED
+ * Push n numbers and pop them all through bounded_stack with a limit
+ * and watermarks, and through a stack whose vector draws on a
+ * budget, against a plain stack
+ ***********************************************************************/
+void bench_bounded(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      double timeStd = seconds([&]() {
+         custom::stack<unsigned long long> s;
+         for (size_t i = 0; i < num; i++)
+            s.push(i);
+         unsigned long long sum = 0;
+         while (!s.empty())
+         {
+            sum += s.top();
+            s.pop();
+         }
+         sink = sink + sum;
+         });
+      double timeCustom = seconds([&]() {
+         custom::bounded_stack<unsigned long long> s(num);
+         size_t numSignals = 0;
+         s.set_watermarks(num / 2 + 1, num / 4, [&]() { numSignals++; }, [&]() { numSignals++; });
+         for (size_t i = 0; i < num; i++)
+            s.try_push(i);
+         unsigned long long sum = 0;
+         while (!s.empty())
+         {
+            sum += s.top();
+            s.pop();
+         }
+         sink = sink + sum + numSignals;
+         });
+      report("bounded try_push+pop", num, timeCustom, timeStd);
+
+      timeCustom = seconds([&]() {
+         custom::allocation_budget budget(num * 4 * sizeof(unsigned long long));
+         custom::stack<unsigned long long,
+                       custom::vector<unsigned long long, custom::budget_allocator<unsigned long long>>>
+            s{ custom::budget_allocator<unsigned long long>(budget) };
+         for (size_t i = 0; i < num; i++)
+            s.push(i);
+         unsigned long long sum = 0;
+         while (!s.empty())
+         {
+            sum += s.top();
+            s.pop();
+         }
+         sink = sink + sum;
+         });
+      report("budget_allocator push+pop", num, timeCustom, timeStd);
+   }
+}
+
+/**********************************************************************
+ * BENCH HINT
+ * Make n short-lived stacks at one call site, each pushed to a depth
+ * of about 200 and popped empty, with a sizing hint and without.
+ * Also how many allocations each stack took.
+ ***********************************************************************/
+void bench_hint(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      std::mt19937 random(235);
+      std::vector<size_t> depths(num);
+      for (size_t i = 0; i < num; i++)
+         depths[i] = 180 + random() % 41;
+
+      size_t numNewStd = numNew.load(std::memory_order_relaxed);
+      double timeStd = seconds([&]() {
+         unsigned long long sum = 0;
+         for (size_t i = 0; i < num; i++)
+         {
+            custom::stack<unsigned long long> s;
+            for (size_t j = 0; j < depths[i]; j++)
+               s.push(j);
+            while (!s.empty())
+            {
+               sum += s.top();
+               s.pop();
+            }
+         }
+         sink = sink + sum;
+         });
+      numNewStd = numNew.load(std::memory_order_relaxed) - numNewStd;
+
+      static custom::sizing_hint hint;
+      size_t numNewCustom = numNew.load(std::memory_order_relaxed);
+      double timeCustom = seconds([&]() {
+         unsigned long long sum = 0;
+         for (size_t i = 0; i < num; i++)
+         {
+            custom::hinted_stack<unsigned long long> s(hint);
+            for (size_t j = 0; j < depths[i]; j++)
+               s.push(j);
+            while (!s.empty())
+            {
+               sum += s.top();
+               s.pop();
+            }
+         }
+         sink = sink + sum;
+         });
+      numNewCustom = numNew.load(std::memory_order_relaxed) - numNewCustom;
+
+      report("sizing_hint stacks", num, timeCustom, timeStd);
+      std::cout << std::left  << std::setw(28) << "sizing_hint allocs/stack"
+                << std::right << std::setw(12) << ""
+                << std::fixed << std::setprecision(2)
+                << std::setw(10) << (double)numNewCustom / (double)num << "   "
+                << std::setw(10) << (double)numNewStd    / (double)num << "    (baseline)"
+                << "\n";
+   }
+}
+
+/**********************************************************************
+ * BENCH REALLOC
+ * Grow a vector of numbers one push_back at a time to 10^6 bytes and
+ * up, with allocators that can grow a block without copying it,
+ * against the default allocator that always copies
+ ***********************************************************************/
+template <class Vector>
+double growTo(size_t num)
+{
+   return seconds([&]() {
+      Vector v;
+      for (size_t i = 0; i < num; i++)
+         v.push_back(i);
+      sink = sink + v[num - 1];
+      });
+}
+
+void bench_realloc(int maxPower)
+{
+   for (size_t numBytes = 1000000; maxPower-- > 5; numBytes *= 10)
+   {
+      size_t num = numBytes / sizeof(unsigned long long);
+      using plain   = custom::vector<unsigned long long>;
+      using realloc = custom::vector<unsigned long long, custom::realloc_allocator<unsigned long long>>;
+      using mremap  = custom::vector<unsigned long long, custom::mremap_allocator<unsigned long long>>;
+
+      // best of three, taking turns, so neither gets the warm heap
+      double timeStd = 1.0e9, timeRealloc = 1.0e9, timeMremap = 1.0e9;
+      for (int i = 0; i < 3; i++)
+      {
+         timeStd     = std::min(timeStd,     growTo<plain>(num));
+         timeRealloc = std::min(timeRealloc, growTo<realloc>(num));
+         timeMremap  = std::min(timeMremap,  growTo<mremap>(num));
+      }
+      report("grow realloc_allocator", num, timeRealloc, timeStd);
+      report("grow mremap_allocator", num, timeMremap, timeStd);
+   }
+}
+
+/**********************************************************************
+ * BENCH ALIGNED
+ * y = y / 2 + 1 over floats, a line of 16 at a time, as a SIMD kernel
+ * would.  From aligned_allocator the kernel may assume the array starts
+ * on a line and runs to the end of the last one, so every load is
+ * aligned and there is no tail.  From the default allocator it cannot,
+ * and when the elements do not start on a line (here, one float in)
+ * some loads straddle two.  One array, so where the allocator puts a
+ * second one cannot muddy the numbers.
+ ***********************************************************************/
+template <bool Aligned>
+void halve(float* y, size_t num)
+{
+#if defined(__GNUC__) || defined(__clang__)
+   if constexpr (Aligned)
+      y = static_cast<float*>(__builtin_assume_aligned(y, 64));
+#endif
+   size_t i = 0;
+   for (; i + 16 <= num; i += 16)
+      for (size_t j = 0; j < 16; j++)
+         y[i + j] = y[i + j] * 0.5f + 1.0f;
+   for (; i < num; i++)
+      y[i] = y[i] * 0.5f + 1.0f;
+}
+
+void bench_aligned(int maxPower)
+{
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      size_t numReps = num < 2000000 ? 10000000 / num : 5;
+      // the padding is there to be read, so make it elements
+      custom::vector<float, custom::aligned_allocator<float>> yAligned(num, 0.0f);
+      yAligned.resize(yAligned.capacity(), 0.0f);
+      size_t numPadded = yAligned.size();
+      custom::vector<float> y(num + 1, 0.0f);
+
+      // best of six, each going first twice, so none gets the warm cache
+      std::function<void()> kernels[3] = {
+         [&]() { halve<true>(&yAligned[0], numPadded); },
+         [&]() { halve<false>(&y[0], num); },
+         [&]() { halve<false>(&y[1], num); }
+      };
+      double times[3] = { 1.0e9, 1.0e9, 1.0e9 };
+      for (int i = 0; i < 6; i++)
+         for (int j = 0; j < 3; j++)
+         {
+            int which = (i + j) % 3;
+            times[which] = std::min(times[which], seconds([&]() {
+               for (size_t rep = 0; rep < numReps; rep++)
+                  kernels[which]();
+               }) / (double)numReps);
+         }
+      sink = sink + (size_t)yAligned[num - 1] + (size_t)y[num];
+      double timeAligned = times[0], timeStd = times[1], timeOff = times[2];
+      report("simd aligned_allocator", num, timeAligned, timeStd);
+      report("simd vs one float in", num, timeAligned, timeOff);
+   }
+}
+
+/**********************************************************************
+ * BENCH COMPACT
+ * One stack per vertex of a graph, most of them empty: num stacks in
+ * a std::vector, and one in ten given four elements.  Peak heap is the
+ * stacks themselves plus what the used ones hold, so at num = 10^6 it
+ * is the memory per million stacks, with compact_vector as the
+ * Container against custom::vector.
+ ***********************************************************************/
+template <class Stack>
+void fillStacks(std::vector<Stack>& stacks)
+{
+   for (size_t i = 0; i < stacks.size(); i += 10)
+      for (int j = 0; j < 4; j++)
+         stacks[i].push(j);
+   unsigned long long sum = 0;
+   for (size_t i = 0; i < stacks.size(); i += 10)
+      sum += stacks[i].top();
+   sink = sink + sum;
+}
+
+void bench_compact(int maxPower)
+{
+   using compact = custom::stack<int, custom::compact_vector<int>>;
+   using plain = custom::stack<int>;
+
+   for (size_t num = 1000; maxPower-- > 2; num *= 10)
+   {
+      size_t peakEmptyCustom = 0;
+      size_t peakEmptyStd = 0;
+      measure([&]() { std::vector<compact> stacks(num); }, peakEmptyCustom);
+      measure([&]() { std::vector<plain> stacks(num); }, peakEmptyStd);
+
+      size_t peakCustom = 0;
+      size_t peakStd = 0;
+      double timeCustom = measure([&]() {
+         std::vector<compact> stacks(num);
+         fillStacks(stacks);
+         }, peakCustom);
+      double timeStd = measure([&]() {
+         std::vector<plain> stacks(num);
+         fillStacks(stacks);
+         }, peakStd);
+
+      report("compact 1 in 10 used", num, timeCustom, timeStd);
+      reportMemory("compact empty peak heap", peakEmptyCustom, peakEmptyStd);
+      reportMemory("compact used peak heap", peakCustom, peakStd);
+   }
+}
+
+/**********************************************************************
+ * BENCH HUGE
+ * Push, copy and pop 3 x 10^maxPower one-byte elements: at 9, past
+ * what an int can count, to show sizes stay right that far.  It
+ * checks what it pops, and says so if anything is off.  It needs
+ * several times that many bytes of memory, so "all" skips it; ask for
+ * it by name:  benchStack huge 9
+ ***********************************************************************/
+void bench_huge(int maxPower)
+{
+   size_t num = 3;
+   for (int i = 0; i < maxPower; i++)
+      num *= 10;
+
+   bool right = true;
+   double timeCustom = seconds([&]() {
+      custom::stack<unsigned char> s;
+      for (size_t i = 0; i < num; i++)
+         s.push((unsigned char)i);
+      custom::stack<unsigned char> copy(s);
+      right = right && copy.size() == num;
+      for (size_t i = num; i-- > 0; )
+      {
+         right = right && s.top() == (unsigned char)i;
+         s.pop();
+      }
+      right = right && s.empty() && copy.top() == (unsigned char)(num - 1);
+      });
+
+   double timeStd = seconds([&]() {
+      std::stack<unsigned char> s;
+      for (size_t i = 0; i < num; i++)
+         s.push((unsigned char)i);
+      std::stack<unsigned char> copy(s);
+      for (size_t i = num; i-- > 0; )
+      {
+         sink = sink + s.top();
+         s.pop();
+      }
+      sink = sink + copy.size();
+      });
+
+   report("huge push copy pop", num, timeCustom, timeStd);
+   if (!right)
+      std::cout << "huge: custom::stack lost track of its elements\n";
+}
+
+/**********************************************************************
+ * MAIN
+ * Run one benchmark by name, or all of them
+ ***********************************************************************/
+int main(int argc, char** argv)
+{
+   const char* which = argc > 1 ? argv[1] : "all";
+   int maxPower = argc > 2 ? std::atoi(argv[2]) : 6;
+
+   struct { const char* name; void (*bench)(int); } benchmarks[] =
+   {
+      { "pqueue", bench_pqueue },
+      { "hash",   bench_hash   },
+      { "persistent", bench_persistent },
+      { "frame",  bench_frame  },
+      { "soa",    bench_soa    },
+      { "rpn",    bench_rpn    },
+      { "dfs",    bench_dfs    },
+      { "brackets", bench_brackets },
+      { "concurrent", bench_concurrent },
+      { "sync",   bench_sync   },
+      { "perthread", bench_perthread },
+      { "insert", bench_insert },
+      { "eraseif", bench_eraseif },
+      { "overwrite", bench_overwrite },
+      { "fdio",   bench_fdio   },
+      { "spill",  bench_spill  },
+      { "compressed", bench_compressed },
+      { "packed", bench_packed },
+      { "bounded", bench_bounded },
+      { "hint",   bench_hint   },
+      { "realloc", bench_realloc },
+      { "aligned", bench_aligned },
+      { "compact", bench_compact },
+#ifdef __cpp_impl_coroutine
+      { "async",  bench_async  },
+#endif // __cpp_impl_coroutine
+   };
+
+   for (auto& benchmark : benchmarks)
+      if (std::strcmp(which, "all") == 0 || std::strcmp(which, benchmark.name) == 0)
+         benchmark.bench(maxPower);
+
+   // too big to run with the rest: only when asked for by name
+   if (std::strcmp(which, "huge") == 0)
+      bench_huge(maxPower);
+
+   return 0;
+}
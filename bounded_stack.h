@@ -0,0 +1,298 @@
+/***********************************************************************
+ * Module:
+ *    Bounded Stack
+ * Summary:
+ *    Limits on how big a stack may grow: at most N elements, watermarks
+ *    that tell producers to back off, and a budget of bytes
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       allocation_budget     : bytes that any number of allocators share
+ *       budget_allocator      : an allocator that draws on a budget
+ *       bounded_stack         : a stack with a maximum size and watermarks
+ *
+ *    A stack that is not bounded pays nothing for this: custom::stack
+ *    is untouched, and the limits live in an adapter around it.
+ *
+ *    The watermarks signal once per crossing.  Reaching the high one
+ *    calls onHigh; nothing more is said until the stack gets back down
+ *    to the low one and onLow is called.
+ *
+ *    The budget is enforced where the memory is handed out: a
+ *    budget_allocator that would go over throws std::bad_alloc, which
+ *    leaves the vector as it was.  A budget counts with an atomic so
+ *    stacks on different threads can share one.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>       // for std::atomic
+#include <cassert>      // because I am paranoid
+#include <cstddef>      // for size_t
+#include <functional>   // for std::function
+#include <limits>       // for std::numeric_limits
+#include <new>          // for std::bad_alloc, ::operator new
+#include <stdexcept>    // for std::length_error, std::invalid_argument
+#include <type_traits>  // for std::true_type
+#include <utility>      // for std::move
+#include "stack.h"
+
+class TestBoundedStack; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /**************************************************
+    * ALLOCATION BUDGET
+    * A number of bytes to be handed out and given back
+    *************************************************/
+   class allocation_budget
+   {
+   public:
+      explicit allocation_budget(size_t limit) : limit(limit), used(0) {}
+      allocation_budget(const allocation_budget&) = delete;
+      allocation_budget& operator = (const allocation_budget&) = delete;
+
+      // take numBytes if that does not go over the limit
+      bool try_take(size_t numBytes)
+      {
+         size_t now = used.load(std::memory_order_relaxed);
+         do
+         {
+            if (numBytes > limit - now)
+               return false;
+         }
+         while (!used.compare_exchange_weak(now, now + numBytes, std::memory_order_relaxed));
+         return true;
+      }
+      void give_back(size_t numBytes)
+      {
+         assert(numBytes <= used.load(std::memory_order_relaxed));
+         used.fetch_sub(numBytes, std::memory_order_relaxed);
+      }
+
+      size_t limit_bytes() const { return limit; }
+      size_t used_bytes()  const { return used.load(std::memory_order_relaxed); }
+
+   private:
+      size_t              limit;
+      std::atomic<size_t> used;
+   };
+
+   /**************************************************
+    * BUDGET ALLOCATOR
+    * std::allocator, except every byte comes out of a budget.
+    * One made without a budget has no limit.
+    *************************************************/
+   template <class T>
+   class budget_allocator
+   {
+   public:
+      using value_type = T;
+
+      // the budget goes wherever the elements go
+      using propagate_on_container_copy_assignment = std::true_type;
+      using propagate_on_container_move_assignment = std::true_type;
+      using propagate_on_container_swap            = std::true_type;
+
+      budget_allocator() : budget(nullptr) {}
+      explicit budget_allocator(allocation_budget& budget) : budget(&budget) {}
+      template <class U>
+      budget_allocator(const budget_allocator<U>& rhs) : budget(rhs.budget) {}
+
+      T* allocate(size_t num)
+      {
+         if (num > std::numeric_limits<size_t>::max() / sizeof(T))
+            throw std::bad_alloc();
+         if (budget && !budget->try_take(num * sizeof(T)))
+            throw std::bad_alloc();
+         try
+         {
+            return static_cast<T*>(::operator new(num * sizeof(T)));
+         }
+         catch (...)
+         {
+            if (budget)
+               budget->give_back(num * sizeof(T));
+            throw;
+         }
+      }
+      void deallocate(T* p, size_t num)
+      {
+         ::operator delete(p);
+         if (budget)
+            budget->give_back(num * sizeof(T));
+      }
+
+      allocation_budget* get_budget() const { return budget; }
+
+      template <class U>
+      bool operator == (const budget_allocator<U>& rhs) const { return budget == rhs.budget; }
+      template <class U>
+      bool operator != (const budget_allocator<U>& rhs) const { return budget != rhs.budget; }
+
+   private:
+      template <class U> friend class budget_allocator;
+      allocation_budget* budget;
+   };
+
+   /**************************************************
+    * BOUNDED STACK
+    * First-in-Last-out, up to a maximum number of elements
+    *************************************************/
+   template <class T, class Container = custom::vector<T>>
+   class bounded_stack
+   {
+      friend class ::TestBoundedStack; // give unit tests access to private members
+   public:
+
+      using callback_type = std::function<void()>;
+
+      //
+      // Construct
+      //
+
+      explicit bounded_stack(size_t maxSize = std::numeric_limits<size_t>::max()) :
+         maxSize(maxSize),
+         highWater(std::numeric_limits<size_t>::max()),
+         lowWater(0),
+         isHigh(false)
+      {}
+      bounded_stack(size_t maxSize, const Container& container) :
+         items(container),
+         maxSize(maxSize),
+         highWater(std::numeric_limits<size_t>::max()),
+         lowWater(0),
+         isHigh(false)
+      {}
+
+      // call onHigh when the stack grows to high, and onLow when it
+      // gets back down to low
+      void set_watermarks(size_t high, size_t low, callback_type onHigh, callback_type onLow)
+      {
+         if (low >= high)
+            throw std::invalid_argument("bounded_stack: low watermark must be under high");
+         highWater = high;
+         lowWater = low;
+         this->onHigh = std::move(onHigh);
+         this->onLow = std::move(onLow);
+         isHigh = false;
+         checkHigh();
+      }
+
+      //
+      // Access
+      //
+
+      T& top()             { return items.top(); }
+      const T& top() const { return items.top(); }
+
+      //
+      // Insert
+      //
+
+      // false, and nothing pushed, when full or out of budget
+      bool try_push(const T& t)
+      {
+         if (items.size() >= maxSize)
+            return false;
+         try
+         {
+            items.push(t);
+         }
+         catch (const std::bad_alloc&)
+         {
+            return false;
+         }
+         checkHigh();
+         return true;
+      }
+      bool try_push(T&& t)
+      {
+         if (items.size() >= maxSize)
+            return false;
+         try
+         {
+            items.push(std::move(t));
+         }
+         catch (const std::bad_alloc&)
+         {
+            return false;
+         }
+         checkHigh();
+         return true;
+      }
+
+      // as try_push, but throw when full
+      void push(const T& t)
+      {
+         if (items.size() >= maxSize)
+            throw std::length_error("bounded_stack: full");
+         items.push(t);
+         checkHigh();
+      }
+      void push(T&& t)
+      {
+         if (items.size() >= maxSize)
+            throw std::length_error("bounded_stack: full");
+         items.push(std::move(t));
+         checkHigh();
+      }
+
+      //
+      // Remove
+      //
+
+      void pop()
+      {
+         items.pop();
+         if (isHigh && items.size() <= lowWater)
+         {
+            isHigh = false;
+            if (onLow)
+               onLow();
+         }
+      }
+
+      //
+      // Status
+      //
+
+      size_t size()     const { return items.size();  }
+      bool   empty()    const { return items.empty(); }
+      bool   full()     const { return items.size() >= maxSize; }
+      size_t max_size() const { return maxSize; }
+
+      // between reaching the high watermark and getting back to the low
+      bool above_high_water() const { return isHigh; }
+
+   private:
+
+      void checkHigh()
+      {
+         if (!isHigh && items.size() >= highWater)
+         {
+            isHigh = true;
+            if (onHigh)
+               onHigh();
+         }
+      }
+
+      custom::stack<T, Container> items;
+      size_t        maxSize;
+      size_t        highWater;
+      size_t        lowWater;
+      bool          isHigh;       // onHigh was called and onLow not yet
+      callback_type onHigh;
+      callback_type onLow;
+   };
+
+} // custom namespace
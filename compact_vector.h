@@ -0,0 +1,440 @@
+/***********************************************************************
+ * Header:
+ *    COMPACT VECTOR
+ * Summary:
+ *    A vector whose handle is as small as it can be: a pointer and
+ *    two 32-bit counts, with a stateless allocator taking no room
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *        compact_vector         : a vector of up to 2^32 - 1 elements
+ *                                 in 16 bytes (12 on a 32-bit build)
+ *
+ *    custom::vector keeps its allocator, a pointer, and two size_t
+ *    counts: 32 bytes on a 64-bit build even when the allocator has
+ *    nothing in it.  When
+ *    there are millions of them, mostly empty (one stack per vertex of
+ *    a graph, say), that is most of the memory.  compact_vector keeps
+ *    the counts in 32 bits and marks the allocator [[no_unique_address]]
+ *    so a stateless one overlaps the rest; it holds everything a stack
+ *    needs, so it can be the Container:
+ *       custom::stack<int, custom::compact_vector<int>>
+ *    Growing past max_size() throws std::length_error.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>          // because I am paranoid
+#include <cstdint>          // for uint32_t
+#include <cstring>          // for std::memcpy
+#include <initializer_list> // for std::initializer_list
+#include <memory>           // for std::allocator, std::allocator_traits
+#include <stdexcept>        // for std::length_error
+#include <type_traits>      // for std::is_trivially_copyable
+#include <utility>          // for std::move, std::forward, std::swap
+
+// MSVC only honours its own spelling
+#if defined(_MSC_VER) && !defined(__clang__)
+#define CUSTOM_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define CUSTOM_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+
+class TestCompactVector; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /*****************************************
+    * COMPACT VECTOR
+    * custom::vector in half the space, for
+    * up to 2^32 - 1 elements
+    ****************************************/
+   template <typename T, typename A = std::allocator<T>>
+   class compact_vector
+   {
+      friend class ::TestCompactVector; // give unit tests access to private
+
+      using alloc_traits = std::allocator_traits<A>;
+
+   public:
+
+      using value_type = T;
+      using allocator_type = A;
+      using size_type = uint32_t;
+      using iterator = T*;
+      using const_iterator = const T*;
+
+      //
+      // Construct
+      //
+      compact_vector(const A& a = A()) :
+         data(nullptr), numCapacity(0), numElements(0), alloc(a)
+      {
+      }
+      compact_vector(size_t num, const A& a = A()) : compact_vector(a)
+      {
+         resize(num);
+      }
+      compact_vector(size_t num, const T& t, const A& a = A()) : compact_vector(a)
+      {
+         resize(num, t);
+      }
+      compact_vector(const std::initializer_list<T>& l, const A& a = A()) : compact_vector(a)
+      {
+         reserve(l.size());
+         for (const T& t : l)
+            construct(data + numElements++, t);
+      }
+      compact_vector(const compact_vector& rhs) :
+         compact_vector(rhs, alloc_traits::select_on_container_copy_construction(rhs.alloc))
+      {
+      }
+      compact_vector(const compact_vector& rhs, const A& a);
+      compact_vector(compact_vector&& rhs) :
+         data(rhs.data), numCapacity(rhs.numCapacity), numElements(rhs.numElements),
+         alloc(std::move(rhs.alloc))
+      {
+         rhs.data = nullptr;
+         rhs.numCapacity = 0;
+         rhs.numElements = 0;
+      }
+      ~compact_vector()
+      {
+         clear();
+         deallocate();
+      }
+
+      //
+      // Assign
+      //
+      compact_vector& operator = (const compact_vector& rhs);
+      compact_vector& operator = (compact_vector&& rhs);
+      void swap(compact_vector& rhs)
+      {
+         std::swap(data, rhs.data);
+         std::swap(numCapacity, rhs.numCapacity);
+         std::swap(numElements, rhs.numElements);
+         if constexpr (alloc_traits::propagate_on_container_swap::value)
+         {
+            using std::swap;
+            swap(alloc, rhs.alloc);
+         }
+         else
+            assert(alloc == rhs.alloc);   // anything else is undefined, as in std::vector
+      }
+
+      //
+      // Iterator
+      //
+      iterator       begin()       { return data;               }
+      iterator       end()         { return data + numElements; }
+      const_iterator begin() const { return data;               }
+      const_iterator end()   const { return data + numElements; }
+
+      //
+      // Access
+      //
+      T& operator [] (size_t index)
+      {
+         assert(index < numElements);
+         return data[index];
+      }
+      const T& operator [] (size_t index) const
+      {
+         assert(index < numElements);
+         return data[index];
+      }
+      T& front()             { return (*this)[0];               }
+      const T& front() const { return (*this)[0];               }
+      T& back()              { return (*this)[numElements - 1]; }
+      const T& back() const  { return (*this)[numElements - 1]; }
+
+      //
+      // Insert
+      //
+      void push_back(const T& t)
+      {
+         emplace_back(t);
+      }
+      void push_back(T&& t)
+      {
+         emplace_back(std::move(t));
+      }
+      template <class ... Args>
+      T& emplace_back(Args&& ... args);
+      void reserve(size_t newCapacity);
+      void resize(size_t newElements);
+      void resize(size_t newElements, const T& t);
+
+      //
+      // Remove
+      //
+      void clear()
+      {
+         truncate(0);
+      }
+      void truncate(size_t newElements)
+      {
+         if (newElements < numElements)
+         {
+            destroy(data + newElements, data + numElements);
+            numElements = (size_type)newElements;
+         }
+      }
+      void pop_back()
+      {
+         if (numElements != 0)
+         {
+            alloc_traits::destroy(alloc, data + numElements - 1);
+            numElements--;
+         }
+      }
+      void shrink_to_fit();
+
+      //
+      // Status
+      //
+      size_t  size()          const { return numElements;      }
+      size_t  capacity()      const { return numCapacity;      }
+      bool    empty()         const { return numElements == 0; }
+      A       get_allocator() const { return alloc;            }
+      static constexpr size_t max_size() { return (size_type)-1; }
+
+   private:
+
+      T* allocate(size_t num)
+      {
+         return num != 0 ? alloc_traits::allocate(alloc, num) : nullptr;
+      }
+      void deallocate()
+      {
+         if (data != nullptr)
+            alloc_traits::deallocate(alloc, data, numCapacity);
+      }
+      template <class ... Args>
+      void construct(T* p, Args&& ... args)
+      {
+         alloc_traits::construct(alloc, p, std::forward<Args>(args)...);
+      }
+
+      // destroy [first, last); a no-op when T has a trivial destructor
+      void destroy(T* first, T* last)
+      {
+         if constexpr (!std::is_trivially_destructible<T>::value)
+            for (; first != last; first++)
+               alloc_traits::destroy(alloc, first);
+      }
+
+      // move every element into a buffer of newCapacity
+      void reallocate(size_t newCapacity);
+
+      // the capacity after growing to hold num: double, up to max_size()
+      static size_t grownCapacity(size_t numCapacity, size_t num)
+      {
+         if (num > max_size())
+            throw std::length_error("compact_vector: more than max_size() elements");
+         size_t newCapacity = numCapacity * 2;
+         if (newCapacity > max_size())
+            newCapacity = max_size();
+         return newCapacity < num ? num : newCapacity;
+      }
+
+      T* data;                            // user data, a dynamically-allocated array
+      size_type numCapacity;              // the capacity of the array
+      size_type numElements;              // the number of items currently used
+      CUSTOM_NO_UNIQUE_ADDRESS A alloc;   // no room at all when it has no state
+   };
+
+   /*****************************************
+    * COMPACT VECTOR :: COPY CONSTRUCTOR
+    * Allocate exactly enough and copy each element,
+    * or all of them at once if they are just bytes
+    ****************************************/
+   template <typename T, typename A>
+   compact_vector <T, A> ::compact_vector(const compact_vector& rhs, const A& a) :
+      compact_vector(a)
+   {
+      if (rhs.empty())
+         return;
+      data = allocate(rhs.numElements);
+      numCapacity = rhs.numElements;
+      if constexpr (std::is_trivially_copyable<T>::value)
+         std::memcpy(static_cast<void*>(data), static_cast<const void*>(rhs.data),
+                     rhs.numElements * sizeof(T));
+      else
+         for (size_type i = 0; i < rhs.numElements; i++)
+            construct(data + i, rhs.data[i]);
+      numElements = rhs.numElements;
+   }
+
+   /***************************************
+    * COMPACT VECTOR :: ASSIGNMENT
+    * Copy: reuse the buffer when it is big enough.
+    * Move: take rhs's buffer when our allocator can
+    * free it, otherwise move the elements one by one.
+    **************************************/
+   template <typename T, typename A>
+   compact_vector <T, A>& compact_vector <T, A> :: operator = (const compact_vector& rhs)
+   {
+      if (this == &rhs)
+         return *this;
+
+      if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+      {
+         if (alloc != rhs.alloc)
+         {
+            clear();
+            deallocate();
+            data = nullptr;
+            numCapacity = 0;
+         }
+         alloc = rhs.alloc;
+      }
+
+      clear();
+      reserve(rhs.numElements);
+      for (; numElements < rhs.numElements; numElements++)
+         construct(data + numElements, rhs.data[numElements]);
+      return *this;
+   }
+
+   template <typename T, typename A>
+   compact_vector <T, A>& compact_vector <T, A> :: operator = (compact_vector&& rhs)
+   {
+      if (this == &rhs)
+         return *this;
+
+      if constexpr (!alloc_traits::propagate_on_container_move_assignment::value &&
+                    !alloc_traits::is_always_equal::value)
+      {
+         if (alloc != rhs.alloc)
+         {
+            clear();
+            reserve(rhs.numElements);
+            for (size_type i = 0; i < rhs.numElements; i++)
+               construct(data + i, std::move(rhs.data[i]));
+            numElements = rhs.numElements;
+            rhs.clear();
+            return *this;
+         }
+      }
+
+      clear();
+      deallocate();
+      if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+         alloc = std::move(rhs.alloc);
+      data = rhs.data;
+      numCapacity = rhs.numCapacity;
+      numElements = rhs.numElements;
+      rhs.data = nullptr;
+      rhs.numCapacity = 0;
+      rhs.numElements = 0;
+      return *this;
+   }
+
+   /***************************************
+    * COMPACT VECTOR :: EMPLACE BACK
+    * Construct a new element at the end, doubling
+    * the capacity when it is full
+    **************************************/
+   template <typename T, typename A>
+   template <class ... Args>
+   T& compact_vector <T, A> ::emplace_back(Args&& ... args)
+   {
+      if (numElements == numCapacity)
+         reallocate(grownCapacity(numCapacity, (size_t)numElements + 1));
+      construct(data + numElements, std::forward<Args>(args)...);
+      return data[numElements++];
+   }
+
+   /***************************************
+    * COMPACT VECTOR :: RESERVE and RESIZE
+    * As custom::vector, short of max_size()
+    **************************************/
+   template <typename T, typename A>
+   void compact_vector <T, A> ::reserve(size_t newCapacity)
+   {
+      if (newCapacity <= numCapacity)
+         return;
+      if (newCapacity > max_size())
+         throw std::length_error("compact_vector: more than max_size() elements");
+      reallocate(newCapacity);
+   }
+
+   template <typename T, typename A>
+   void compact_vector <T, A> ::resize(size_t newElements)
+   {
+      if (newElements <= numElements)
+      {
+         truncate(newElements);
+         return;
+      }
+      reserve(newElements);
+      for (size_t i = numElements; i < newElements; i++)
+         construct(data + i);
+      numElements = (size_type)newElements;
+   }
+
+   template <typename T, typename A>
+   void compact_vector <T, A> ::resize(size_t newElements, const T& t)
+   {
+      if (newElements <= numElements)
+      {
+         truncate(newElements);
+         return;
+      }
+      reserve(newElements);
+      for (size_t i = numElements; i < newElements; i++)
+         construct(data + i, t);
+      numElements = (size_type)newElements;
+   }
+
+   /***************************************
+    * COMPACT VECTOR :: SHRINK TO FIT
+    * Get rid of any extra capacity
+    **************************************/
+   template <typename T, typename A>
+   void compact_vector <T, A> ::shrink_to_fit()
+   {
+      if (numCapacity > numElements)
+         reallocate(numElements);
+   }
+
+   /***************************************
+    * COMPACT VECTOR :: REALLOCATE
+    * Move the elements to a new buffer of newCapacity,
+    * all at once if they are just bytes
+    **************************************/
+   template <typename T, typename A>
+   void compact_vector <T, A> ::reallocate(size_t newCapacity)
+   {
+      assert(newCapacity >= numElements && newCapacity <= max_size());
+      T* dataNew = allocate(newCapacity);
+      if constexpr (std::is_trivially_copyable<T>::value)
+      {
+         if (numElements != 0)
+            std::memcpy(static_cast<void*>(dataNew), static_cast<const void*>(data),
+                        numElements * sizeof(T));
+      }
+      else
+         for (size_type i = 0; i < numElements; i++)
+         {
+            construct(dataNew + i, std::move(data[i]));
+            alloc_traits::destroy(alloc, data + i);
+         }
+      deallocate();
+
+      data = dataNew;
+      numCapacity = (size_type)newCapacity;
+   }
+
+} // namespace custom
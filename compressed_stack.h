@@ -0,0 +1,259 @@
+/***********************************************************************
+ * Module:
+ *    Compressed Stack
+ * Summary:
+ *    A stack of integers that keeps all but the top few hundred
+ *    delta-encoded and bit-packed
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       compressed_stack      : a stack of integers in sealed, packed segments
+ *
+ *    The top of the stack is a plain array of up to two segments.  When
+ *    it fills, the older segment is sealed: each element is stored as
+ *    the difference from the one before, zigzagged so small negative
+ *    differences are small too, in just enough bits for the largest.
+ *    A run of IDs that go up a little at a time takes a few bits each.
+ *    When the top empties, the segment below is unpacked into it.  The
+ *    hot array holds a full segment after that, so pushing and popping
+ *    across a boundary does not seal and unseal over and over.
+ *
+ *    Unpacking is two passes: pulling each field out is a load, a shift
+ *    and a mask with no branches and nothing carried from one element to
+ *    the next, so the compiler can vectorize it; then a running sum puts
+ *    the differences back together.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>      // because I am paranoid
+#include <cstdint>      // for uint64_t
+#include <cstring>      // for std::memcpy, std::memset
+#include <type_traits>  // for std::is_integral, std::make_unsigned
+#include "vector.h"
+
+class TestCompressedStack; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /**************************************************
+    * COMPRESSED STACK
+    * First-in-Last-out, for integers, in less memory
+    *************************************************/
+   template <class T>
+   class compressed_stack
+   {
+      friend class ::TestCompressedStack; // give unit tests access to private members
+
+      static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value,
+                    "compressed_stack holds integers");
+      static_assert(sizeof(T) <= sizeof(uint64_t), "compressed_stack packs into 64 bits");
+
+      using U = typename std::make_unsigned<T>::type;
+
+   public:
+
+      static const size_t SEGMENT = 128;   // elements sealed together
+
+      //
+      // Construct
+      //
+
+      compressed_stack() : numBytes(0) {}
+
+      //
+      // Access
+      //
+
+      T& top()
+      {
+         assert(!hot.empty());
+         return hot.back();
+      }
+      const T& top() const
+      {
+         assert(!hot.empty());
+         return hot.back();
+      }
+
+      //
+      // Insert
+      //
+
+      void push(const T& t)
+      {
+         if (hot.size() == 2 * SEGMENT)
+            seal();
+         hot.push_back(t);
+      }
+
+      //
+      // Remove
+      //
+
+      void pop()
+      {
+         assert(!hot.empty());
+         hot.pop_back();
+         if (hot.empty() && !blocks.empty())
+            unseal();
+      }
+      void clear()
+      {
+         hot.clear();
+         blocks.clear();
+         bytes.clear();
+         numBytes = 0;
+      }
+
+      //
+      // Status
+      //
+
+      size_t size()  const { return blocks.size() * SEGMENT + hot.size(); }
+      bool   empty() const { return hot.empty(); }
+      size_t sealed_size() const { return blocks.size() * SEGMENT; }
+
+      // everything allocated, for comparing against sizeof(T) * size()
+      size_t memory_bytes() const
+      {
+         return hot.capacity() * sizeof(T) + bytes.capacity() + blocks.capacity() * sizeof(Block);
+      }
+
+   private:
+
+      // one sealed segment; its bits sit at the end of the ones before it
+      struct Block
+      {
+         U             first;     // the first element, as is
+         unsigned char width;     // bits per difference, or RAW
+      };
+
+      // wider than this and a field may straddle a 64-bit load
+      static const unsigned int MAX_PACKED = 56;
+      static const unsigned int RAW = 64;    // differences stored as whole words
+
+      static size_t blockBytes(unsigned int width)
+      {
+         return ((SEGMENT - 1) * width + 7) / 8;
+      }
+
+      // move the bottom segment of hot into the packed bytes
+      void seal();
+
+      // unpack the top block into hot
+      void unseal();
+
+      custom::vector<T>             hot;        // the top of the stack, as is
+      custom::vector<Block>         blocks;     // bottom to top
+      custom::vector<unsigned char> bytes;      // the packed differences, then slack
+      size_t                        numBytes;   // bytes in use, not counting the slack
+   };
+
+   /*****************************************
+    * COMPRESSED STACK :: SEAL
+    * Zigzag the differences, find how many bits the largest needs,
+    * and pack them that wide.  The bytes keep eight more past the
+    * end so reading or writing a field never runs off.
+    ****************************************/
+   template <class T>
+   void compressed_stack<T>::seal()
+   {
+      assert(hot.size() >= SEGMENT);
+
+      uint64_t zigzag[SEGMENT - 1];
+      uint64_t all = 0;
+      for (size_t i = 1; i < SEGMENT; i++)
+      {
+         U difference = (U)((U)hot[i] - (U)hot[i - 1]);
+         int64_t d = (int64_t)(typename std::make_signed<U>::type)difference;
+         zigzag[i - 1] = ((uint64_t)d << 1) ^ (uint64_t)(d >> 63);
+         all |= zigzag[i - 1];
+      }
+
+      unsigned int width = 0;
+      while (width < 64 && (all >> width) != 0)
+         width++;
+      if (width > MAX_PACKED)
+         width = RAW;
+
+      // resize() grows to exactly what it is asked for: double instead
+      size_t numNew = blockBytes(width);
+      if (numBytes + numNew + 8 > bytes.capacity())
+         bytes.reserve(2 * bytes.capacity() > numBytes + numNew + 8 ?
+                       2 * bytes.capacity() : numBytes + numNew + 8);
+      bytes.resize(numBytes + numNew + 8);
+      unsigned char* p = &bytes[numBytes];
+      std::memset(p, 0, numNew + 8);
+      if (width == RAW)
+         std::memcpy(p, zigzag, sizeof(zigzag));
+      else
+         for (size_t i = 0; i < SEGMENT - 1; i++)
+         {
+            size_t bit = i * width;
+            uint64_t word;
+            std::memcpy(&word, p + bit / 8, sizeof(word));
+            word |= zigzag[i] << (bit % 8);
+            std::memcpy(p + bit / 8, &word, sizeof(word));
+         }
+      numBytes += numNew;
+
+      Block block;
+      block.first = (U)hot[0];
+      block.width = (unsigned char)width;
+      blocks.push_back(block);
+      hot.erase(hot.begin(), typename custom::vector<T>::iterator(SEGMENT, hot));
+   }
+
+   /*****************************************
+    * COMPRESSED STACK :: UNSEAL
+    ****************************************/
+   template <class T>
+   void compressed_stack<T>::unseal()
+   {
+      assert(hot.empty() && !blocks.empty());
+      Block block = blocks.back();
+      blocks.pop_back();
+      unsigned int width = block.width;
+      numBytes -= blockBytes(width);
+      const unsigned char* p = &bytes[numBytes];
+
+      // pull the fields out: every element on its own
+      uint64_t zigzag[SEGMENT - 1];
+      if (width == RAW)
+         std::memcpy(zigzag, p, sizeof(zigzag));
+      else
+      {
+         uint64_t mask = ((uint64_t)1 << width) - 1;
+         for (size_t i = 0; i < SEGMENT - 1; i++)
+         {
+            size_t bit = i * width;
+            uint64_t word;
+            std::memcpy(&word, p + bit / 8, sizeof(word));
+            zigzag[i] = (word >> (bit % 8)) & mask;
+         }
+      }
+
+      // add the differences back up
+      hot.resize_for_overwrite(SEGMENT);
+      U value = block.first;
+      hot[0] = (T)value;
+      for (size_t i = 1; i < SEGMENT; i++)
+      {
+         uint64_t z = zigzag[i - 1];
+         value = (U)(value + (U)((z >> 1) ^ (0 - (z & 1))));
+         hot[i] = (T)value;
+      }
+      bytes.resize(numBytes + 8);
+   }
+
+} // custom namespace
@@ -0,0 +1,234 @@
+/***********************************************************************
+ * Module:
+ *    Concurrent Array Stack
+ * Summary:
+ *    A bounded stack that many threads can push and pop at once
+ *    without locks and without allocating
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       concurrent_array_stack  : a lock-free MPMC stack of fixed capacity
+ *
+ *    Every element lives in a slot of one array allocated up front.  The
+ *    slots are threaded onto two lists by index: the stack itself and
+ *    the free slots.  Each list's head is one 64-bit atomic packing the
+ *    top index with a version that changes on every update, so a thread
+ *    that read an old head cannot succeed with a stale compare-exchange
+ *    (the ABA problem).  try_push takes a free slot, builds the element
+ *    in it and links it onto the stack; try_pop does the reverse.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>       // for std::atomic
+#include <cassert>      // because I am paranoid
+#include <cstdint>      // for uint32_t, uint64_t
+#include <memory>       // for std::allocator
+#include <new>          // for placement new
+#include <utility>      // for std::move, std::forward
+
+class TestConcurrentArrayStack; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /**************************************************
+    * CONCURRENT ARRAY STACK
+    * First-in-Last-out, safe to share between threads
+    *************************************************/
+   template<class T>
+   class concurrent_array_stack
+   {
+      friend class ::TestConcurrentArrayStack; // give unit tests access to private members
+   public:
+
+      //
+      // Construct
+      //
+
+      concurrent_array_stack(size_t numCapacity);
+      concurrent_array_stack(const concurrent_array_stack& rhs) = delete;
+      concurrent_array_stack& operator = (const concurrent_array_stack& rhs) = delete;
+      ~concurrent_array_stack();
+
+      //
+      // Insert
+      //
+
+      bool try_push(const T& t)
+      {
+         return try_emplace(t);
+      }
+      bool try_push(T&& t)
+      {
+         return try_emplace(std::move(t));
+      }
+      template <class ... Args>
+      bool try_emplace(Args&& ... args);
+
+      //
+      // Remove
+      //
+
+      bool try_pop(T& t);
+
+      //
+      // Status
+      //
+
+      // only a snapshot when other threads are busy with the stack
+      bool   empty   () const { return indexOf(full.load(std::memory_order_acquire)) == NIL; }
+      size_t capacity() const { return numCapacity; }
+
+   private:
+
+      static constexpr uint32_t NIL = 0xFFFFFFFF;   // the end of a list
+
+      struct Slot
+      {
+         std::atomic<uint32_t> next;             // the slot underneath on the same list
+         alignas(T) unsigned char bytes[sizeof(T)];
+      };
+
+      // a list head is (version << 32) | index
+      static uint32_t indexOf(uint64_t head)   { return (uint32_t)head;         }
+      static uint32_t versionOf(uint64_t head) { return (uint32_t)(head >> 32); }
+      static uint64_t pack(uint32_t index, uint32_t version)
+      {
+         return ((uint64_t)version << 32) | index;
+      }
+
+      T* element(uint32_t i) { return reinterpret_cast<T*>(slots[i].bytes); }
+
+      uint32_t popIndex(std::atomic<uint64_t>& head);
+      void pushIndex(std::atomic<uint64_t>& head, uint32_t i);
+
+      Slot*  slots;                              // every element, allocated once
+      size_t numCapacity;                        // how many slots there are
+
+      // the two heads sit on their own cache lines so pushers and
+      // poppers on one list do not slow down the other
+      alignas(64) std::atomic<uint64_t> full;    // the stack
+      alignas(64) std::atomic<uint64_t> unused;  // the free slots
+   };
+
+   /*****************************************
+    * CONCURRENT ARRAY STACK :: CONSTRUCTOR
+    * Allocate every slot and put them all on the free list
+    ****************************************/
+   template <class T>
+   concurrent_array_stack<T>::concurrent_array_stack(size_t numCapacity) :
+      slots(nullptr), numCapacity(numCapacity), full(pack(NIL, 0)), unused(pack(NIL, 0))
+   {
+      assert(numCapacity < NIL);
+      if (numCapacity == 0)
+         return;
+      slots = std::allocator<Slot>().allocate(numCapacity);
+      for (size_t i = 0; i < numCapacity; i++)
+         new (&slots[i].next) std::atomic<uint32_t>(i + 1 < numCapacity ? (uint32_t)(i + 1) : NIL);
+      unused.store(pack(0, 0));
+   }
+
+   /*****************************************
+    * CONCURRENT ARRAY STACK :: DESTRUCTOR
+    * No other thread may be using the stack by now
+    ****************************************/
+   template <class T>
+   concurrent_array_stack<T>::~concurrent_array_stack()
+   {
+      for (uint32_t i = indexOf(full.load()); i != NIL; i = slots[i].next.load())
+         element(i)->~T();
+      if (slots)
+         std::allocator<Slot>().deallocate(slots, numCapacity);
+   }
+
+   /*****************************************
+    * CONCURRENT ARRAY STACK :: TRY EMPLACE
+    * Build an element on top, or return false when full
+    ****************************************/
+   template <class T>
+   template <class ... Args>
+   bool concurrent_array_stack<T>::try_emplace(Args&& ... args)
+   {
+      uint32_t i = popIndex(unused);
+      if (i == NIL)
+         return false;
+
+      try
+      {
+         new (element(i)) T(std::forward<Args>(args)...);
+      }
+      catch (...)
+      {
+         pushIndex(unused, i);
+         throw;
+      }
+
+      pushIndex(full, i);
+      return true;
+   }
+
+   /*****************************************
+    * CONCURRENT ARRAY STACK :: TRY POP
+    * Move the top element into t, or return false when empty
+    ****************************************/
+   template <class T>
+   bool concurrent_array_stack<T>::try_pop(T& t)
+   {
+      uint32_t i = popIndex(full);
+      if (i == NIL)
+         return false;
+
+      t = std::move(*element(i));
+      element(i)->~T();
+      pushIndex(unused, i);
+      return true;
+   }
+
+   /*****************************************
+    * CONCURRENT ARRAY STACK :: POP INDEX
+    * Unlink the top slot of a list.  The next index we read may be
+    * stale if another thread got there first, but then the version
+    * has moved on and the compare-exchange fails.
+    ****************************************/
+   template <class T>
+   uint32_t concurrent_array_stack<T>::popIndex(std::atomic<uint64_t>& head)
+   {
+      uint64_t old = head.load(std::memory_order_acquire);
+      for (;;)
+      {
+         uint32_t i = indexOf(old);
+         if (i == NIL)
+            return NIL;
+         uint32_t next = slots[i].next.load(std::memory_order_relaxed);
+         if (head.compare_exchange_weak(old, pack(next, versionOf(old) + 1),
+                                        std::memory_order_acquire, std::memory_order_acquire))
+            return i;
+      }
+   }
+
+   /*****************************************
+    * CONCURRENT ARRAY STACK :: PUSH INDEX
+    * Link slot i on top of a list, publishing whatever was
+    * written to it
+    ****************************************/
+   template <class T>
+   void concurrent_array_stack<T>::pushIndex(std::atomic<uint64_t>& head, uint32_t i)
+   {
+      uint64_t old = head.load(std::memory_order_relaxed);
+      do
+      {
+         slots[i].next.store(indexOf(old), std::memory_order_relaxed);
+      } while (!head.compare_exchange_weak(old, pack(i, versionOf(old) + 1),
+                                           std::memory_order_release, std::memory_order_relaxed));
+   }
+
+} // custom namespace
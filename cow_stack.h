@@ -0,0 +1,244 @@
+/***********************************************************************
+ * Module:
+ *    COW Stack
+ * Summary:
+ *    A stack whose copies share their elements until they are written
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       cow_stack             : a copy-on-write stack
+ *
+ *    The elements live in a chain of reference-counted segments, the
+ *    newest on top.  A copy shares the top segment and remembers how
+ *    much of it it sees: O(1), whatever the size, and without writing to
+ *    the source, so any number of threads may copy one stack at once, as
+ *    with std::stack.
+ *
+ *    A stack that holds the last reference to its top segment pushes,
+ *    pops and writes top() in place.  Once the segment is shared,
+ *    popping only shrinks this stack's view of it, and the first push
+ *    or write through top() starts a new segment on top of it.
+ *
+ *    So the chain does not grow a segment per copy, a shared run shorter
+ *    than MERGE elements is copied up into the new segment rather than
+ *    stacked on.  That is the only copying: the first write after a copy
+ *    copies at most MERGE - 1 elements (MERGE, writing through top()).
+ *    A chain is released a segment at a time, never recursively, so it
+ *    may be as deep as it likes.
+ *
+ *    Stacks that share segments may live on different threads: a stack
+ *    writes a segment in place only once it holds the last reference.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>   // for std::atomic_thread_fence
+#include <cassert>  // because I am paranoid
+#include <memory>   // for std::shared_ptr
+#include <utility>  // for std::move, std::swap
+#include "vector.h"
+
+class TestCowStack; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /**************************************************
+    * COW STACK
+    * First-in-Last-out data structure whose copies share
+    * every element until one of them writes
+    *************************************************/
+   template<class T>
+   class cow_stack
+   {
+      friend class ::TestCowStack; // give unit tests access to private members
+   public:
+
+      //
+      // Construct
+      //
+
+      cow_stack() : numVisible(0) {}
+      cow_stack(const cow_stack& rhs) : segment(rhs.segment), numVisible(rhs.numVisible) {}
+      cow_stack(cow_stack&& rhs) : segment(std::move(rhs.segment)), numVisible(rhs.numVisible)
+      {
+         rhs.numVisible = 0;
+      }
+      ~cow_stack() {}
+
+      //
+      // Assign
+      //
+
+      cow_stack& operator = (const cow_stack& rhs)
+      {
+         segment = rhs.segment;
+         numVisible = rhs.numVisible;
+         return *this;
+      }
+      cow_stack& operator = (cow_stack&& rhs)
+      {
+         segment = std::move(rhs.segment);
+         numVisible = rhs.numVisible;
+         rhs.numVisible = 0;
+         return *this;
+      }
+      void swap(cow_stack& rhs)
+      {
+         std::swap(segment, rhs.segment);
+         std::swap(numVisible, rhs.numVisible);
+      }
+
+      //
+      // Access
+      //
+
+      // a writable top: when the element is shared, this copies it up
+      // even if the caller only reads it.  To read without copying, use
+      // the const one, as in std::as_const(s).top()
+      T& top()
+      {
+         if (!own())
+         {
+            T t(segment->items[numVisible - 1]);
+            popShared();
+            push(std::move(t));
+         }
+         return segment->items[numVisible - 1];
+      }
+      const T& top() const
+      {
+         return segment->items[numVisible - 1];
+      }
+
+      //
+      // Insert
+      //
+
+      void push(const T& t)
+      {
+         if (!own())
+            unshare();
+         segment->items.push_back(t);
+         numVisible++;
+      }
+      void push(T&& t)
+      {
+         if (!own())
+            unshare();
+         segment->items.push_back(std::move(t));
+         numVisible++;
+      }
+
+      //
+      // Remove
+      //
+
+      void pop()
+      {
+         if (numVisible == 0)
+            return;
+         if (own())
+            segment->items.pop_back();
+         popShared();
+      }
+
+      //
+      // Status
+      //
+
+      size_t size () const { return numVisible + (segment ? segment->numBelow : 0); }
+      bool   empty() const { return size() == 0; }
+
+   private:
+
+      static const size_t MERGE = 32;   // shared runs shorter than this are copied up, not stacked on
+
+      // a run of elements, shared between every stack copied from it
+      struct Segment
+      {
+         Segment(custom::vector<T>&& items, std::shared_ptr<Segment> parent,
+                 size_t numParent, size_t numBelow) :
+            items(std::move(items)), parent(std::move(parent)),
+            numParent(numParent), numBelow(numBelow)
+         {}
+
+         // let go of the chain a link at a time: recursing down a deep
+         // one would overflow the call stack
+         ~Segment()
+         {
+            std::shared_ptr<Segment> p = std::move(parent);
+            while (p && p.use_count() == 1)
+            {
+               std::atomic_thread_fence(std::memory_order_acquire);
+               p = std::move(p->parent);
+            }
+         }
+
+         custom::vector<T>        items;     // the elements of this run
+         std::shared_ptr<Segment> parent;    // the run underneath
+         size_t numParent;                   // how much of parent is visible from here
+         size_t numBelow;                    // total visible elements underneath
+      };
+
+      // nobody else can see the top segment, so it can be written in
+      // place.  Elements an old copy left above our view are dropped.
+      // use_count() is a relaxed load: the fence orders our writes after
+      // whatever a stack on another thread read before letting go of it
+      bool own()
+      {
+         if (!segment || segment.use_count() != 1)
+            return false;
+         std::atomic_thread_fence(std::memory_order_acquire);
+         while (segment->items.size() > numVisible)
+            segment->items.pop_back();
+         return true;
+      }
+
+      // give this stack a top segment of its own to push onto
+      void unshare()
+      {
+         if (segment && numVisible < MERGE)
+         {
+            // a short shared run: copy it up rather than stack on it
+            custom::vector<T> items;
+            items.reserve(numVisible + 1);
+            for (size_t i = 0; i < numVisible; i++)
+               items.push_back(segment->items[i]);
+            segment = std::make_shared<Segment>(std::move(items), segment->parent,
+                                                segment->numParent, segment->numBelow);
+         }
+         else
+         {
+            size_t numBelow = numVisible + (segment ? segment->numBelow : 0);
+            segment = std::make_shared<Segment>(custom::vector<T>(), segment, numVisible, numBelow);
+            numVisible = 0;
+         }
+      }
+
+      // hide the top element, stepping down to the parent when a segment runs out
+      void popShared()
+      {
+         assert(numVisible != 0);
+         numVisible--;
+         while (segment && numVisible == 0)
+         {
+            numVisible = segment->numParent;
+            std::shared_ptr<Segment> parent = segment->parent;
+            segment = std::move(parent);
+         }
+      }
+
+      std::shared_ptr<Segment> segment;   // the top run of elements, possibly shared
+      size_t numVisible;                  // how many of segment->items this stack sees
+   };
+
+} // custom namespace
@@ -0,0 +1,236 @@
+/***********************************************************************
+ * Module:
+ *    File Descriptor I/O
+ * Summary:
+ *    Move raw bytes between memory and a file descriptor, retrying
+ *    until all of it is done
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the definition of:
+ *       fd::segment           : one contiguous run of bytes
+ *       fd::read              : read until full or end of file
+ *       fd::write             : write all of a buffer
+ *       fd::write (segments)  : write many buffers, with writev
+ *       fd::read_at           : read from an offset, like pread
+ *       fd::write_at          : write at an offset, like pwrite
+ *
+ *    read() and write() may do less than they were asked, and the
+ *    kernel caps one call at about 2GB, so each of these loops until
+ *    it is done.  A signal interrupting a call just means try again.
+ *    Anything else throws std::system_error with errno.  On Windows
+ *    these go through _read and _write, without writev.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cerrno>        // for errno, EINTR
+#include <cstddef>       // for size_t
+#include <cstdio>        // for SEEK_SET
+#include <system_error>  // for std::system_error
+
+#ifdef _WIN32
+#include <io.h>          // for _read, _write, _lseeki64
+#else
+#include <sys/uio.h>     // for writev, struct iovec
+#include <unistd.h>      // for read, write, pread, pwrite
+#endif
+
+namespace custom
+{
+   namespace fd
+   {
+
+      /**************************************************
+       * SEGMENT
+       * Some bytes in memory, to be written along with others
+       *************************************************/
+      struct segment
+      {
+         const void* data;
+         size_t      size;
+      };
+
+      // the most one call moves, comfortably under every system's cap
+      const size_t MAX_CALL = (size_t)1 << 30;
+
+      /*****************************************
+       * THROW ERRNO
+       * Report a failed call
+       ****************************************/
+      inline void throwErrno(const char* what)
+      {
+         throw std::system_error(errno, std::generic_category(), what);
+      }
+
+      /*****************************************
+       * READ
+       * Read until numBytes have arrived or the file ends,
+       * returning how many arrived
+       ****************************************/
+      inline size_t read(int fd, void* buffer, size_t numBytes)
+      {
+         char* p = static_cast<char*>(buffer);
+         size_t numRead = 0;
+         while (numRead < numBytes)
+         {
+            size_t numCall = numBytes - numRead < MAX_CALL ? numBytes - numRead : MAX_CALL;
+#ifdef _WIN32
+            int num = ::_read(fd, p + numRead, (unsigned int)numCall);
+#else
+            ssize_t num = ::read(fd, p + numRead, numCall);
+#endif
+            if (num == 0)
+               break;
+            if (num < 0)
+            {
+               if (errno == EINTR)
+                  continue;
+               throwErrno("fd::read");
+            }
+            numRead += (size_t)num;
+         }
+         return numRead;
+      }
+
+      /*****************************************
+       * WRITE
+       * Write all numBytes
+       ****************************************/
+      inline void write(int fd, const void* buffer, size_t numBytes)
+      {
+         const char* p = static_cast<const char*>(buffer);
+         while (numBytes != 0)
+         {
+            size_t numCall = numBytes < MAX_CALL ? numBytes : MAX_CALL;
+#ifdef _WIN32
+            int num = ::_write(fd, p, (unsigned int)numCall);
+#else
+            ssize_t num = ::write(fd, p, numCall);
+#endif
+            if (num < 0)
+            {
+               if (errno == EINTR)
+                  continue;
+               throwErrno("fd::write");
+            }
+            p += num;
+            numBytes -= (size_t)num;
+         }
+      }
+
+      /*****************************************
+       * WRITE SEGMENTS
+       * Write every segment in order, as many at a time as
+       * writev takes, picking up where a short write stopped
+       ****************************************/
+      inline void write(int fd, const segment* first, size_t num)
+      {
+#ifdef _WIN32
+         for (size_t i = 0; i < num; i++)
+            write(fd, first[i].data, first[i].size);
+#else
+         const size_t MAX_IOV = 1024;   // the smallest IOV_MAX POSIX allows
+         struct iovec iov[MAX_IOV];
+         size_t iFirst = 0;             // the first segment not yet written
+         size_t numSkip = 0;            // bytes of it already written
+         while (iFirst < num)
+         {
+            size_t numIov = 0;
+            size_t numBytes = 0;
+            for (size_t i = iFirst; i < num && numIov < MAX_IOV && numBytes < MAX_CALL; i++)
+            {
+               size_t skip = i == iFirst ? numSkip : 0;
+               iov[numIov].iov_base = const_cast<char*>(static_cast<const char*>(first[i].data)) + skip;
+               iov[numIov].iov_len = first[i].size - skip;
+               numBytes += iov[numIov].iov_len;
+               numIov++;
+            }
+
+            ssize_t numWritten = ::writev(fd, iov, (int)numIov);
+            if (numWritten < 0)
+            {
+               if (errno == EINTR)
+                  continue;
+               throwErrno("fd::write");
+            }
+
+            // skip the segments that are done, remembering how far into the next we got
+            size_t numLeft = (size_t)numWritten + numSkip;
+            while (iFirst < num && numLeft >= first[iFirst].size)
+               numLeft -= first[iFirst++].size;
+            numSkip = numLeft;
+         }
+#endif
+      }
+
+      /*****************************************
+       * READ AT
+       * Read until numBytes have arrived from offset, or the file
+       * ends.  Without pread, this seeks first: do not share the fd
+       * with another thread doing I/O at the same time.
+       ****************************************/
+      inline size_t read_at(int fd, void* buffer, size_t numBytes, unsigned long long offset)
+      {
+#ifdef _WIN32
+         if (::_lseeki64(fd, (long long)offset, SEEK_SET) < 0)
+            throwErrno("fd::read_at");
+         return read(fd, buffer, numBytes);
+#else
+         char* p = static_cast<char*>(buffer);
+         size_t numRead = 0;
+         while (numRead < numBytes)
+         {
+            size_t numCall = numBytes - numRead < MAX_CALL ? numBytes - numRead : MAX_CALL;
+            ssize_t num = ::pread(fd, p + numRead, numCall, (off_t)(offset + numRead));
+            if (num == 0)
+               break;
+            if (num < 0)
+            {
+               if (errno == EINTR)
+                  continue;
+               throwErrno("fd::read_at");
+            }
+            numRead += (size_t)num;
+         }
+         return numRead;
+#endif
+      }
+
+      /*****************************************
+       * WRITE AT
+       * Write all numBytes at offset, with the same caveat
+       ****************************************/
+      inline void write_at(int fd, const void* buffer, size_t numBytes, unsigned long long offset)
+      {
+#ifdef _WIN32
+         if (::_lseeki64(fd, (long long)offset, SEEK_SET) < 0)
+            throwErrno("fd::write_at");
+         write(fd, buffer, numBytes);
+#else
+         const char* p = static_cast<const char*>(buffer);
+         size_t numWritten = 0;
+         while (numWritten < numBytes)
+         {
+            size_t numCall = numBytes - numWritten < MAX_CALL ? numBytes - numWritten : MAX_CALL;
+            ssize_t num = ::pwrite(fd, p + numWritten, numCall, (off_t)(offset + numWritten));
+            if (num < 0)
+            {
+               if (errno == EINTR)
+                  continue;
+               throwErrno("fd::write_at");
+            }
+            numWritten += (size_t)num;
+         }
+#endif
+      }
+
+   } // fd namespace
+} // custom namespace
@@ -0,0 +1,342 @@
+/***********************************************************************
+ * Module:
+ *    Frame Stack
+ * Summary:
+ *    A stack of records of different types and sizes packed into
+ *    chunks of raw bytes
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       frame_stack             : a LIFO bump allocator for any record type
+ *       frame_stack::mark_type  : a saved position to unwind back to
+ *
+ *    push<T>() carves a small header and a properly aligned T out of the
+ *    current chunk, moving to the next chunk when it does not fit.  The
+ *    chunks are kept after a pop so a stack that goes up and down again
+ *    does not allocate.  The caller says which type is on top: top<T>()
+ *    and pop<T>() must name the type that was pushed.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>      // because I am paranoid
+#include <cstdint>      // for uintptr_t
+#include <new>          // for placement new, operator new
+#include <type_traits>  // for std::is_trivially_destructible
+#include <utility>      // for std::forward, std::swap
+#include "vector.h"
+
+class TestFrameStack; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /**************************************************
+    * FRAME STACK
+    * Push records of any type, pop them in reverse order
+    *************************************************/
+   class frame_stack
+   {
+      friend class ::TestFrameStack; // give unit tests access to private members
+
+      struct Header;
+
+   public:
+
+      /**************************************************
+       * MARK TYPE
+       * Where the stack was, so unwind() can return there
+       *************************************************/
+      class mark_type
+      {
+         friend class frame_stack;
+         friend class ::TestFrameStack;
+         Header*        last;            // the top record when marked
+         unsigned char* next;            // the free space when marked
+         size_t         iChunk;          // the chunk the free space was in
+         size_t         numRecords;      // how many records there were
+         size_t         numNontrivial;   // how many of them had destructors
+      };
+
+      //
+      // Construct
+      //
+
+      frame_stack(size_t numChunkBytes = 4096) :
+         last(nullptr), next(nullptr), iChunk(0),
+         numRecords(0), numNontrivial(0), numChunkFirst(numChunkBytes) {}
+      frame_stack(const frame_stack& rhs) = delete;
+      frame_stack(frame_stack&& rhs) : frame_stack(rhs.numChunkFirst)
+      {
+         swap(rhs);
+      }
+      ~frame_stack()
+      {
+         clear();
+         for (size_t i = 0; i < chunks.size(); i++)
+            ::operator delete(chunks[i].data);
+      }
+
+      //
+      // Assign
+      //
+      frame_stack& operator = (const frame_stack& rhs) = delete;
+      frame_stack& operator = (frame_stack&& rhs)
+      {
+         clear();
+         swap(rhs);
+         return *this;
+      }
+      void swap(frame_stack& rhs)
+      {
+         chunks.swap(rhs.chunks);
+         std::swap(last, rhs.last);
+         std::swap(next, rhs.next);
+         std::swap(iChunk, rhs.iChunk);
+         std::swap(numRecords, rhs.numRecords);
+         std::swap(numNontrivial, rhs.numNontrivial);
+         std::swap(numChunkFirst, rhs.numChunkFirst);
+      }
+
+      //
+      // Access
+      //
+
+      template <class T>
+      T& top()
+      {
+         assert(last != nullptr);
+         assert(last->destroy == destroyerOf<T>());
+         return *static_cast<T*>(last->object);
+      }
+      template <class T>
+      const T& top() const
+      {
+         assert(last != nullptr);
+         assert(last->destroy == destroyerOf<T>());
+         return *static_cast<const T*>(last->object);
+      }
+
+      //
+      // Insert
+      //
+
+      template <class T, class ... Args>
+      T& push(Args&& ... args);
+
+      //
+      // Remove
+      //
+
+      template <class T>
+      void pop()
+      {
+         assert(last != nullptr);
+         assert(last->destroy == destroyerOf<T>());
+         static_cast<T*>(last->object)->~T();
+         release();
+      }
+      void pop()
+      {
+         assert(last != nullptr);
+         if (last->destroy)
+            last->destroy(last->object);
+         release();
+      }
+      mark_type mark() const
+      {
+         mark_type m;
+         m.last = last;
+         m.next = next;
+         m.iChunk = iChunk;
+         m.numRecords = numRecords;
+         m.numNontrivial = numNontrivial;
+         return m;
+      }
+      void unwind(const mark_type& m);
+      void clear()
+      {
+         mark_type m;
+         m.last = nullptr;
+         m.next = nullptr;
+         m.iChunk = 0;
+         m.numRecords = 0;
+         m.numNontrivial = 0;
+         unwind(m);
+      }
+
+      //
+      // Status
+      //
+
+      size_t size () const { return numRecords;      }
+      bool   empty() const { return numRecords == 0; }
+      size_t capacity_bytes() const
+      {
+         size_t num = 0;
+         for (size_t i = 0; i < chunks.size(); i++)
+            num += chunks[i].size;
+         return num;
+      }
+
+   private:
+
+      // in front of every record
+      struct Header
+      {
+         Header*        prev;           // the record underneath
+         unsigned char* oldNext;        // the free space before this push
+         size_t         iChunk;         // the chunk the free space was in
+         void*          object;         // the record itself
+         void (*destroy)(void*);        // nullptr when the destructor is trivial
+      };
+
+      struct Chunk
+      {
+         unsigned char* data;
+         size_t         size;
+      };
+
+      // one destroy function per type, none for trivial destructors
+      template <class T>
+      static void destroyAs(void* p)
+      {
+         static_cast<T*>(p)->~T();
+      }
+      template <class T>
+      static constexpr void (*destroyerOf())(void*)
+      {
+         return std::is_trivially_destructible<T>::value ? nullptr : &destroyAs<T>;
+      }
+
+      static unsigned char* alignUp(unsigned char* p, size_t align)
+      {
+         return reinterpret_cast<unsigned char*>(
+            (reinterpret_cast<uintptr_t>(p) + align - 1) & ~(uintptr_t)(align - 1));
+      }
+
+      // where a header and a record of this size and alignment go, or nullptr
+      static unsigned char* fit(unsigned char* p, const Chunk& chunk, size_t size, size_t align)
+      {
+         unsigned char* header = alignUp(p, alignof(Header));
+         unsigned char* object = alignUp(header + sizeof(Header), align);
+         if (object + size > chunk.data + chunk.size)
+            return nullptr;
+         return header;
+      }
+
+      // make the next chunk big enough for this record
+      void nextChunk(size_t size, size_t align);
+
+      // forget the top record; its destructor has already run
+      void release()
+      {
+         next = last->oldNext;
+         iChunk = last->iChunk;
+         if (last->destroy)
+            numNontrivial--;
+         last = last->prev;
+         numRecords--;
+      }
+
+      custom::vector<Chunk> chunks;   // every chunk, kept for reuse
+      Header*        last;            // the top record
+      unsigned char* next;            // the next free byte in chunks[iChunk], nullptr before the first
+      size_t         iChunk;          // the chunk we are filling
+      size_t         numRecords;      // records on the stack
+      size_t         numNontrivial;   // records with a destructor to run
+      size_t         numChunkFirst;   // size of the first chunk
+   };
+
+   /*****************************************
+    * FRAME STACK :: PUSH
+    * Construct a T from args at the top of the stack
+    ****************************************/
+   template <class T, class ... Args>
+   T& frame_stack::push(Args&& ... args)
+   {
+      unsigned char* header = next == nullptr ? nullptr
+                            : fit(next, chunks[iChunk], sizeof(T), alignof(T));
+      unsigned char* oldNext = next;
+      size_t oldChunk = iChunk;
+      if (header == nullptr)
+      {
+         nextChunk(sizeof(T), alignof(T));
+         header = fit(next, chunks[iChunk], sizeof(T), alignof(T));
+      }
+
+      unsigned char* object = alignUp(header + sizeof(Header), alignof(T));
+      T* t = new (object) T(std::forward<Args>(args)...);
+
+      last = new (header) Header{last, oldNext, oldChunk, object, destroyerOf<T>()};
+      next = object + sizeof(T);
+      numRecords++;
+      if (last->destroy)
+         numNontrivial++;
+      return *t;
+   }
+
+   /*****************************************
+    * FRAME STACK :: NEXT CHUNK
+    * Move to the chunk after this one, replacing it with a
+    * bigger one when the record will not fit
+    ****************************************/
+   inline void frame_stack::nextChunk(size_t size, size_t align)
+   {
+      size_t iNext = next == nullptr ? 0 : iChunk + 1;
+      size_t numNeeded = sizeof(Header) + alignof(Header) + size + align;
+
+      if (iNext < chunks.size() && fit(chunks[iNext].data, chunks[iNext], size, align) == nullptr)
+      {
+         // too small to be useful: drop it and everything after it
+         for (size_t i = iNext; i < chunks.size(); i++)
+            ::operator delete(chunks[i].data);
+         chunks.truncate(iNext);
+      }
+      if (iNext == chunks.size())
+      {
+         size_t numBytes = chunks.empty() ? numChunkFirst : chunks.back().size * 2;
+         if (numBytes == 0)         // frame_stack(0): doubling 0 never fits
+            numBytes = numNeeded;
+         while (numBytes < numNeeded)
+            numBytes *= 2;
+         Chunk chunk;
+         chunk.data = static_cast<unsigned char*>(::operator new(numBytes));
+         chunk.size = numBytes;
+         chunks.push_back(chunk);
+      }
+
+      iChunk = iNext;
+      next = chunks[iChunk].data;
+   }
+
+   /*****************************************
+    * FRAME STACK :: UNWIND
+    * Pop everything pushed since the mark.  When none of
+    * those records has a destructor this is O(1).
+    ****************************************/
+   inline void frame_stack::unwind(const mark_type& m)
+   {
+      assert(m.numRecords <= numRecords);
+      if (numNontrivial == m.numNontrivial)
+      {
+         // nothing to destroy: jump straight back
+         last = m.last;
+         next = m.next;
+         iChunk = m.iChunk;
+         numRecords = m.numRecords;
+      }
+      while (numRecords > m.numRecords)
+         pop();
+      assert(last == m.last);
+   }
+
+} // custom namespace
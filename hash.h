@@ -0,0 +1,673 @@
+/***********************************************************************
+ * Header:
+ *    HASH
+ * Summary:
+ *    Our custom implementation of std::unordered_set and
+ *    std::unordered_map as an open-addressing table
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *        hash_table               : the open-addressing table itself
+ *        hash_table::iterator     : an iterator through the table
+ *        unordered_set            : similar to std::unordered_set
+ *        unordered_map            : similar to std::unordered_map
+ *        string_hash              : a transparent hash for strings
+ *
+ *    Every bucket has a one-byte control: EMPTY, or the low seven bits
+ *    of the element's hash.  A lookup compares sixteen control bytes at
+ *    once against those seven bits and only looks at the elements that
+ *    match.  Probing is linear one bucket at a time, so erase can shift
+ *    the rest of the run back into the hole and no tombstones are left.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>     // because I am paranoid
+#include <cstdint>     // for int8_t
+#include <cstring>     // for std::memset
+#include <functional>  // for std::hash, std::equal_to
+#include <new>         // for placement new, std::launder
+#include <stdexcept>   // for std::out_of_range
+#include <string>      // for std::string
+#include <string_view> // for std::string_view
+#include <tuple>       // for std::forward_as_tuple
+#include <type_traits> // for std::is_trivially_destructible
+#include <utility>     // for std::pair, std::move
+#include "vector.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h> // for _mm_cmpeq_epi8, _mm_movemask_epi8
+#define CUSTOM_HASH_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>    // for _BitScanForward
+#endif
+
+class TestHash;        // forward declaration for unit tests
+
+namespace custom
+{
+
+   /*****************************************
+    * COUNT TRAILING ZEROS
+    * The index of the lowest set bit of a non-zero mask
+    ****************************************/
+   inline size_t countTrailingZeros(uint32_t bits)
+   {
+      assert(bits != 0);
+#if defined(__GNUC__) || defined(__clang__)
+      return (size_t)__builtin_ctz(bits);
+#elif defined(_MSC_VER)
+      unsigned long n;
+      _BitScanForward(&n, bits);
+      return (size_t)n;
+#else
+      size_t n = 0;
+      for (; !(bits & 1u); bits >>= 1)
+         n++;
+      return n;
+#endif
+   }
+
+   /*****************************************
+    * STRING HASH
+    * A transparent hash so a table keyed on std::string
+    * can be searched with a const char * or a string_view
+    * without building a temporary std::string
+    ****************************************/
+   struct string_hash
+   {
+      using is_transparent = void;
+      size_t operator () (std::string_view s) const
+      {
+         return std::hash<std::string_view>()(s);
+      }
+   };
+
+   /*****************************************
+    * HASH TABLE
+    * The open-addressing table behind unordered_set and
+    * unordered_map.  KeyOf pulls the key out of a Value.
+    ****************************************/
+   template <class Value, class Key, class KeyOf, class Hash, class KeyEqual>
+   class hash_table
+   {
+      friend class ::TestHash;
+   public:
+
+      //
+      // Construct
+      //
+      hash_table(size_t numBuckets = 0, const Hash& h = Hash(), const KeyEqual& e = KeyEqual())
+         : controls(), slots(), numElements(0), hasher(h), equal(e)
+      {
+         if (numBuckets)
+            rehash(numBuckets);
+      }
+      hash_table(const hash_table& rhs);
+      hash_table(hash_table&& rhs)
+         : controls(std::move(rhs.controls)), slots(std::move(rhs.slots)),
+           numElements(rhs.numElements), hasher(rhs.hasher), equal(rhs.equal)
+      {
+         rhs.numElements = 0;
+      }
+      ~hash_table()
+      {
+         destroyAll();
+      }
+
+      //
+      // Assign
+      //
+      hash_table& operator = (const hash_table& rhs)
+      {
+         hash_table temp(rhs);
+         swap(temp);
+         return *this;
+      }
+      hash_table& operator = (hash_table&& rhs)
+      {
+         clear();
+         swap(rhs);
+         return *this;
+      }
+      void swap(hash_table& rhs)
+      {
+         controls.swap(rhs.controls);
+         slots.swap(rhs.slots);
+         std::swap(numElements, rhs.numElements);
+         std::swap(hasher, rhs.hasher);
+         std::swap(equal, rhs.equal);
+      }
+
+      //
+      // Iterator
+      //
+      class iterator;
+      iterator begin()
+      {
+         return iterator(controlData(), slotData(), bucket_count(), 0);
+      }
+      iterator end()
+      {
+         return iterator(controlData(), slotData(), bucket_count(), bucket_count());
+      }
+
+      //
+      // Access
+      //
+      iterator find(const Key& key)
+      {
+         return iteratorAt(findIndex(key));
+      }
+      template <class K, class H = Hash, class E = KeyEqual,
+                class = typename H::is_transparent, class = typename E::is_transparent>
+      iterator find(const K& key)
+      {
+         return iteratorAt(findIndex(key));
+      }
+      bool contains(const Key& key) const
+      {
+         return findIndex(key) != npos;
+      }
+      template <class K, class H = Hash, class E = KeyEqual,
+                class = typename H::is_transparent, class = typename E::is_transparent>
+      bool contains(const K& key) const
+      {
+         return findIndex(key) != npos;
+      }
+      size_t count(const Key& key) const
+      {
+         return contains(key) ? 1 : 0;
+      }
+
+      //
+      // Insert
+      //
+      std::pair<iterator, bool> insert(const Value& t)
+      {
+         return emplaceKey(KeyOf()(t), t);
+      }
+      std::pair<iterator, bool> insert(Value&& t)
+      {
+         return emplaceKey(KeyOf()(t), std::move(t));
+      }
+      template <class ... Args>
+      std::pair<iterator, bool> emplace(Args&& ... args)
+      {
+         Value t(std::forward<Args>(args)...);
+         return emplaceKey(KeyOf()(t), std::move(t));
+      }
+      void reserve(size_t num);
+      void rehash(size_t numBuckets);
+
+      //
+      // Remove
+      //
+      size_t erase(const Key& key)
+      {
+         return eraseIndex(findIndex(key));
+      }
+      template <class K, class H = Hash, class E = KeyEqual,
+                class = typename H::is_transparent, class = typename E::is_transparent>
+      size_t erase(const K& key)
+      {
+         return eraseIndex(findIndex(key));
+      }
+      void erase(iterator it)
+      {
+         eraseIndex(it.index);
+      }
+      void clear()
+      {
+         destroyAll();
+         if (!controls.empty())
+            std::memset(controlData(), EMPTY, controls.size());
+         numElements = 0;
+      }
+
+      //
+      // Status
+      //
+      size_t size()            const { return numElements;      }
+      bool   empty()           const { return numElements == 0; }
+      size_t bucket_count()    const { return slots.size();     }
+      float  load_factor()     const { return bucket_count() ? (float)size() / (float)bucket_count() : 0.0f; }
+      float  max_load_factor() const { return (float)LOAD_NUM / (float)LOAD_DEN; }
+
+   protected:
+
+      static const size_t npos = (size_t)-1;
+
+      // make the index or (when not found) end()
+      iterator iteratorAt(size_t index)
+      {
+         return iterator(controlData(), slotData(), bucket_count(),
+                         index == npos ? bucket_count() : index);
+      }
+
+      // construct a value from args if key is not already there
+      template <class K, class ... Args>
+      std::pair<iterator, bool> emplaceKey(const K& key, Args&& ... args);
+
+      // find the index of the key or npos
+      template <class K>
+      size_t findIndex(const K& key) const
+      {
+         return numElements ? findIndex(key, mix(hasher(key))) : npos;
+      }
+      template <class K>
+      size_t findIndex(const K& key, size_t h) const;
+
+
+      Value& valueAt(size_t index) { return *slots[index].get(); }
+
+   private:
+
+      static const int8_t EMPTY = -128;   // 0x80: any full control is 0..127
+      static const size_t GROUP = 16;     // control bytes compared at once
+      static const size_t MIN_BUCKETS = GROUP;
+      static const size_t LOAD_NUM = 4;   // grow when more than 4/5 full
+      static const size_t LOAD_DEN = 5;
+
+      // raw, uninitialized room for one Value
+      struct Slot
+      {
+         alignas(Value) unsigned char bytes[sizeof(Value)];
+         Value* get() { return std::launder(reinterpret_cast<Value*>(bytes)); }
+         const Value* get() const { return std::launder(reinterpret_cast<const Value*>(bytes)); }
+      };
+
+      // spread the bits of a weak hash such as std::hash<int> around
+      static size_t mix(size_t h)
+      {
+         h *= (size_t)0x9E3779B97F4A7C15ull;
+         return h ^ (h >> (sizeof(size_t) * 4));
+      }
+      size_t hashOf(const Value& t) const { return mix(hasher(KeyOf()(t))); }
+      size_t home(size_t h) const { return (h >> 7) & (bucket_count() - 1); }
+      static int8_t fragment(size_t h) { return (int8_t)(h & 0x7F); }
+
+      // bit i is set when the control at index + i matches
+      uint32_t match(size_t index, int8_t c) const;
+
+      int8_t* controlData() { return controls.empty() ? nullptr : &controls[0]; }
+      Slot*   slotData()    { return slots.empty()    ? nullptr : &slots[0];    }
+
+      // set the control, and its mirror past the end if it is in the first group
+      void setControl(size_t index, int8_t c)
+      {
+         controls[index] = c;
+         if (index < GROUP)
+            controls[bucket_count() + index] = c;
+      }
+
+      size_t firstEmpty(size_t h) const;
+      size_t eraseIndex(size_t index);
+      void   destroyAll();
+
+      custom::vector<int8_t> controls;  // one per bucket, plus a mirror of the first GROUP
+      custom::vector<Slot>   slots;     // the elements themselves
+      size_t   numElements;             // the number of full buckets
+      Hash     hasher;
+      KeyEqual equal;
+   };
+
+   /**************************************************
+    * HASH TABLE ITERATOR
+    * Walk the buckets, skipping the empty ones
+    *************************************************/
+   template <class Value, class Key, class KeyOf, class Hash, class KeyEqual>
+   class hash_table <Value, Key, KeyOf, Hash, KeyEqual> ::iterator
+   {
+      friend class ::TestHash;
+      friend class hash_table;
+   public:
+      iterator() : controls(nullptr), slots(nullptr), numBuckets(0), index(0) {}
+      iterator(const int8_t* controls, Slot* slots, size_t numBuckets, size_t index)
+         : controls(controls), slots(slots), numBuckets(numBuckets), index(index)
+      {
+         skipEmpty();
+      }
+
+      bool operator == (const iterator& rhs) const { return index == rhs.index; }
+      bool operator != (const iterator& rhs) const { return index != rhs.index; }
+
+      Value& operator * ()  { return *slots[index].get(); }
+      Value* operator -> () { return slots[index].get();  }
+
+      iterator& operator ++ ()
+      {
+         index++;
+         skipEmpty();
+         return *this;
+      }
+      iterator operator ++ (int postfix)
+      {
+         iterator temp(*this);
+         ++*this;
+         return temp;
+      }
+
+   private:
+      void skipEmpty()
+      {
+         while (index < numBuckets && controls[index] == EMPTY)
+            index++;
+      }
+
+      const int8_t* controls;
+      Slot*  slots;
+      size_t numBuckets;
+      size_t index;
+   };
+
+   /*****************************************
+    * HASH TABLE :: COPY CONSTRUCTOR
+    * Same bucket layout, copy-construct each element.  If
+    * a copy throws, destroy the ones already built; the
+    * control and slot vectors free themselves as we unwind
+    ****************************************/
+   template <class Value, class Key, class KeyOf, class Hash, class KeyEqual>
+   hash_table <Value, Key, KeyOf, Hash, KeyEqual> ::hash_table(const hash_table& rhs)
+      : controls(rhs.controls), slots(rhs.slots.size()), numElements(0),
+        hasher(rhs.hasher), equal(rhs.equal)
+   {
+      size_t i = 0;
+      try
+      {
+         for (; i < bucket_count(); i++)
+            if (controls[i] != EMPTY)
+            {
+               new (slots[i].bytes) Value(*rhs.slots[i].get());
+               numElements++;
+            }
+      }
+      catch (...)
+      {
+         while (i-- > 0)
+            if (controls[i] != EMPTY)
+               slots[i].get()->~Value();
+         throw;
+      }
+   }
+
+   /*****************************************
+    * HASH TABLE :: MATCH
+    * Compare the GROUP control bytes starting at index
+    * with c.  The mirror past the end means the group never
+    * has to wrap around.
+    ****************************************/
+   template <class Value, class Key, class KeyOf, class Hash, class KeyEqual>
+   uint32_t hash_table <Value, Key, KeyOf, Hash, KeyEqual> ::match(size_t index, int8_t c) const
+   {
+#ifdef CUSTOM_HASH_SSE2
+      __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&controls[index]));
+      return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(c)));
+#else
+      uint32_t bits = 0;
+      for (size_t i = 0; i < GROUP; i++)
+         bits |= (uint32_t)(controls[index + i] == c) << i;
+      return bits;
+#endif
+   }
+
+   /*****************************************
+    * HASH TABLE :: FIND INDEX
+    * Starting at the key's home, look at one group of
+    * controls at a time.  Only buckets whose seven hash
+    * bits match get a real key comparison, and the search
+    * stops at the first empty bucket.
+    ****************************************/
+   template <class Value, class Key, class KeyOf, class Hash, class KeyEqual>
+   template <class K>
+   size_t hash_table <Value, Key, KeyOf, Hash, KeyEqual> ::findIndex(const K& key, size_t h) const
+   {
+      if (numElements == 0)
+         return npos;
+
+      size_t mask = bucket_count() - 1;
+      for (size_t index = home(h); ; index = (index + GROUP) & mask)
+      {
+         uint32_t empties = match(index, EMPTY);
+         uint32_t candidates = match(index, fragment(h));
+
+         // nothing past the first empty bucket belongs to this run
+         if (empties)
+            candidates &= (empties & (0u - empties)) - 1;
+
+         for (; candidates; candidates &= candidates - 1)
+         {
+            size_t i = (index + countTrailingZeros(candidates)) & mask;
+            if (equal(KeyOf()(*slots[i].get()), key))
+               return i;
+         }
+         if (empties)
+            return npos;
+      }
+   }
+
+   /*****************************************
+    * HASH TABLE :: FIRST EMPTY
+    * The first empty bucket at or after the home of h
+    ****************************************/
+   template <class Value, class Key, class KeyOf, class Hash, class KeyEqual>
+   size_t hash_table <Value, Key, KeyOf, Hash, KeyEqual> ::firstEmpty(size_t h) const
+   {
+      size_t mask = bucket_count() - 1;
+      for (size_t index = home(h); ; index = (index + GROUP) & mask)
+      {
+         uint32_t empties = match(index, EMPTY);
+         if (empties)
+            return (index + countTrailingZeros(empties)) & mask;
+      }
+   }
+
+   /*****************************************
+    * HASH TABLE :: EMPLACE KEY
+    * Unless the key is already in the table, build the
+    * value in the first empty bucket of its run.  The key
+    * is hashed once, and args are not touched until the
+    * bucket is chosen (try_emplace moves the key in).
+    ****************************************/
+   template <class Value, class Key, class KeyOf, class Hash, class KeyEqual>
+   template <class K, class ... Args>
+   std::pair<typename hash_table <Value, Key, KeyOf, Hash, KeyEqual> ::iterator, bool>
+      hash_table <Value, Key, KeyOf, Hash, KeyEqual> ::emplaceKey(const K& key, Args&& ... args)
+   {
+      size_t h = mix(hasher(key));
+      size_t index = findIndex(key, h);
+      if (index != npos)
+         return std::pair<iterator, bool>(iteratorAt(index), false);
+
+      if ((numElements + 1) * LOAD_DEN > bucket_count() * LOAD_NUM)
+         reserve(numElements + 1);
+
+      index = firstEmpty(h);
+      new (slots[index].bytes) Value(std::forward<Args>(args)...);
+      setControl(index, fragment(h));
+      numElements++;
+      return std::pair<iterator, bool>(iteratorAt(index), true);
+   }
+
+   /*****************************************
+    * HASH TABLE :: ERASE INDEX
+    * Remove the element, then walk the rest of the run.
+    * Anything whose home is at or before the hole moves
+    * back into it, so every run stays unbroken and no
+    * tombstone is needed.
+    ****************************************/
+   template <class Value, class Key, class KeyOf, class Hash, class KeyEqual>
+   size_t hash_table <Value, Key, KeyOf, Hash, KeyEqual> ::eraseIndex(size_t index)
+   {
+      if (index == npos || index >= bucket_count() || controls[index] == EMPTY)
+         return 0;
+
+      size_t mask = bucket_count() - 1;
+      slots[index].get()->~Value();
+      for (size_t next = (index + 1) & mask; controls[next] != EMPTY; next = (next + 1) & mask)
+      {
+         size_t h = hashOf(*slots[next].get());
+         if (((next - home(h)) & mask) >= ((next - index) & mask))
+         {
+            new (slots[index].bytes) Value(std::move(*slots[next].get()));
+            slots[next].get()->~Value();
+            setControl(index, controls[next]);
+            index = next;
+         }
+      }
+      setControl(index, EMPTY);
+      numElements--;
+      return 1;
+   }
+
+   /*****************************************
+    * HASH TABLE :: RESERVE
+    * Make room for num elements without growing
+    ****************************************/
+   template <class Value, class Key, class KeyOf, class Hash, class KeyEqual>
+   void hash_table <Value, Key, KeyOf, Hash, KeyEqual> ::reserve(size_t num)
+   {
+      rehash((num * LOAD_DEN + LOAD_NUM - 1) / LOAD_NUM);
+   }
+
+   /*****************************************
+    * HASH TABLE :: REHASH
+    * Move to at least numBuckets buckets (a power of two,
+    * never fewer than the current elements need)
+    ****************************************/
+   template <class Value, class Key, class KeyOf, class Hash, class KeyEqual>
+   void hash_table <Value, Key, KeyOf, Hash, KeyEqual> ::rehash(size_t numBuckets)
+   {
+      size_t numNeeded = (numElements * LOAD_DEN + LOAD_NUM - 1) / LOAD_NUM + 1;
+      if (numBuckets < numNeeded)
+         numBuckets = numNeeded;
+      size_t numNew = MIN_BUCKETS;
+      while (numNew < numBuckets)
+         numNew *= 2;
+      if (numNew == bucket_count())
+         return;
+
+      hash_table rhs(0, hasher, equal);
+      rhs.controls.resize(numNew + GROUP);
+      std::memset(rhs.controlData(), EMPTY, rhs.controls.size());
+      rhs.slots.resize(numNew);
+
+      for (size_t i = 0; i < bucket_count(); i++)
+         if (controls[i] != EMPTY)
+         {
+            size_t h = hashOf(*slots[i].get());
+            size_t index = rhs.firstEmpty(h);
+            new (rhs.slots[index].bytes) Value(std::move(*slots[i].get()));
+            rhs.setControl(index, fragment(h));
+            rhs.numElements++;
+         }
+      swap(rhs);
+   }
+
+   /*****************************************
+    * HASH TABLE :: DESTROY ALL
+    * Call the destructor on every element
+    ****************************************/
+   template <class Value, class Key, class KeyOf, class Hash, class KeyEqual>
+   void hash_table <Value, Key, KeyOf, Hash, KeyEqual> ::destroyAll()
+   {
+      if constexpr (!std::is_trivially_destructible<Value>::value)
+         for (size_t i = 0; i < bucket_count(); i++)
+            if (controls[i] != EMPTY)
+               slots[i].get()->~Value();
+   }
+
+   /*****************************************
+    * KEY OF
+    * How the set and the map find the key of a value
+    ****************************************/
+   struct key_of_self
+   {
+      template <class T>
+      const T& operator () (const T& t) const { return t; }
+   };
+   struct key_of_first
+   {
+      template <class Pair>
+      const typename Pair::first_type& operator () (const Pair& p) const { return p.first; }
+   };
+
+   /*****************************************
+    * UNORDERED SET
+    * Just like std::unordered_set
+    ****************************************/
+   template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>>
+   class unordered_set : public hash_table<T, T, key_of_self, Hash, KeyEqual>
+   {
+   public:
+      using hash_table<T, T, key_of_self, Hash, KeyEqual>::hash_table;
+      unordered_set() {}
+      unordered_set(const std::initializer_list<T>& l)
+      {
+         this->reserve(l.size());
+         for (auto& t : l)
+            this->insert(t);
+      }
+   };
+
+   /*****************************************
+    * UNORDERED MAP
+    * Just like std::unordered_map, except the element is a
+    * std::pair<K, V> so it can be moved when the table grows.
+    * Changing the key through an iterator corrupts the table.
+    ****************************************/
+   template <class K, class V, class Hash = std::hash<K>, class KeyEqual = std::equal_to<K>>
+   class unordered_map : public hash_table<std::pair<K, V>, K, key_of_first, Hash, KeyEqual>
+   {
+      using table = hash_table<std::pair<K, V>, K, key_of_first, Hash, KeyEqual>;
+   public:
+      using table::hash_table;
+      unordered_map() {}
+      unordered_map(const std::initializer_list<std::pair<K, V>>& l)
+      {
+         this->reserve(l.size());
+         for (auto& t : l)
+            this->insert(t);
+      }
+
+      //
+      // Access
+      //
+      V& operator [] (const K& key)
+      {
+         return try_emplace(key).first->second;
+      }
+      V& operator [] (K&& key)
+      {
+         return try_emplace(std::move(key)).first->second;
+      }
+      V& at(const K& key)
+      {
+         size_t index = this->findIndex(key);
+         if (index == table::npos)
+            throw std::out_of_range("unordered_map::at");
+         return this->valueAt(index).second;
+      }
+
+      //
+      // Insert
+      //
+      template <class Key, class ... Args>
+      std::pair<typename table::iterator, bool> try_emplace(Key&& key, Args&& ... args)
+      {
+         return this->emplaceKey(key, std::piecewise_construct,
+                                 std::forward_as_tuple(std::forward<Key>(key)),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+      }
+   };
+
+} // namespace custom
@@ -0,0 +1,131 @@
+/***********************************************************************
+ * Module:
+ *    Hinted Stack
+ * Summary:
+ *    A stack that reserves what a sizing_hint suggests and, when it
+ *    goes away, tells the hint the most it ever held
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       hinted_stack          : a stack that reports its high-water
+ *                               mark to a sizing_hint
+ *
+ *    A stack that is not hinted pays nothing for this: custom::stack
+ *    only has a constructor that reserves hint.suggested(), and the
+ *    bookkeeping lives in this adapter around it.  The most held only
+ *    changes just before a pop, so push does no extra work.
+ *
+ *    Like a lock guard, a hinted_stack belongs to the scope that made
+ *    it: it can be neither copied nor moved, so each one records
+ *    exactly once.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>      // for size_t
+#include <utility>      // for std::move
+#include "sizing_hint.h"
+#include "stack.h"
+
+class TestHintedStack; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /**************************************************
+    * HINTED STACK
+    * First-in-Last-out, sized from the stacks made
+    * before it at the same place
+    *************************************************/
+   template <class T, class Container = custom::vector<T>>
+   class hinted_stack
+   {
+      friend class ::TestHintedStack; // give unit tests access to private members
+   public:
+
+      //
+      // Construct
+      //
+
+      explicit hinted_stack(sizing_hint& hint) :
+         items(hint),
+         hint(hint),
+         highWater(0)
+      {}
+      hinted_stack(const hinted_stack&) = delete;
+      hinted_stack& operator = (const hinted_stack&) = delete;
+      ~hinted_stack()
+      {
+         hint.record(highWater > items.size() ? highWater : items.size());
+      }
+
+      //
+      // Access
+      //
+
+      T& top()             { return items.top(); }
+      const T& top() const { return items.top(); }
+
+      //
+      // Insert
+      //
+
+      void push(const T& t)
+      {
+         items.push(t);
+      }
+      void push(T&& t)
+      {
+         items.push(std::move(t));
+      }
+
+      //
+      // Remove
+      //
+
+      void pop()
+      {
+         noteHighWater();
+         items.pop();
+      }
+      void pop_n(size_t num)
+      {
+         noteHighWater();
+         items.pop_n(num);
+      }
+      void pop_to(size_t newSize)
+      {
+         noteHighWater();
+         items.pop_to(newSize);
+      }
+
+      //
+      // Status
+      //
+
+      size_t size()  const { return items.size();  }
+      bool   empty() const { return items.empty(); }
+
+   private:
+
+      // about to shrink: remember how big we got
+      void noteHighWater()
+      {
+         if (items.size() > highWater)
+            highWater = items.size();
+      }
+
+      custom::stack<T, Container> items;
+      sizing_hint& hint;       // told how big we got
+      size_t       highWater;  // the most held before the last pop
+   };
+
+} // custom namespace
@@ -0,0 +1,208 @@
+/***********************************************************************
+ * Module:
+ *    Packed Stack
+ * Summary:
+ *    A stack of small unsigned values, Bits bits each, packed
+ *    end to end into 64-bit words
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       packed_stack<Bits>    : values of Bits bits, with no padding
+ *       bit_stack             : packed_stack<1>, a stack of bools
+ *
+ *    Element i lives at bit i * Bits, so a value may straddle two
+ *    words.  Bits above the top are never read, so pushing just writes
+ *    over whatever is there and popping only moves the count.
+ *
+ *    push_many and pop_many move as many values as fit in one word at
+ *    once, the first pushed in the low bits.  A solver can push a
+ *    whole word of decisions in one call.
+ *
+ *    top() returns the value, not a reference: there is nothing to
+ *    refer to.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>      // because I am paranoid
+#include <cstdint>      // for uint64_t
+#include <type_traits>  // for std::conditional
+#include "vector.h"
+
+class TestPackedStack; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /**************************************************
+    * PACKED STACK
+    * First-in-Last-out, Bits bits an element
+    *************************************************/
+   template <unsigned int Bits>
+   class packed_stack
+   {
+      friend class ::TestPackedStack; // give unit tests access to private members
+
+      static_assert(Bits >= 1 && Bits <= 64, "packed_stack holds 1 to 64 bits an element");
+
+   public:
+
+      // the smallest type that holds a value
+      using value_type =
+         typename std::conditional<Bits == 1,  bool,
+         typename std::conditional<Bits <= 8,  uint8_t,
+         typename std::conditional<Bits <= 16, uint16_t,
+         typename std::conditional<Bits <= 32, uint32_t,
+                                               uint64_t>::type>::type>::type>::type;
+
+      // how many values push_many and pop_many move at most
+      static const size_t PER_WORD = 64 / Bits;
+
+      //
+      // Construct
+      //
+
+      packed_stack() : numElements(0) {}
+
+      //
+      // Access
+      //
+
+      value_type top() const
+      {
+         assert(numElements != 0);
+         return (value_type)readBits((numElements - 1) * Bits, Bits);
+      }
+
+      //
+      // Insert
+      //
+
+      void push(value_type t)
+      {
+         writeBits(numElements * Bits, Bits, (uint64_t)t);
+         numElements++;
+      }
+
+      // push num values at once, the first in the low Bits bits
+      void push_many(uint64_t values, size_t num)
+      {
+         assert(num <= PER_WORD);
+         if (num == 0)
+            return;
+         writeBits(numElements * Bits, num * Bits, values);
+         numElements += num;
+      }
+
+      void reserve(size_t num)
+      {
+         words.reserve(wordsFor(num));
+      }
+
+      //
+      // Remove
+      //
+
+      void pop()
+      {
+         assert(numElements != 0);
+         numElements--;
+         shrink();
+      }
+
+      // pop the top num values, handing them back the way push_many takes them
+      uint64_t pop_many(size_t num)
+      {
+         assert(num <= PER_WORD && num <= numElements);
+         if (num == 0)
+            return 0;
+         numElements -= num;
+         uint64_t values = readBits(numElements * Bits, num * Bits);
+         shrink();
+         return values;
+      }
+
+      void clear()
+      {
+         words.clear();
+         numElements = 0;
+      }
+
+      //
+      // Status
+      //
+
+      size_t size()  const { return numElements;      }
+      bool   empty() const { return numElements == 0; }
+      size_t memory_bytes() const { return words.capacity() * sizeof(uint64_t); }
+
+   private:
+
+      // one value never straddles words, though many at a time may
+      static const bool ALIGNED = 64 % Bits == 0;
+
+      static size_t wordsFor(size_t num)
+      {
+         return (num * Bits + 63) / 64;
+      }
+
+      static uint64_t lowBits(size_t num)
+      {
+         return num >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << num) - 1;
+      }
+
+      // the numBits bits starting at bit, which may span two words
+      uint64_t readBits(size_t bit, size_t numBits) const
+      {
+         size_t iWord = bit / 64;
+         size_t offset = bit % 64;
+         uint64_t value = words[iWord] >> offset;
+         if (!(ALIGNED && numBits == Bits) && offset + numBits > 64)
+            value |= words[iWord + 1] << (64 - offset);
+         return value & lowBits(numBits);
+      }
+
+      // put numBits bits at bit, leaving the ones below alone
+      void writeBits(size_t bit, size_t numBits, uint64_t value)
+      {
+         value &= lowBits(numBits);
+         size_t iWord = bit / 64;
+         size_t offset = bit % 64;
+         if (iWord == words.size())
+            words.push_back(0);
+         words[iWord] = (words[iWord] & lowBits(offset)) | (value << offset);
+         if (!(ALIGNED && numBits == Bits) && offset + numBits > 64)
+         {
+            if (iWord + 1 == words.size())
+               words.push_back(0);
+            words[iWord + 1] = value >> (64 - offset);
+         }
+      }
+
+      // let go of the words above the top
+      void shrink()
+      {
+         size_t num = wordsFor(numElements);
+         while (words.size() > num)
+            words.pop_back();
+      }
+
+      custom::vector<uint64_t> words;
+      size_t numElements;
+   };
+
+   /**************************************************
+    * BIT STACK
+    * A stack of bools, one bit each
+    *************************************************/
+   using bit_stack = packed_stack<1>;
+
+} // custom namespace
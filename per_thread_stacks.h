@@ -0,0 +1,276 @@
+/***********************************************************************
+ * Module:
+ *    Per-Thread Stacks
+ * Summary:
+ *    One stack for each thread, each on its own cache lines
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       per_thread_stacks     : a fixed set of stacks, one per thread
+ *
+ *    A stack is only a few words (the vector's pointer, size and
+ *    capacity), so an array of them puts several on one cache line and
+ *    every push by one thread invalidates the line under its neighbors.
+ *    Here every stack gets a cache line of its own.  A thread claims a
+ *    slot the first time it asks for local(), and gives it up when the
+ *    thread exits, so any number of threads may come and go as long as
+ *    no more than num_slots() are using the container at once.  What a
+ *    thread leaves on its stack stays there, for drain() or for the
+ *    next thread to claim the slot.  The owners are kept in a separate
+ *    array that is only written when a slot is claimed or given up, so
+ *    looking up a slot does not touch the lines the other threads are
+ *    writing.
+ *
+ *    size() and drain() look at every slot: only call them when the
+ *    worker threads are not pushing or popping.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>     // for std::atomic
+#include <cassert>    // because I am paranoid
+#include <cstdint>    // for uint64_t
+#include <memory>     // for std::shared_ptr, std::weak_ptr
+#include <stdexcept>  // for std::length_error
+#include <thread>     // for std::thread::id
+#include <utility>    // for std::move
+#include "stack.h"
+
+class TestPerThreadStacks; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /**************************************************
+    * PER THREAD STACKS
+    * Each thread pushes and pops its own stack
+    *************************************************/
+   template <class T, class Container = custom::vector<T>>
+   class per_thread_stacks
+   {
+      friend class ::TestPerThreadStacks; // give unit tests access to private members
+   public:
+
+      static const size_t CACHE_LINE = 64;
+      using stack_type = custom::stack<T, Container>;
+
+      //
+      // Construct
+      //
+
+      per_thread_stacks(size_t numSlots = defaultSlots()) :
+         slots(new Slot[numSlots]),
+         owners(new Owner[numSlots]),
+         numSlots(numSlots),
+         instance(nextInstance++)
+      {
+         for (size_t i = 0; i < numSlots; i++)
+            owners[i].store(std::thread::id(), std::memory_order_relaxed);
+      }
+      per_thread_stacks(const per_thread_stacks& rhs) = delete;
+      per_thread_stacks& operator = (const per_thread_stacks& rhs) = delete;
+      ~per_thread_stacks()
+      {
+         delete [] slots;
+      }
+
+      //
+      // Access
+      //
+
+      // the calling thread's own stack
+      stack_type& local()
+      {
+         return slots[indexOfThisThread()].items;
+      }
+      T& top()
+      {
+         return local().top();
+      }
+
+      // any slot, claimed or not
+      stack_type& slot(size_t i)
+      {
+         assert(i < numSlots);
+         return slots[i].items;
+      }
+
+      //
+      // Insert
+      //
+
+      void push(const T& t) { local().push(t);            }
+      void push(T&& t)      { local().push(std::move(t)); }
+
+      //
+      // Remove
+      //
+
+      void pop() { local().pop(); }
+
+      // hand every element of every stack to f, emptying them all
+      template <class Function>
+      void drain(Function f)
+      {
+         for (size_t i = 0; i < numSlots; i++)
+         {
+            stack_type& items = slots[i].items;
+            while (!items.empty())
+            {
+               f(std::move(items.top()));
+               items.pop();
+            }
+         }
+      }
+      void drain_to(stack_type& out)
+      {
+         drain([&out](T&& t) { out.push(std::move(t)); });
+      }
+
+      //
+      // Status
+      //
+
+      size_t size() const
+      {
+         size_t num = 0;
+         for (size_t i = 0; i < numSlots; i++)
+            num += slots[i].items.size();
+         return num;
+      }
+      bool   empty() const { return size() == 0; }
+      size_t num_slots() const { return numSlots; }
+      size_t num_threads() const
+      {
+         size_t num = 0;
+         for (size_t i = 0; i < numSlots; i++)
+            if (owners[i].load(std::memory_order_acquire) != std::thread::id())
+               num++;
+         return num;
+      }
+
+   private:
+
+      // a whole number of cache lines, holding one stack
+      struct alignas(CACHE_LINE) Slot
+      {
+         stack_type items;
+      };
+
+      static size_t defaultSlots()
+      {
+         unsigned int num = std::thread::hardware_concurrency();
+         return num ? num : 8;
+      }
+
+      using Owner = std::atomic<std::thread::id>;
+
+      // the slots a thread has claimed, given up when the thread exits.
+      // The owners outlive the container for as long as a claim needs them
+      struct Claims
+      {
+         struct Claim
+         {
+            std::weak_ptr<Owner[]> owners;
+            size_t index;
+         };
+         custom::vector<Claim> claims;
+
+         void add(const std::shared_ptr<Owner[]>& owners, size_t index);
+         ~Claims();
+      };
+
+      // which slot the calling thread owns, claiming one if need be
+      size_t indexOfThisThread();
+
+      Slot*  slots;                               // the stacks
+      std::shared_ptr<Owner[]> owners;            // which thread has each slot
+      size_t numSlots;
+      uint64_t instance;                          // never reused, unlike this
+
+      static std::atomic<uint64_t> nextInstance;
+   };
+
+   template <class T, class Container>
+   std::atomic<uint64_t> per_thread_stacks<T, Container>::nextInstance(1);
+
+   /*****************************************
+    * PER THREAD STACKS :: INDEX OF THIS THREAD
+    * Each thread remembers the last slot it used and which
+    * container it was in, so the usual lookup is one compare.
+    * Otherwise find our id among the owners, or claim a free slot.
+    ****************************************/
+   template <class T, class Container>
+   size_t per_thread_stacks<T, Container>::indexOfThisThread()
+   {
+      struct Cache
+      {
+         uint64_t instance;
+         size_t   index;
+      };
+      static thread_local Cache cache = { 0, 0 };
+      if (cache.instance == instance)
+         return cache.index;
+
+      std::thread::id self = std::this_thread::get_id();
+      for (size_t i = 0; i < numSlots; i++)
+         if (owners[i].load(std::memory_order_acquire) == self)
+         {
+            cache = { instance, i };
+            return i;
+         }
+
+      for (size_t i = 0; i < numSlots; i++)
+      {
+         std::thread::id nobody;
+         if (owners[i].load(std::memory_order_relaxed) == nobody &&
+             owners[i].compare_exchange_strong(nobody, self, std::memory_order_acq_rel))
+         {
+            static thread_local Claims claims;
+            claims.add(owners, i);
+            cache = { instance, i };
+            return i;
+         }
+      }
+      throw std::length_error("per_thread_stacks: more threads than slots");
+   }
+
+   /*****************************************
+    * PER THREAD STACKS :: CLAIMS :: ADD
+    * Remember a slot this thread claimed, forgetting those
+    * in containers that are gone
+    ****************************************/
+   template <class T, class Container>
+   void per_thread_stacks<T, Container>::Claims::add(const std::shared_ptr<Owner[]>& owners, size_t index)
+   {
+      size_t numKept = 0;
+      for (size_t i = 0; i < claims.size(); i++)
+         if (!claims[i].owners.expired())
+            claims[numKept++] = std::move(claims[i]);
+      while (claims.size() > numKept)
+         claims.pop_back();
+      claims.push_back(Claim{ owners, index });
+   }
+
+   /*****************************************
+    * PER THREAD STACKS :: CLAIMS :: DESTRUCTOR
+    * The thread is exiting: give up its slots.  The release
+    * hands what it left on them to the next thread to claim one
+    ****************************************/
+   template <class T, class Container>
+   per_thread_stacks<T, Container>::Claims::~Claims()
+   {
+      for (size_t i = 0; i < claims.size(); i++)
+         if (std::shared_ptr<Owner[]> owners = claims[i].owners.lock())
+            owners[claims[i].index].store(std::thread::id(), std::memory_order_release);
+   }
+
+} // custom namespace
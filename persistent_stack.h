@@ -0,0 +1,267 @@
+/***********************************************************************
+ * Module:
+ *    Persistent Stack
+ * Summary:
+ *    An immutable stack: push and pop make new versions that share
+ *    everything underneath with the old one
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       persistent_stack        : an immutable, structurally shared stack
+ *
+ *    Each version is a pointer to its top node; the nodes are reference
+ *    counted and come from a pool shared by every version descended from
+ *    the same stack, so push is one pool pop rather than one malloc.
+ *    The counts are not atomic: keep a family of versions on one thread.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>  // because I am paranoid
+#include <memory>   // for std::allocator
+#include <new>      // for placement new
+#include <utility>  // for std::move, std::swap
+#include "vector.h"
+
+class TestPersistentStack; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /**************************************************
+    * PERSISTENT STACK
+    * push() and pop() leave *this alone and return the new version
+    *************************************************/
+   template<class T>
+   class persistent_stack
+   {
+      friend class ::TestPersistentStack; // give unit tests access to private members
+   public:
+
+      //
+      // Construct
+      //
+
+      persistent_stack() : head(nullptr), pool(nullptr) {}
+      persistent_stack(const persistent_stack& rhs) : head(rhs.head), pool(rhs.pool)
+      {
+         retain();
+      }
+      persistent_stack(persistent_stack&& rhs) : head(rhs.head), pool(rhs.pool)
+      {
+         rhs.head = nullptr;
+         rhs.pool = nullptr;
+      }
+      ~persistent_stack()
+      {
+         release();
+      }
+
+      //
+      // Assign
+      //
+      persistent_stack& operator = (const persistent_stack& rhs)
+      {
+         persistent_stack temp(rhs);
+         swap(temp);
+         return *this;
+      }
+      persistent_stack& operator = (persistent_stack&& rhs)
+      {
+         persistent_stack temp(std::move(rhs));
+         swap(temp);
+         return *this;
+      }
+      void swap(persistent_stack& rhs)
+      {
+         std::swap(head, rhs.head);
+         std::swap(pool, rhs.pool);
+      }
+
+      //
+      // Access
+      //
+
+      const T& top() const
+      {
+         assert(head != nullptr);
+         return head->value;
+      }
+
+      //
+      // Insert
+      //
+
+      persistent_stack push(const T& t) const
+      {
+         return persistent_stack(*this, t);
+      }
+      persistent_stack push(T&& t) const
+      {
+         return persistent_stack(*this, std::move(t));
+      }
+
+      //
+      // Remove
+      //
+
+      persistent_stack pop() const
+      {
+         if (head == nullptr)
+            return *this;
+         return persistent_stack(head->next, pool);
+      }
+
+      //
+      // Status
+      //
+
+      size_t size () const { return head ? head->size : 0; }
+      bool   empty() const { return head == nullptr; }
+
+   private:
+
+      struct Node
+      {
+         T      value;    // the element
+         Node*  next;     // the element underneath, shared
+         size_t refs;     // versions and nodes pointing here
+         size_t size;     // number of elements from here down
+      };
+
+      /**************************************************
+       * POOL
+       * Hands out Node-sized blocks from chunks that double
+       * in size, and takes them back onto a free list
+       *************************************************/
+      class Pool
+      {
+         friend class ::TestPersistentStack;
+      public:
+         Pool() : refs(1), freeList(nullptr), numChunk(32) {}
+         ~Pool()
+         {
+            for (size_t i = 0; i < chunks.size(); i++)
+               alloc.deallocate(chunks[i], sizes[i]);
+         }
+
+         void* allocate()
+         {
+            if (freeList == nullptr)
+               grow();
+            Block* block = freeList;
+            freeList = block->next;
+            return block->bytes;
+         }
+         void deallocate(void* p)
+         {
+            Block* block = static_cast<Block*>(p);
+            block->next = freeList;
+            freeList = block;
+         }
+
+         size_t refs;     // versions using this pool
+
+      private:
+         union Block
+         {
+            Block* next;
+            alignas(Node) unsigned char bytes[sizeof(Node)];
+         };
+
+         void grow()
+         {
+            Block* chunk = alloc.allocate(numChunk);
+            chunks.push_back(chunk);
+            sizes.push_back(numChunk);
+            for (size_t i = numChunk; i-- > 0; )
+            {
+               chunk[i].next = freeList;
+               freeList = chunk + i;
+            }
+            if (numChunk < 65536)
+               numChunk *= 2;
+         }
+
+         std::allocator<Block>  alloc;
+         custom::vector<Block*> chunks;   // every chunk, to free them at the end
+         custom::vector<size_t> sizes;    // how many blocks are in each chunk
+         Block* freeList;                 // blocks ready to be handed out
+         size_t numChunk;                 // size of the next chunk
+      };
+
+      // a new version with t on top of rhs.  The node is built before
+      // any count is taken, so if the pool cannot grow or T throws, the
+      // block goes back and rhs is left exactly as it was
+      template <class U>
+      persistent_stack(const persistent_stack& rhs, U&& t) : head(nullptr), pool(nullptr)
+      {
+         Pool* poolNew = rhs.pool ? rhs.pool : new Pool;
+         void* block = nullptr;
+         try
+         {
+            block = poolNew->allocate();
+            head = new (block) Node{std::forward<U>(t), rhs.head, 1, rhs.size() + 1};
+         }
+         catch (...)
+         {
+            if (block)
+               poolNew->deallocate(block);
+            if (!rhs.pool)
+               delete poolNew;
+            throw;
+         }
+
+         pool = poolNew;
+         if (rhs.pool)
+            pool->refs++;
+         if (rhs.head)
+            rhs.head->refs++;
+      }
+
+      // a version starting at an existing node
+      persistent_stack(Node* head, Pool* pool) : head(head), pool(head ? pool : nullptr)
+      {
+         retain();
+      }
+
+      void retain()
+      {
+         if (head)
+         {
+            head->refs++;
+            pool->refs++;
+         }
+      }
+
+      // drop this version, freeing every node nobody else points to
+      void release()
+      {
+         if (head == nullptr)
+            return;
+         for (Node* p = head; p && --p->refs == 0; )
+         {
+            Node* next = p->next;
+            p->~Node();
+            pool->deallocate(p);
+            p = next;
+         }
+         if (--pool->refs == 0)
+            delete pool;
+         head = nullptr;
+         pool = nullptr;
+      }
+
+      Node* head;    // top of this version
+      Pool* pool;    // where the nodes come from
+   };
+
+} // custom namespace
@@ -0,0 +1,316 @@
+/***********************************************************************
+ * Header:
+ *    PRIORITY QUEUE
+ * Summary:
+ *    Our custom implementation of std::priority_queue
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *        priority_queue          : A class that represents a Priority Queue
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>     // because I am paranoid
+#include <functional>  // for std::less
+#include <stdexcept>   // for std::out_of_range
+#include <utility>     // for std::move, std::swap
+#include "aligned_allocator.h"
+#include "vector.h"
+
+class TestPQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+   /*************************************************
+    * P QUEUE
+    * Create a priority queue.  The heap is D-ary (4-ary
+    * by default) rather than binary: the tree is half as
+    * deep, and the D children of a node sit next to each
+    * other in the container, so one sift-down step reads
+    * one contiguous run of D elements.
+    *
+    * The root sits after D - 1 default-constructed filler
+    * slots, so every run of siblings starts at a multiple
+    * of D.  The default container starts on a cache line,
+    * so when D * sizeof(T) divides the line (four 8-byte
+    * keys, say) each run lies within one line.
+    *************************************************/
+   template<class T,
+            class Container = custom::vector<T, custom::aligned_allocator<T>>,
+            class Compare = std::less<T>,
+            size_t D = 4>
+   class priority_queue
+   {
+      friend class ::TestPQueue; // give the unit test class access to the privates
+      static_assert(D >= 2, "a heap needs at least two children per node");
+   public:
+
+      //
+      // construct
+      //
+      priority_queue(const Compare& c = Compare()) : container(), compare(c) {}
+      priority_queue(const priority_queue& rhs) : container(rhs.container), compare(rhs.compare) {}
+      priority_queue(priority_queue&& rhs) : container(std::move(rhs.container)), compare(std::move(rhs.compare)) {}
+      template <class Iterator>
+      priority_queue(Iterator first, Iterator last, const Compare& c = Compare()) : container(), compare(c)
+      {
+         push_range(first, last);
+      }
+      explicit priority_queue(const Compare& c, Container&& rhs) : container(std::move(rhs)), compare(c)
+      {
+         if (!container.empty())
+            container.insert(container.begin(), ROOT, T());
+         heapify();
+      }
+      explicit priority_queue(const Compare& c, const Container& rhs) : container(rhs), compare(c)
+      {
+         if (!container.empty())
+            container.insert(container.begin(), ROOT, T());
+         heapify();
+      }
+      ~priority_queue() {}
+
+      //
+      // Assign
+      //
+      priority_queue& operator = (const priority_queue& rhs)
+      {
+         container = rhs.container;
+         compare = rhs.compare;
+         return *this;
+      }
+      priority_queue& operator = (priority_queue&& rhs)
+      {
+         container = std::move(rhs.container);
+         compare = std::move(rhs.compare);
+         return *this;
+      }
+      void swap(priority_queue& rhs)
+      {
+         std::swap(container, rhs.container);
+         std::swap(compare, rhs.compare);
+      }
+
+      //
+      // Access
+      //
+      const T & top() const;
+
+      //
+      // Insert
+      //
+      void  push(const T& t);
+      void  push(T&& t);
+      template <class ... Args>
+      void  emplace(Args&& ... args)
+      {
+         push(T(std::forward<Args>(args)...));
+      }
+      template <class Iterator>
+      void  push_range(Iterator first, Iterator last);
+
+      //
+      // Remove
+      //
+      void  pop();
+
+      //
+      // Status
+      //
+      size_t size()  const { return container.size() > ROOT ? container.size() - ROOT : 0; }
+      bool   empty() const { return size() == 0; }
+
+   private:
+
+      // the container holds nothing, or ROOT fillers and then the heap
+      static const size_t ROOT = D - 1;
+
+      // children of i are D*i+1 .. D*i+D, the parent is (i-1)/D.  With
+      // the root at ROOT, the children sit at D*(i+1) .. D*(i+1)+D-1
+      static size_t child (size_t i) { return D * i + 1; }
+      static size_t parent(size_t i) { return (i - 1) / D; }
+
+      T&       at(size_t i)       { return container[ROOT + i]; }
+      const T& at(size_t i) const { return container[ROOT + i]; }
+
+      // put the fillers in front of the first element
+      void pad()
+      {
+         for (size_t i = 0; i < ROOT; i++)
+            container.push_back(T());
+      }
+
+      void percolateUp(size_t index);
+      void percolateDown(size_t index);
+      void heapify();
+
+      Container container;       // underlying container (probably a vector)
+      Compare   compare;         // comparision operator
+   };
+
+   /************************************************
+    * P QUEUE :: TOP
+    * Get the maximum item from the heap: the top item.
+    ***********************************************/
+   template <class T, class Container, class Compare, size_t D>
+   const T & priority_queue <T, Container, Compare, D> :: top() const
+   {
+      if (empty())
+         throw std::out_of_range("std:out_of_range");
+      return at(0);
+   }
+
+   /**********************************************
+    * P QUEUE :: POP
+    * Delete the top item from the heap.
+    **********************************************/
+   template <class T, class Container, class Compare, size_t D>
+   void priority_queue <T, Container, Compare, D> :: pop()
+   {
+      if (empty())
+         return;
+
+      // move the last item to the root and sift it back down
+      if (size() > 1)
+         at(0) = std::move(container.back());
+      container.pop_back();
+      if (!empty())
+         percolateDown(0);
+   }
+
+   /*****************************************
+    * P QUEUE :: PUSH
+    * Add a new element to the heap, reallocating as necessary
+    ****************************************/
+   template <class T, class Container, class Compare, size_t D>
+   void priority_queue <T, Container, Compare, D> :: push(const T & t)
+   {
+      if (container.empty())
+         pad();
+      container.push_back(t);
+      percolateUp(size() - 1);
+   }
+   template <class T, class Container, class Compare, size_t D>
+   void priority_queue <T, Container, Compare, D> :: push(T && t)
+   {
+      if (container.empty())
+         pad();
+      container.push_back(std::move(t));
+      percolateUp(size() - 1);
+   }
+
+   /*****************************************
+    * P QUEUE :: PUSH RANGE
+    * Add many elements at once.  When the batch is large
+    * compared to what is already there, append everything
+    * and rebuild the heap bottom-up in O(n) rather than
+    * sifting each one up in O(n log n).
+    ****************************************/
+   template <class T, class Container, class Compare, size_t D>
+   template <class Iterator>
+   void priority_queue <T, Container, Compare, D> :: push_range(Iterator first, Iterator last)
+   {
+      if (first == last)
+         return;
+      if (container.empty())
+         pad();
+      size_t numOld = size();
+      for (; first != last; ++first)
+         container.push_back(*first);
+
+      size_t numNew = size() - numOld;
+      if (numNew > numOld)
+         heapify();
+      else
+         for (size_t i = numOld; i < size(); i++)
+            percolateUp(i);
+   }
+
+   /************************************************
+    * P QUEUE :: PERCOLATE UP
+    * Move the element at index up until its parent is
+    * no smaller.  The element is held in a temporary and
+    * the parents slide down into the hole, so each level
+    * costs one move rather than a three-move swap.
+    ***********************************************/
+   template <class T, class Container, class Compare, size_t D>
+   void priority_queue <T, Container, Compare, D> :: percolateUp(size_t index)
+   {
+      if (index == 0 || !compare(at(parent(index)), at(index)))
+         return;
+
+      T value(std::move(at(index)));
+      do
+      {
+         at(index) = std::move(at(parent(index)));
+         index = parent(index);
+      }
+      while (index != 0 && compare(at(parent(index)), value));
+      at(index) = std::move(value);
+   }
+
+   /************************************************
+    * P QUEUE :: PERCOLATE DOWN
+    * The element at index may be smaller than its children.
+    * Find the largest of the (up to D) children, which are
+    * adjacent in memory, and slide it up into the hole.
+    ***********************************************/
+   template <class T, class Container, class Compare, size_t D>
+   void priority_queue <T, Container, Compare, D> :: percolateDown(size_t index)
+   {
+      size_t num = size();
+      T value(std::move(at(index)));
+      for (size_t first = child(index); first < num; first = child(index))
+      {
+         // find the biggest sibling
+         size_t last = (num - first < D) ? num : first + D;
+         size_t indexBig = first;
+         for (size_t i = first + 1; i < last; i++)
+            indexBig = compare(at(indexBig), at(i)) ? i : indexBig;
+
+         // done when the hole is no smaller than the biggest child
+         if (!compare(value, at(indexBig)))
+            break;
+
+         at(index) = std::move(at(indexBig));
+         index = indexBig;
+      }
+      at(index) = std::move(value);
+   }
+
+   /************************************************
+    * P QUEUE :: HEAPIFY
+    * Turn the container into a heap from the last
+    * parent up to the root: O(n)
+    ***********************************************/
+   template <class T, class Container, class Compare, size_t D>
+   void priority_queue <T, Container, Compare, D> :: heapify()
+   {
+      if (size() <= 1)
+         return;
+      for (size_t i = parent(size() - 1) + 1; i-- > 0; )
+         percolateDown(i);
+   }
+
+   /************************************************
+    * SWAP
+    * Swap the contents of two priority queues
+    ************************************************/
+   template <class T, class Container, class Compare, size_t D>
+   inline void swap(custom::priority_queue <T, Container, Compare, D>& lhs,
+                    custom::priority_queue <T, Container, Compare, D>& rhs)
+   {
+      lhs.swap(rhs);
+   }
+
+} // namespace custom
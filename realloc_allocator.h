@@ -0,0 +1,232 @@
+/***********************************************************************
+ * Module:
+ *    Realloc Allocator
+ * Summary:
+ *    Allocators that let a vector grow its buffer without copying
+ *    every element into a new one
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       realloc_allocator     : malloc, free, and realloc to grow
+ *       mremap_allocator      : realloc for small blocks, mmap and
+ *                               mremap for big ones (Linux)
+ *
+ *    Both offer the two calls vector::reserve looks for:
+ *       try_expand(p, num, numNew)  : grow the block where it is, or
+ *                                     return false and change nothing
+ *       reallocate(p, num, numNew)  : resize the block, moving its bytes
+ *                                     if need be, and return where it
+ *                                     is now; throw if it cannot
+ *    The vector only calls reallocate when T is trivially copyable,
+ *    since the bytes are moved without asking T.
+ *
+ *    realloc often extends a block in place, and when it cannot, a
+ *    big block is moved by remapping its pages rather than copying
+ *    them.  mremap does that directly: the kernel moves page table
+ *    entries, so growing a gigabyte costs about what growing a
+ *    megabyte does.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>      // for size_t
+#include <cstdlib>      // for std::malloc, std::free, std::realloc
+#include <cstring>      // for std::memcpy
+#include <limits>       // for std::numeric_limits
+#include <new>          // for std::bad_alloc
+#include <type_traits>  // for std::true_type
+
+#ifdef __GLIBC__
+#include <malloc.h>     // for malloc_usable_size
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>   // for mmap, mremap, munmap
+#include <unistd.h>     // for sysconf
+#endif
+
+namespace custom
+{
+
+   /**************************************************
+    * REALLOC ALLOCATOR
+    * The C heap, with realloc to grow
+    *************************************************/
+   template <class T>
+   class realloc_allocator
+   {
+   public:
+      using value_type = T;
+      using is_always_equal = std::true_type;
+
+      realloc_allocator() {}
+      template <class U>
+      realloc_allocator(const realloc_allocator<U>&) {}
+
+      T* allocate(size_t num)
+      {
+         void* p = std::malloc(bytesFor(num));
+         if (p == nullptr)
+            throw std::bad_alloc();
+         return static_cast<T*>(p);
+      }
+      void deallocate(T* p, size_t)
+      {
+         std::free(p);
+      }
+
+      // glibc often hands out a little more than was asked for
+      bool try_expand(T* p, size_t, size_t numNew)
+      {
+#ifdef __GLIBC__
+         return malloc_usable_size(p) >= bytesFor(numNew);
+#else
+         (void)p;
+         return false;
+#endif
+      }
+      T* reallocate(T* p, size_t, size_t numNew)
+      {
+         void* pNew = std::realloc(p, bytesFor(numNew));
+         if (pNew == nullptr)
+            throw std::bad_alloc();
+         return static_cast<T*>(pNew);
+      }
+
+      template <class U>
+      bool operator == (const realloc_allocator<U>&) const { return true; }
+      template <class U>
+      bool operator != (const realloc_allocator<U>&) const { return false; }
+
+   private:
+      static size_t bytesFor(size_t num)
+      {
+         if (num > std::numeric_limits<size_t>::max() / sizeof(T))
+            throw std::bad_alloc();
+         return num * sizeof(T);
+      }
+   };
+
+#ifdef __linux__
+
+   /**************************************************
+    * MREMAP ALLOCATOR
+    * Blocks of at least MAP_THRESHOLD bytes are pages of
+    * their own, grown with mremap; smaller ones come from
+    * the C heap.  Which is which follows from the size, so
+    * deallocate knows without being told.
+    *************************************************/
+   template <class T>
+   class mremap_allocator
+   {
+   public:
+      using value_type = T;
+      using is_always_equal = std::true_type;
+
+      static const size_t MAP_THRESHOLD = (size_t)1 << 20;
+
+      mremap_allocator() {}
+      template <class U>
+      mremap_allocator(const mremap_allocator<U>&) {}
+
+      T* allocate(size_t num)
+      {
+         size_t numBytes = bytesFor(num);
+         if (numBytes < MAP_THRESHOLD)
+            return heap.allocate(num);
+         void* p = ::mmap(nullptr, pages(numBytes), PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+         if (p == MAP_FAILED)
+            throw std::bad_alloc();
+         return static_cast<T*>(p);
+      }
+      void deallocate(T* p, size_t num)
+      {
+         size_t numBytes = bytesFor(num);
+         if (numBytes < MAP_THRESHOLD)
+            heap.deallocate(p, num);
+         else
+            ::munmap(p, pages(numBytes));
+      }
+
+      // mapped: ask for the pages after ours; small: as realloc_allocator
+      bool try_expand(T* p, size_t num, size_t numNew)
+      {
+         size_t numBytes = bytesFor(num);
+         size_t numBytesNew = bytesFor(numNew);
+         if (numBytes < MAP_THRESHOLD)
+            return numBytesNew < MAP_THRESHOLD && heap.try_expand(p, num, numNew);
+         if (numBytesNew < MAP_THRESHOLD)
+            return false;               // a small block belongs on the heap
+         if (pages(numBytesNew) == pages(numBytes))
+            return true;
+         return ::mremap(p, pages(numBytes), pages(numBytesNew), 0) != MAP_FAILED;
+      }
+      T* reallocate(T* p, size_t num, size_t numNew)
+      {
+         size_t numBytes = bytesFor(num);
+         size_t numBytesNew = bytesFor(numNew);
+         if (numBytesNew < MAP_THRESHOLD && numBytes < MAP_THRESHOLD)
+            return heap.reallocate(p, num, numNew);
+         if (numBytesNew < MAP_THRESHOLD)
+         {
+            // shrinking back to the heap: keep what fits, unmap the rest
+            T* pNew = heap.allocate(numNew);
+            std::memcpy(pNew, p, numBytesNew);
+            ::munmap(p, pages(numBytes));
+            return pNew;
+         }
+         if (numBytes < MAP_THRESHOLD)
+         {
+            // leaving the heap: one copy, and from then on no more
+            T* pNew = allocate(numNew);
+            std::memcpy(pNew, p, numBytes);
+            heap.deallocate(p, num);
+            return pNew;
+         }
+         void* pNew = ::mremap(p, pages(numBytes), pages(numBytesNew), MREMAP_MAYMOVE);
+         if (pNew == MAP_FAILED)
+            throw std::bad_alloc();
+         return static_cast<T*>(pNew);
+      }
+
+      template <class U>
+      bool operator == (const mremap_allocator<U>&) const { return true; }
+      template <class U>
+      bool operator != (const mremap_allocator<U>&) const { return false; }
+
+   private:
+      static size_t bytesFor(size_t num)
+      {
+         if (num > std::numeric_limits<size_t>::max() / sizeof(T))
+            throw std::bad_alloc();
+         return num * sizeof(T);
+      }
+
+      // numBytes rounded up to whole pages
+      static size_t pages(size_t numBytes)
+      {
+         static const size_t pageSize = (size_t)::sysconf(_SC_PAGESIZE);
+         return (numBytes + pageSize - 1) / pageSize * pageSize;
+      }
+
+      realloc_allocator<T> heap;
+   };
+
+#else
+
+   // without mremap, the heap is the best there is
+   template <class T>
+   using mremap_allocator = realloc_allocator<T>;
+
+#endif // __linux__
+
+} // custom namespace
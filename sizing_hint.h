@@ -0,0 +1,111 @@
+/***********************************************************************
+ * Module:
+ *    Sizing Hint
+ * Summary:
+ *    Remember how deep the stacks made at one place got, and
+ *    suggest how much the next one should reserve
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       sizing_hint           : a history of high-water marks
+ *
+ *    Make one sizing_hint for a place in the code that makes stacks,
+ *    usually a static, and hand it to each hinted_stack made there.
+ *    The stack reserves what the hint suggests and, when it is
+ *    destroyed, tells the hint the most it ever held.  (A plain stack
+ *    made from a hint only reserves.)  The suggestion is a percentile of
+ *    the last HISTORY of those: at the 90th, nine stacks in ten never
+ *    reallocate, and the tenth starts from a good size.
+ *
+ *    Recording is a relaxed atomic store into a ring, and every
+ *    RECOMPUTE records one of them works the percentile out again, so
+ *    stacks on different threads can share a hint.  A record that
+ *    lands while the percentile is being worked out may be missed;
+ *    this is a hint, so that is fine.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <algorithm>  // for std::nth_element
+#include <atomic>     // for std::atomic
+#include <cassert>    // because I am paranoid
+#include <cstddef>    // for size_t
+
+class TestSizingHint; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /**************************************************
+    * SIZING HINT
+    * How big the stacks from one call site tend to get
+    *************************************************/
+   class sizing_hint
+   {
+      friend class ::TestSizingHint; // give unit tests access to private members
+   public:
+
+      static const size_t HISTORY = 64;     // high-water marks remembered
+      static const size_t RECOMPUTE = 16;   // records between working out the percentile
+
+      explicit sizing_hint(unsigned int percentile = 90) :
+         percentile(percentile > 100 ? 100 : percentile),
+         numRecorded(0),
+         suggestion(0)
+      {
+         for (size_t i = 0; i < HISTORY; i++)
+            history[i].store(0, std::memory_order_relaxed);
+      }
+      sizing_hint(const sizing_hint&) = delete;
+      sizing_hint& operator = (const sizing_hint&) = delete;
+
+      // how many elements a new stack should reserve
+      size_t suggested() const
+      {
+         return suggestion.load(std::memory_order_relaxed);
+      }
+
+      // a stack made with this hint held at most highWater elements
+      void record(size_t highWater)
+      {
+         size_t index = numRecorded.fetch_add(1, std::memory_order_relaxed);
+         history[index % HISTORY].store(highWater, std::memory_order_relaxed);
+         if (index == 0 || (index + 1) % RECOMPUTE == 0)
+            recompute(index + 1 < HISTORY ? index + 1 : HISTORY);
+      }
+
+      size_t num_recorded() const
+      {
+         return numRecorded.load(std::memory_order_relaxed);
+      }
+
+   private:
+
+      // the percentile of the first num marks in the ring
+      void recompute(size_t num)
+      {
+         assert(num != 0 && num <= HISTORY);
+         size_t marks[HISTORY];
+         for (size_t i = 0; i < num; i++)
+            marks[i] = history[i].load(std::memory_order_relaxed);
+         size_t rank = (num * percentile + 99) / 100;
+         size_t* nth = marks + (rank == 0 ? 0 : rank - 1);
+         std::nth_element(marks, nth, marks + num);
+         suggestion.store(*nth, std::memory_order_relaxed);
+      }
+
+      unsigned int        percentile;
+      std::atomic<size_t> history[HISTORY];   // a ring of the latest high-water marks
+      std::atomic<size_t> numRecorded;
+      std::atomic<size_t> suggestion;
+   };
+
+} // custom namespace
@@ -0,0 +1,340 @@
+/***********************************************************************
+ * Module:
+ *    SOA Stack
+ * Summary:
+ *    A stack of tuples stored as one array per field
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       soa_stack             : a struct-of-arrays stack
+ *
+ *    soa_stack<int, char, Pos> holds what stack<tuple<int, char, Pos>>
+ *    would, but every field lives in its own contiguous column.  A loop
+ *    that only reads the ints touches only the int column, which
+ *    column<I>() hands out as a std::span.  The columns share one size
+ *    and one capacity, so they grow together.  A push whose row throws
+ *    part way, or a reserve that cannot get every column, leaves the
+ *    stack as it was.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>      // because I am paranoid
+#include <memory>       // for std::allocator
+#include <new>          // for placement new
+#include <span>         // for std::span
+#include <tuple>        // for std::tuple, std::get
+#include <type_traits>  // for std::is_trivially_destructible
+#include <utility>      // for std::index_sequence, std::move
+
+class TestSOAStack; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /**************************************************
+    * SOA STACK
+    * First-in-Last-out data structure, one column per field
+    *************************************************/
+   template<class ... Ts>
+   class soa_stack
+   {
+      friend class ::TestSOAStack; // give unit tests access to private members
+
+      static_assert(sizeof...(Ts) > 0, "soa_stack needs at least one column");
+
+      using Indices = std::index_sequence_for<Ts...>;
+
+   public:
+
+      template <size_t I>
+      using column_type = typename std::tuple_element<I, std::tuple<Ts...>>::type;
+
+      //
+      // Construct
+      //
+
+      soa_stack() : columns(static_cast<Ts*>(nullptr)...), numCapacity(0), numElements(0) {}
+      soa_stack(const soa_stack& rhs) : soa_stack()
+      {
+         *this = rhs;
+      }
+      soa_stack(soa_stack&& rhs) : soa_stack()
+      {
+         swap(rhs);
+      }
+      ~soa_stack()
+      {
+         clear();
+         deallocate(columns, numCapacity, Indices());
+      }
+
+      //
+      // Assign
+      //
+      soa_stack& operator = (const soa_stack& rhs)
+      {
+         if (this != &rhs)
+         {
+            clear();
+            reserve(rhs.size());
+            for (size_t i = 0; i < rhs.size(); i++)
+               copyAt(rhs, i, Indices());
+         }
+         return *this;
+      }
+      soa_stack& operator = (soa_stack&& rhs)
+      {
+         clear();
+         swap(rhs);
+         return *this;
+      }
+      void swap(soa_stack& rhs)
+      {
+         std::swap(columns, rhs.columns);
+         std::swap(numCapacity, rhs.numCapacity);
+         std::swap(numElements, rhs.numElements);
+      }
+
+      //
+      // Access
+      //
+
+      std::tuple<Ts&...> top()
+      {
+         assert(numElements != 0);
+         return at(numElements - 1, Indices());
+      }
+      std::tuple<const Ts&...> top() const
+      {
+         assert(numElements != 0);
+         return at(numElements - 1, Indices());
+      }
+      std::tuple<Ts&...> operator [] (size_t i)
+      {
+         assert(i < numElements);
+         return at(i, Indices());
+      }
+      std::tuple<const Ts&...> operator [] (size_t i) const
+      {
+         assert(i < numElements);
+         return at(i, Indices());
+      }
+
+      // one field of every element, bottom to top
+      template <size_t I>
+      std::span<column_type<I>> column()
+      {
+         return std::span<column_type<I>>(std::get<I>(columns), numElements);
+      }
+      template <size_t I>
+      std::span<const column_type<I>> column() const
+      {
+         return std::span<const column_type<I>>(std::get<I>(columns), numElements);
+      }
+
+      //
+      // Insert
+      //
+
+      template <class ... Args,
+                class = typename std::enable_if<sizeof...(Args) == sizeof...(Ts) &&
+                                                sizeof...(Ts) != 1>::type>
+      void push(Args&& ... args)
+      {
+         pushRow(std::forward<Args>(args)...);
+      }
+      // a stack with one column takes the value itself
+      template <class U, class = typename std::enable_if<sizeof...(Ts) == 1 &&
+                  !std::is_same<typename std::decay<U>::type, std::tuple<Ts...>>::value>::type>
+      void push(U&& u)
+      {
+         pushRow(std::forward<U>(u));
+      }
+      void push(const std::tuple<Ts...>& t)
+      {
+         pushTuple(t, Indices());
+      }
+      void push(std::tuple<Ts...>&& t)
+      {
+         pushTuple(std::move(t), Indices());
+      }
+      void reserve(size_t newCapacity);
+
+      //
+      // Remove
+      //
+
+      void pop()
+      {
+         if (numElements != 0)
+         {
+            numElements--;
+            destroy(numElements, numElements + 1, Indices());
+         }
+      }
+      void clear()
+      {
+         destroy(0, numElements, Indices());
+         numElements = 0;
+      }
+
+      //
+      // Status
+      //
+
+      size_t size    () const { return numElements;      }
+      bool   empty   () const { return numElements == 0; }
+      size_t capacity() const { return numCapacity;      }
+
+   private:
+
+      template <size_t ... Is>
+      std::tuple<Ts&...> at(size_t i, std::index_sequence<Is...>)
+      {
+         return std::tuple<Ts&...>(std::get<Is>(columns)[i]...);
+      }
+      template <size_t ... Is>
+      std::tuple<const Ts&...> at(size_t i, std::index_sequence<Is...>) const
+      {
+         return std::tuple<const Ts&...>(std::get<Is>(columns)[i]...);
+      }
+
+      // add a row, one argument per column
+      template <class ... Args>
+      void pushRow(Args&& ... args)
+      {
+         if (numElements == numCapacity)
+            reserve(numCapacity ? numCapacity * 2 : 1);
+         construct<0>(numElements, std::forward<Args>(args)...);
+         numElements++;
+      }
+
+      // build element i of columns I and on, one argument each.  If a
+      // later column throws, this one is torn down again, so either the
+      // whole row is built or none of it is
+      template <size_t I, class Arg, class ... Rest>
+      void construct(size_t i, Arg&& arg, Rest&& ... rest)
+      {
+         using T = column_type<I>;
+         T* p = new (std::get<I>(columns) + i) T(std::forward<Arg>(arg));
+         if constexpr (sizeof...(Rest) != 0)
+         {
+            try
+            {
+               construct<I + 1>(i, std::forward<Rest>(rest)...);
+            }
+            catch (...)
+            {
+               p->~T();
+               throw;
+            }
+         }
+      }
+      template <class Tuple, size_t ... Is>
+      void pushTuple(Tuple&& t, std::index_sequence<Is...>)
+      {
+         pushRow(std::get<Is>(std::forward<Tuple>(t))...);
+      }
+      template <size_t ... Is>
+      void copyAt(const soa_stack& rhs, size_t i, std::index_sequence<Is...>)
+      {
+         pushRow(std::get<Is>(rhs.columns)[i]...);
+      }
+
+      // run the destructors of [first, last) in every column
+      template <size_t ... Is>
+      void destroy(size_t first, size_t last, std::index_sequence<Is...>)
+      {
+         (destroyColumn(std::get<Is>(columns), first, last), ...);
+      }
+      template <class T>
+      static void destroyColumn(T* column, size_t first, size_t last)
+      {
+         if constexpr (!std::is_trivially_destructible<T>::value)
+            for (size_t i = first; i < last; i++)
+               column[i].~T();
+      }
+
+      // move [0, num) of every column into the new columns
+      template <size_t ... Is>
+      static void relocate(std::tuple<Ts*...>& to, std::tuple<Ts*...>& from, size_t num,
+                           std::index_sequence<Is...>)
+      {
+         (relocateColumn(std::get<Is>(to), std::get<Is>(from), num), ...);
+      }
+      template <class T>
+      static void relocateColumn(T* to, T* from, size_t num)
+      {
+         for (size_t i = 0; i < num; i++)
+         {
+            new (to + i) T(std::move(from[i]));
+            from[i].~T();
+         }
+      }
+
+      // num elements for columns I and on; if a later column cannot
+      // be had, this one is given back
+      template <size_t I>
+      static void allocate(std::tuple<Ts*...>& cols, size_t num)
+      {
+         using T = column_type<I>;
+         std::get<I>(cols) = std::allocator<T>().allocate(num);
+         if constexpr (I + 1 < sizeof...(Ts))
+         {
+            try
+            {
+               allocate<I + 1>(cols, num);
+            }
+            catch (...)
+            {
+               deallocateColumn(std::get<I>(cols), num);
+               throw;
+            }
+         }
+      }
+      template <size_t ... Is>
+      static void deallocate(std::tuple<Ts*...>& cols, size_t num, std::index_sequence<Is...>)
+      {
+         (deallocateColumn(std::get<Is>(cols), num), ...);
+      }
+      template <class T>
+      static void deallocateColumn(T* column, size_t num)
+      {
+         if (column)
+            std::allocator<T>().deallocate(column, num);
+      }
+
+      std::tuple<Ts*...> columns;  // one array per field, all numCapacity long
+      size_t numCapacity;          // room in each column
+      size_t numElements;          // elements in each column
+   };
+
+   /*****************************************
+    * SOA STACK :: RESERVE
+    * Grow every column to newCapacity at once
+    ****************************************/
+   template <class ... Ts>
+   void soa_stack<Ts...>::reserve(size_t newCapacity)
+   {
+      if (newCapacity <= numCapacity)
+         return;
+
+      std::tuple<Ts*...> newColumns(static_cast<Ts*>(nullptr)...);
+      allocate<0>(newColumns, newCapacity);
+      relocate(newColumns, columns, numElements, Indices());
+      deallocate(columns, numCapacity, Indices());
+
+      columns = newColumns;
+      numCapacity = newCapacity;
+   }
+
+} // custom namespace
@@ -0,0 +1,459 @@
+/***********************************************************************
+ * Module:
+ *    Spilling Stack
+ * Summary:
+ *    A stack that keeps only its top in memory and spills the rest
+ *    to a temporary file
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       spilling_stack        : an out-of-core stack under a memory budget
+ *
+ *    The elements live in segments of a fixed size.  When more
+ *    segments than the budget allows are in memory, the one at the
+ *    bottom is written to the file in the background, at the offset
+ *    its position gives it, so the file is itself a stack of segments.
+ *    As pops come within a segment of the ones on disk, the next one
+ *    down is read back in the background.  Only one read or write is
+ *    in flight at a time.
+ *
+ *    A segment read back from disk is still on disk, so if pushes
+ *    send it back out before it is touched, nothing is written.  Nor
+ *    is anything read when the segment wanted is the one last written
+ *    and its buffer has not been reused.
+ *
+ *    A read or write that fails throws from whichever push or pop next
+ *    waits on it, and leaves the stack as though it had not been tried:
+ *    a segment that could not be written stays in memory, and one that
+ *    could not be read stays on disk.  Either way the call can be tried
+ *    again.
+ *
+ *    Elements are copied as bytes, so T must be trivially copyable.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>       // because I am paranoid
+#include <cerrno>        // for errno
+#include <cstddef>       // for std::max_align_t
+#include <cstdio>        // for std::tmpfile
+#include <future>        // for std::async, std::future
+#include <new>           // for ::operator new
+#include <system_error>  // for std::system_error
+#include <type_traits>   // for std::is_trivially_copyable
+#include "fd_io.h"
+#include "vector.h"
+
+class TestSpillingStack; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /**************************************************
+    * SPILLING STACK
+    * First-in-Last-out, as big as the disk allows
+    *************************************************/
+   template <class T>
+   class spilling_stack
+   {
+      friend class ::TestSpillingStack; // give unit tests access to private members
+
+      static_assert(std::is_trivially_copyable<T>::value,
+                    "spilling_stack copies elements as bytes");
+      static_assert(alignof(T) <= alignof(std::max_align_t),
+                    "spilling_stack segments are only max-aligned");
+
+   public:
+
+      //
+      // Construct
+      //
+
+      spilling_stack(size_t budgetBytes = (size_t)64 << 20, size_t segmentBytes = (size_t)1 << 20);
+      spilling_stack(const spilling_stack& rhs) = delete;
+      spilling_stack& operator = (const spilling_stack& rhs) = delete;
+      ~spilling_stack();
+
+      //
+      // Access
+      //
+
+      T& top()
+      {
+         assert(numElements != 0);
+         return topSegment[numTop - 1];
+      }
+      const T& top() const
+      {
+         assert(numElements != 0);
+         return topSegment[numTop - 1];
+      }
+
+      //
+      // Insert
+      //
+
+      void push(const T& t)
+      {
+         if (numTop == numPerSegment)
+            pushSegment();
+         topSegment[numTop++] = t;
+         numElements++;
+      }
+
+      //
+      // Remove
+      //
+
+      void pop()
+      {
+         assert(numElements != 0);
+         if (numTop == 1 && numElements != 1)
+            popSegment();
+         else
+         {
+            numTop--;
+            numElements--;
+         }
+      }
+      void clear();
+
+      //
+      // Status
+      //
+
+      size_t size()  const { return numElements;      }
+      bool   empty() const { return numElements == 0; }
+      size_t spilled_size() const { return numSpilled * numPerSegment; }
+      size_t memory_bytes() const { return numBuffers * segmentBytes;  }
+
+   private:
+
+      // the top segment is full: start another, spilling if need be
+      void pushSegment();
+
+      // the top segment is down to its last element: pop it and go down
+      // to the one below
+      void popSegment();
+
+      // write the bottom segment in memory to the file
+      void spillBottom();
+
+      // start reading the segment below those in memory
+      void prefetch();
+
+      // wait for the read or write in flight and put its buffer away
+      void finishPending();
+
+      // a buffer for a segment: a spare, the last one spilled, or a new one
+      T* takeBuffer();
+
+      int fileDescriptor();
+
+      size_t segmentBytes;
+      size_t numPerSegment;
+      size_t maxResident;                 // segments in memory, the top one included
+      custom::vector<T*> resident;        // bottom to top, in memory
+      custom::vector<T*> spare;           // buffers not holding anything
+      T*     topSegment;                  // resident.back(), or nullptr
+      size_t numTop;                      // elements in the top segment
+      size_t numElements;
+      size_t numSpilled;                  // segments in the file, all full
+      size_t numClean;                    // bottom resident segments the file still matches
+      size_t numBuffers;                  // buffers allocated
+
+      T*     lastSpilled;                 // holds segment numSpilled - 1, until reused
+      std::future<void> pending;          // the read or write in flight
+      T*     pendingBuffer;
+      bool   pendingIsSpill;
+
+      std::FILE* file;                    // created on the first spill
+   };
+
+   /*****************************************
+    * SPILLING STACK :: CONSTRUCTOR
+    * Keep at most budgetBytes of segments: the ones in memory,
+    * plus one being read or written and the last one spilled
+    ****************************************/
+   template <class T>
+   spilling_stack<T>::spilling_stack(size_t budgetBytes, size_t segmentBytes) :
+      numTop(0), numElements(0), numSpilled(0), numClean(0), numBuffers(0),
+      lastSpilled(nullptr), pendingBuffer(nullptr), pendingIsSpill(false), file(nullptr)
+   {
+      numPerSegment = segmentBytes / sizeof(T);
+      if (numPerSegment == 0)
+         numPerSegment = 1;
+      this->segmentBytes = numPerSegment * sizeof(T);
+      maxResident = budgetBytes / this->segmentBytes;
+      maxResident = maxResident > 4 ? maxResident - 2 : 2;
+
+      // start with a full, imaginary top segment so the first push makes a real one
+      topSegment = nullptr;
+      numTop = numPerSegment;
+   }
+
+   /*****************************************
+    * SPILLING STACK :: DESTRUCTOR
+    ****************************************/
+   template <class T>
+   spilling_stack<T>::~spilling_stack()
+   {
+      if (pending.valid())
+         pending.wait();
+      if (pendingBuffer)
+         ::operator delete(pendingBuffer);
+      if (lastSpilled)
+         ::operator delete(lastSpilled);
+      for (size_t i = 0; i < resident.size(); i++)
+         ::operator delete(resident[i]);
+      for (size_t i = 0; i < spare.size(); i++)
+         ::operator delete(spare[i]);
+      if (file)
+         std::fclose(file);
+   }
+
+   /*****************************************
+    * SPILLING STACK :: CLEAR
+    * Empty the stack, keeping the buffers for later
+    ****************************************/
+   template <class T>
+   void spilling_stack<T>::clear()
+   {
+      finishPending();
+      for (size_t i = 0; i < resident.size(); i++)
+         spare.push_back(resident[i]);
+      resident.clear();
+      if (lastSpilled)
+         spare.push_back(lastSpilled);
+      lastSpilled = nullptr;
+      topSegment = nullptr;
+      numTop = numPerSegment;
+      numElements = 0;
+      numSpilled = 0;
+      numClean = 0;
+   }
+
+   /*****************************************
+    * SPILLING STACK :: PUSH SEGMENT
+    ****************************************/
+   template <class T>
+   void spilling_stack<T>::pushSegment()
+   {
+      // a segment being read in will be resident too.  Usually one spill
+      // makes room, but not after a failed write put its segment back
+      while (resident.size() + (pending.valid() && !pendingIsSpill ? 1 : 0) >= maxResident)
+         spillBottom();
+      topSegment = takeBuffer();
+      resident.push_back(topSegment);
+      numTop = 0;
+   }
+
+   /*****************************************
+    * SPILLING STACK :: POP SEGMENT
+    * The segment below becomes the top.  If it is on disk we
+    * have to wait for it, before anything changes so a failed
+    * read leaves the pop undone.  If we are getting close to
+    * the ones on disk, start reading the next so it is here
+    * in time.
+    ****************************************/
+   template <class T>
+   void spilling_stack<T>::popSegment()
+   {
+      if (resident.size() == 1)
+      {
+         if (!pending.valid() || pendingIsSpill)
+            prefetch();
+         finishPending();
+      }
+      assert(resident.size() >= 2);
+
+      spare.push_back(resident.back());
+      resident.pop_back();
+      numElements--;
+
+      topSegment = resident.back();
+      numTop = numPerSegment;
+      if (numClean >= resident.size())
+         numClean = resident.size() - 1;     // the top is about to change
+
+      if (resident.size() <= 2 && numSpilled != 0 && !pending.valid())
+         prefetch();
+   }
+
+   /*****************************************
+    * SPILLING STACK :: SPILL BOTTOM
+    * If the file already has this segment, just let the buffer
+    * go; otherwise write it out in the background
+    ****************************************/
+   template <class T>
+   void spilling_stack<T>::spillBottom()
+   {
+      finishPending();
+      T* buffer = resident[0];
+      size_t segment = numSpilled;
+
+      if (numClean != 0)
+      {
+         if (lastSpilled)
+            spare.push_back(lastSpilled);
+         lastSpilled = buffer;
+         resident.erase(resident.begin());
+         numSpilled++;
+         numClean--;
+         return;
+      }
+
+      // nothing is counted as spilled until the write is under way
+      int fd = fileDescriptor();
+      size_t numBytes = segmentBytes;
+      pending = std::async(std::launch::async, [fd, buffer, numBytes, segment]() {
+         fd::write_at(fd, buffer, numBytes, (unsigned long long)segment * numBytes);
+         });
+      pendingBuffer = buffer;
+      pendingIsSpill = true;
+      resident.erase(resident.begin());
+      numSpilled++;
+   }
+
+   /*****************************************
+    * SPILLING STACK :: PREFETCH
+    * The last segment spilled may still be in memory; if not,
+    * read it in the background
+    ****************************************/
+   template <class T>
+   void spilling_stack<T>::prefetch()
+   {
+      assert(numSpilled != 0);
+      finishPending();
+      size_t segment = numSpilled - 1;
+
+      if (lastSpilled)
+      {
+         resident.insert(resident.begin(), lastSpilled);
+         lastSpilled = nullptr;
+         numSpilled--;
+         numClean++;
+         return;
+      }
+
+      int fd = fileDescriptor();
+      size_t numBytes = segmentBytes;
+      T* buffer = takeBuffer();
+      try
+      {
+         pending = std::async(std::launch::async, [fd, buffer, numBytes, segment]() {
+            size_t numRead = fd::read_at(fd, buffer, numBytes, (unsigned long long)segment * numBytes);
+            if (numRead != numBytes)
+               throw std::system_error(EIO, std::generic_category(), "spilling_stack: segment missing");
+            });
+      }
+      catch (...)
+      {
+         spare.push_back(buffer);
+         throw;
+      }
+      pendingBuffer = buffer;
+      pendingIsSpill = false;
+      numSpilled--;
+   }
+
+   /*****************************************
+    * SPILLING STACK :: FINISH PENDING
+    * A written buffer becomes the last one spilled; a read one
+    * goes under the others in memory.  If the write failed, the
+    * segment is not on disk, so it goes back under the others;
+    * if the read failed, it is still on disk and will be read
+    * again.
+    ****************************************/
+   template <class T>
+   void spilling_stack<T>::finishPending()
+   {
+      if (!pending.valid())
+         return;
+      T* buffer = pendingBuffer;
+      pendingBuffer = nullptr;
+      try
+      {
+         pending.get();
+      }
+      catch (...)
+      {
+         if (pendingIsSpill)
+         {
+            assert(numClean == 0);        // we only write what the file lacks
+            resident.insert(resident.begin(), buffer);
+            numSpilled--;
+         }
+         else
+         {
+            spare.push_back(buffer);
+            numSpilled++;
+         }
+         throw;
+      }
+
+      if (pendingIsSpill)
+      {
+         if (lastSpilled)
+            spare.push_back(lastSpilled);
+         lastSpilled = buffer;
+      }
+      else
+      {
+         resident.insert(resident.begin(), buffer);
+         numClean++;
+      }
+   }
+
+   /*****************************************
+    * SPILLING STACK :: TAKE BUFFER
+    ****************************************/
+   template <class T>
+   T* spilling_stack<T>::takeBuffer()
+   {
+      if (!spare.empty())
+      {
+         T* buffer = spare.back();
+         spare.pop_back();
+         return buffer;
+      }
+      if (lastSpilled)
+      {
+         T* buffer = lastSpilled;
+         lastSpilled = nullptr;
+         return buffer;
+      }
+      numBuffers++;
+      return static_cast<T*>(::operator new(segmentBytes));
+   }
+
+   /*****************************************
+    * SPILLING STACK :: FILE DESCRIPTOR
+    * The scratch file, made the first time we need it.  It
+    * goes away by itself when closed.
+    ****************************************/
+   template <class T>
+   int spilling_stack<T>::fileDescriptor()
+   {
+      if (file == nullptr)
+      {
+         file = std::tmpfile();
+         if (file == nullptr)
+            throw std::system_error(errno, std::generic_category(), "spilling_stack: tmpfile");
+      }
+#ifdef _WIN32
+      return _fileno(file);
+#else
+      return fileno(file);
+#endif
+   }
+
+} // custom namespace
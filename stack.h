@@ -12,6 +12,12 @@
  *
  *    This will contain the class definition of:
  *       stack             : similar to std::stack
+ *       pmr::stack        : stack over a std::pmr::memory_resource
+ *
+ *    A stack made with a sizing_hint reserves what the hint suggests
+ *    and stores nothing of it.  To also tell the hint how big the stack
+ *    got, use hinted_stack (hinted_stack.h), so a stack that does not
+ *    pays nothing.
  * Author
  *    Brack Hoskins
  *    Nathan Bird
@@ -20,9 +26,14 @@
 #pragma once
 
 #include <cassert>  // because I am paranoid
+#include <memory>   // for std::uses_allocator
+#include <type_traits>  // for std::enable_if, std::is_trivially_copyable
+#include "fd_io.h"
+#include "sizing_hint.h"
 #include "vector.h"
 
 class TestStack; // forward declaration for unit tests
+class TestHintedStack;
 
 namespace custom
 {
@@ -35,6 +46,7 @@ namespace custom
    class stack
    {
       friend class ::TestStack; // give unit tests access to private members
+      friend class ::TestHintedStack;
    public:
 
       //
@@ -42,26 +54,36 @@ namespace custom
       //
 
       stack() {}
-      stack(const stack<T>& rhs) : container(rhs.container) {}
-      stack(stack<T>&& rhs) : container(std::move(rhs.container)) {}
+      stack(const stack& rhs) : container(rhs.container) {}
+      stack(stack&& rhs) : container(std::move(rhs.container)) {}
       stack(const Container& rhs) : container(rhs) {}
       stack(Container&& rhs) : container(std::move(rhs)) {}
+      explicit stack(const sizing_hint& hint)
+      {
+         reserve(container, hint.suggested(), 0);
+      }
       ~stack() {}
 
+      // as std::stack: hand an allocator (or a memory resource) to the container
+      template <class Alloc, class = typename std::enable_if<std::uses_allocator<Container, Alloc>::value>::type>
+      explicit stack(const Alloc& a) : container(a) {}
+      template <class Alloc, class = typename std::enable_if<std::uses_allocator<Container, Alloc>::value>::type>
+      stack(const stack& rhs, const Alloc& a) : container(rhs.container, a) {}
+
       //
       // Assign
       //
-      stack<T>& operator = (const stack<T>& rhs)
+      stack& operator = (const stack& rhs)
       {
          container = rhs.container;
          return *this;
       }
-      stack<T>& operator = (stack<T>&& rhs)
+      stack& operator = (stack&& rhs)
       {
          container = std::move(rhs.container);
          return *this;
       }
-      void swap(stack<T>& rhs)
+      void swap(stack& rhs)
       {
          std::swap(container, rhs.container);
       }
@@ -92,6 +114,12 @@ namespace custom
          container.push_back(std::move(t));
       }
 
+      // push up to num elements read from a file descriptor, bottom first
+      size_t read_from(int fd, size_t num)
+      {
+         return readFrom(container, fd, num, 0);
+      }
+
       //
       // Remove
       //
@@ -100,6 +128,14 @@ namespace custom
       {
          container.pop_back();
       }
+      void pop_n(size_t num)
+      {
+         pop_to(num < size() ? size() - num : 0);
+      }
+      void pop_to(size_t newSize)
+      {
+         truncate(container, newSize, 0);
+      }
 
       //
       // Status
@@ -108,11 +144,135 @@ namespace custom
       size_t size () const { return container.size(); }
       bool   empty() const { return container.empty(); }
 
+      //
+      // Output
+      //
+
+      // write every element, bottom first, to a file descriptor
+      size_t write_to(int fd) const
+      {
+         return writeTo(container, fd, 0);
+      }
+
    private:
 
+      // reserve if the container can (std::deque cannot)
+      template <class C>
+      static auto reserve(C& c, size_t num, int) -> decltype(c.reserve(num))
+      {
+         return c.reserve(num);
+      }
+      template <class C>
+      static void reserve(C&, size_t, long) {}
+
+      // a container that can do its own I/O does it; otherwise write
+      // its contiguous runs with one writev, and read a block at a time
+      template <class C>
+      static auto writeTo(const C& c, int fd, int) -> decltype(c.write_to(fd))
+      {
+         return c.write_to(fd);
+      }
+      template <class C>
+      static size_t writeTo(const C& c, int fd, long);
+      template <class C>
+      static auto readFrom(C& c, int fd, size_t num, int) -> decltype(c.read_from(fd, num))
+      {
+         return c.read_from(fd, num);
+      }
+      template <class C>
+      static size_t readFrom(C& c, int fd, size_t num, long);
+
+      // drop everything above newSize in one pass if the container can,
+      // otherwise fall back on one pop_back() at a time
+      template <class C>
+      static auto truncate(C& c, size_t newSize, int) -> decltype(c.truncate(newSize))
+      {
+         return c.truncate(newSize);
+      }
+      template <class C>
+      static void truncate(C& c, size_t newSize, long)
+      {
+         while (c.size() > newSize)
+            c.pop_back();
+      }
+
       Container container;  // underlying container (probably a vector)
    };
 
+   /*****************************************
+    * STACK :: WRITE TO
+    * The container is not one block, but it may be a few big
+    * ones (std::deque is): find where each run of neighbors ends
+    * and hand all the runs to writev at once
+    ****************************************/
+   template <class T, class Container>
+   template <class C>
+   size_t stack <T, Container> ::writeTo(const C& c, int fd, long)
+   {
+      static_assert(std::is_trivially_copyable<T>::value,
+                    "write_to copies bytes, so T must be trivially copyable");
+      custom::vector<fd::segment> segments;
+      for (size_t i = 0; i < c.size(); i++)
+      {
+         const T* p = &c[i];
+         if (!segments.empty() &&
+             static_cast<const char*>(segments.back().data) + segments.back().size ==
+             reinterpret_cast<const char*>(p))
+            segments.back().size += sizeof(T);
+         else
+            segments.push_back(fd::segment{ p, sizeof(T) });
+      }
+      if (!segments.empty())
+         fd::write(fd, &segments[0], segments.size());
+      return c.size();
+   }
+
+   /*****************************************
+    * STACK :: READ FROM
+    * Read into a block, then push what arrived, until we have
+    * num or the file ends.  If the block's read throws, what it
+    * kept is pushed first: the file has moved past it
+    ****************************************/
+   template <class T, class Container>
+   template <class C>
+   size_t stack <T, Container> ::readFrom(C& c, int fd, size_t num, long)
+   {
+      const size_t NUM_BLOCK = 4096;
+      custom::vector<T> block;
+      size_t numRead = 0;
+      while (numRead < num)
+      {
+         block.clear();
+         size_t numBlock;
+         try
+         {
+            numBlock = block.read_from(fd, num - numRead < NUM_BLOCK ? num - numRead : NUM_BLOCK);
+         }
+         catch (...)
+         {
+            for (size_t i = 0; i < block.size(); i++)
+               c.push_back(block[i]);
+            throw;
+         }
+         if (numBlock == 0)
+            break;
+         for (size_t i = 0; i < numBlock; i++)
+            c.push_back(block[i]);
+         numRead += numBlock;
+      }
+      return numRead;
+   }
+
+   namespace pmr
+   {
+      /**************************************************
+       * PMR STACK
+       * A stack that gets its memory from a std::pmr::memory_resource
+       *************************************************/
+      template <class T>
+      using stack = custom::stack<T, custom::pmr::vector<T>>;
+   }
+
 } // custom namespace
 
 
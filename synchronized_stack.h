@@ -0,0 +1,320 @@
+/***********************************************************************
+ * Module:
+ *    Synchronized Stack
+ * Summary:
+ *    A stack that threads share, where a consumer can block until
+ *    something is pushed
+ *      __      __     _______        __
+ *     /  |    /  |   |  _____|   _  / /
+ *     `| |    `| |   | |____    (_)/ /
+ *      | |     | |   '_.____''.   / / _
+ *     _| |_   _| |_  | \____) |  / / (_)
+ *    |_____| |_____|  \______.' /_/
+ *
+ *    This will contain the class definition of:
+ *       spinlock              : test-and-test-and-set with backoff
+ *       ticket_lock           : first come, first served spinning
+ *       mutex_policy          : lock with std::mutex
+ *       spinlock_policy       : lock with spinlock
+ *       ticket_lock_policy    : lock with ticket_lock
+ *       synchronized_stack    : stack + lock + condition variable
+ *
+ *    A lock policy names the lock and the condition variable that goes
+ *    with it.  std::mutex pairs with std::condition_variable; the
+ *    spinning locks need std::condition_variable_any.  Pushing only
+ *    notifies when a consumer is actually waiting, and push_bulk
+ *    notifies once for the whole batch.
+ * Author
+ *    Nathan Bird
+ *    Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>              // for std::atomic
+#include <cassert>             // because I am paranoid
+#include <chrono>              // for std::chrono::duration
+#include <condition_variable>  // for std::condition_variable
+#include <mutex>               // for std::mutex, std::unique_lock
+#include <thread>              // for std::this_thread::yield
+#include <utility>             // for std::move
+#include "stack.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>         // for _mm_pause
+#define CUSTOM_SYNC_PAUSE() _mm_pause()
+#else
+#define CUSTOM_SYNC_PAUSE() ((void)0)
+#endif
+
+class TestSynchronizedStack; // forward declaration for unit tests
+
+namespace custom
+{
+
+   /**************************************************
+    * SPINLOCK
+    * Spin on a plain load so waiters do not bounce the cache
+    * line, pausing twice as long after every failed attempt
+    * and yielding the thread once that gets long
+    *************************************************/
+   class spinlock
+   {
+   public:
+      spinlock() : locked(false) {}
+      spinlock(const spinlock&) = delete;
+      spinlock& operator = (const spinlock&) = delete;
+
+      void lock()
+      {
+         unsigned int numPause = 1;
+         while (locked.exchange(true, std::memory_order_acquire))
+         {
+            while (locked.load(std::memory_order_relaxed))
+            {
+               if (numPause <= MAX_PAUSE)
+               {
+                  for (unsigned int i = 0; i < numPause; i++)
+                     CUSTOM_SYNC_PAUSE();
+                  numPause *= 2;
+               }
+               else
+                  std::this_thread::yield();
+            }
+         }
+      }
+      bool try_lock()
+      {
+         return !locked.load(std::memory_order_relaxed) &&
+                !locked.exchange(true, std::memory_order_acquire);
+      }
+      void unlock()
+      {
+         locked.store(false, std::memory_order_release);
+      }
+
+   private:
+      static const unsigned int MAX_PAUSE = 64;  // then yield instead
+      std::atomic<bool> locked;
+   };
+
+   /**************************************************
+    * TICKET LOCK
+    * Take a number and wait until it is served: threads get
+    * the lock in the order they asked for it
+    *************************************************/
+   class ticket_lock
+   {
+      friend class ::TestSynchronizedStack;
+   public:
+      ticket_lock() : next(0), serving(0) {}
+      ticket_lock(const ticket_lock&) = delete;
+      ticket_lock& operator = (const ticket_lock&) = delete;
+
+      void lock()
+      {
+         unsigned int ticket = next.fetch_add(1, std::memory_order_relaxed);
+         for (unsigned int numSpins = 0; ; numSpins++)
+         {
+            unsigned int ahead = ticket - serving.load(std::memory_order_acquire);
+            if (ahead == 0)
+               return;
+            // pause in proportion to the line ahead of us for a while, then
+            // yield: the next ticket may belong to a thread that is not running
+            if (numSpins < MAX_SPIN && ahead < 8)
+               for (unsigned int i = 0; i < ahead * 16; i++)
+                  CUSTOM_SYNC_PAUSE();
+            else
+               std::this_thread::yield();
+         }
+      }
+      bool try_lock()
+      {
+         // acquire on serving, which unlock() releases: taking a ticket
+         // from next orders nothing after the last holder's writes
+         unsigned int ticket = serving.load(std::memory_order_acquire);
+         return next.compare_exchange_strong(ticket, ticket + 1, std::memory_order_relaxed);
+      }
+      void unlock()
+      {
+         serving.store(serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+      }
+
+   private:
+      static const unsigned int MAX_SPIN = 4;   // then yield instead
+      std::atomic<unsigned int> next;      // the next ticket to hand out
+      std::atomic<unsigned int> serving;   // the ticket holding the lock
+   };
+
+   /**************************************************
+    * LOCK POLICIES
+    * Which lock, and which condition variable works with it
+    *************************************************/
+   struct mutex_policy
+   {
+      using mutex_type     = std::mutex;
+      using condition_type = std::condition_variable;
+   };
+   struct spinlock_policy
+   {
+      using mutex_type     = spinlock;
+      using condition_type = std::condition_variable_any;
+   };
+   struct ticket_lock_policy
+   {
+      using mutex_type     = ticket_lock;
+      using condition_type = std::condition_variable_any;
+   };
+
+   /**************************************************
+    * SYNCHRONIZED STACK
+    * First-in-Last-out, safe to share between threads, and
+    * consumers can wait for an element
+    *************************************************/
+   template <class T, class Container = custom::vector<T>, class LockPolicy = mutex_policy>
+   class synchronized_stack
+   {
+      friend class ::TestSynchronizedStack; // give unit tests access to private members
+
+      using mutex_type     = typename LockPolicy::mutex_type;
+      using condition_type = typename LockPolicy::condition_type;
+      using lock_type      = std::unique_lock<mutex_type>;
+
+   public:
+
+      //
+      // Construct
+      //
+
+      synchronized_stack() : numWaiting(0) {}
+      synchronized_stack(const synchronized_stack& rhs) = delete;
+      synchronized_stack& operator = (const synchronized_stack& rhs) = delete;
+
+      //
+      // Insert
+      //
+
+      void push(const T& t)
+      {
+         lock_type guard(lock);
+         items.push(t);
+         wakeOne(guard);
+      }
+      void push(T&& t)
+      {
+         lock_type guard(lock);
+         items.push(std::move(t));
+         wakeOne(guard);
+      }
+      template <class Iterator>
+      void push_bulk(Iterator first, Iterator last);
+
+      //
+      // Remove
+      //
+
+      bool try_pop(T& t)
+      {
+         lock_type guard(lock);
+         if (items.empty())
+            return false;
+         take(t);
+         return true;
+      }
+      T pop_wait();
+      template <class Rep, class Period>
+      bool pop_for(T& t, const std::chrono::duration<Rep, Period>& timeout);
+
+      //
+      // Status
+      //
+
+      size_t size() const
+      {
+         lock_type guard(lock);
+         return items.size();
+      }
+      bool empty() const { return size() == 0; }
+
+   private:
+
+      // move the top element out; the lock must be held
+      void take(T& t)
+      {
+         t = std::move(items.top());
+         items.pop();
+      }
+
+      // after one push: wake one consumer, if any is waiting
+      void wakeOne(lock_type& guard)
+      {
+         bool anyWaiting = numWaiting != 0;
+         guard.unlock();
+         if (anyWaiting)
+            ready.notify_one();
+      }
+
+      mutable mutex_type          lock;
+      condition_type              ready;        // signalled when an element arrives
+      custom::stack<T, Container> items;
+      size_t                      numWaiting;   // consumers blocked in pop_wait or pop_for
+   };
+
+   /*****************************************
+    * SYNCHRONIZED STACK :: PUSH BULK
+    * Push a whole batch under one lock, then wake the
+    * consumers with one notification
+    ****************************************/
+   template <class T, class Container, class LockPolicy>
+   template <class Iterator>
+   void synchronized_stack<T, Container, LockPolicy>::push_bulk(Iterator first, Iterator last)
+   {
+      lock_type guard(lock);
+      size_t numPushed = 0;
+      for (Iterator it = first; it != last; ++it, ++numPushed)
+         items.push(*it);
+      size_t numToWake = numWaiting < numPushed ? numWaiting : numPushed;
+      guard.unlock();
+
+      if (numToWake == 1)
+         ready.notify_one();
+      else if (numToWake > 1)
+         ready.notify_all();
+   }
+
+   /*****************************************
+    * SYNCHRONIZED STACK :: POP WAIT
+    * Block until there is an element, then take the top one
+    ****************************************/
+   template <class T, class Container, class LockPolicy>
+   T synchronized_stack<T, Container, LockPolicy>::pop_wait()
+   {
+      lock_type guard(lock);
+      numWaiting++;
+      ready.wait(guard, [this]() { return !items.empty(); });
+      numWaiting--;
+      T t(std::move(items.top()));
+      items.pop();
+      return t;
+   }
+
+   /*****************************************
+    * SYNCHRONIZED STACK :: POP FOR
+    * Like pop_wait, but give up after timeout and return false
+    ****************************************/
+   template <class T, class Container, class LockPolicy>
+   template <class Rep, class Period>
+   bool synchronized_stack<T, Container, LockPolicy>::pop_for(T& t,
+                                    const std::chrono::duration<Rep, Period>& timeout)
+   {
+      lock_type guard(lock);
+      numWaiting++;
+      bool any = ready.wait_for(guard, timeout, [this]() { return !items.empty(); });
+      numWaiting--;
+      if (!any)
+         return false;
+      take(t);
+      return true;
+   }
+
+} // custom namespace
@@ -0,0 +1,240 @@
+/***********************************************************************
+ * Header:
+ *    TEST ALIGNED ALLOCATOR
+ * Summary:
+ *    Unit tests for aligned_allocator
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "aligned_allocator.h"
+#include "vector.h"
+#include "stack.h"
+#include "unitTest.h"
+
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+
+class TestAlignedAllocator : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Allocate
+      test_allocate_cacheLine();
+      test_allocate_32();
+      test_allocate_overAlignedT();
+      test_allocate_rebind();
+
+      // Good size
+      test_goodSize_padded();
+      test_goodSize_oddSize();
+      test_goodSize_notPadded();
+
+      // Vector and stack
+      test_vector_alignedEveryGrowth();
+      test_vector_capacityPadded();
+      test_vector_capacityPaddedEveryWay();
+      test_vector_overAlignedDefault();
+      test_stack_aligned();
+
+      report("AlignedAllocator");
+   }
+
+   // an element that asks for more than a cache line
+   struct alignas(128) Wide
+   {
+      int value;
+   };
+
+   static bool isAligned(const void* p, size_t alignment)
+   {
+      return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+   }
+
+   /***************************************
+    * ALLOCATE
+    ***************************************/
+
+   // by default, blocks start on a cache line
+   void test_allocate_cacheLine()
+   {  // setup
+      custom::aligned_allocator<char> a;
+      // exercise
+      char* p1 = a.allocate(1);
+      char* p2 = a.allocate(100);
+      // verify
+      assertUnit(isAligned(p1, 64));
+      assertUnit(isAligned(p2, 64));
+      // teardown
+      a.deallocate(p1, 1);
+      a.deallocate(p2, 100);
+   }
+
+   // any power of two can be asked for
+   void test_allocate_32()
+   {  // setup
+      custom::aligned_allocator<double, 32> a;
+      // exercise
+      double* p = a.allocate(3);
+      // verify
+      assertUnit((custom::aligned_allocator<double, 32>::ALIGNMENT == 32));
+      assertUnit(isAligned(p, 32));
+      // teardown
+      a.deallocate(p, 3);
+   }
+
+   // an element more aligned than asked for gets what it needs
+   void test_allocate_overAlignedT()
+   {  // setup
+      custom::aligned_allocator<Wide> a;
+      // exercise
+      Wide* p = a.allocate(3);
+      // verify
+      assertUnit(custom::aligned_allocator<Wide>::ALIGNMENT == 128);
+      assertUnit(isAligned(p, 128));
+      assertUnit(isAligned(p + 1, 128));
+      // teardown
+      a.deallocate(p, 3);
+   }
+
+   // rebinding keeps the alignment and the padding
+   void test_allocate_rebind()
+   {  // setup
+      using ints = custom::aligned_allocator<int, 32, false>;
+      // exercise
+      using doubles = std::allocator_traits<ints>::rebind_alloc<double>;
+      doubles a{ ints() };
+      // verify
+      assertUnit((std::is_same<doubles, custom::aligned_allocator<double, 32, false>>::value));
+      assertUnit(a == ints());
+   }  // teardown
+
+   /***************************************
+    * GOOD SIZE
+    ***************************************/
+
+   // a block is whole lines, so it holds up to the end of the last one
+   void test_goodSize_padded()
+   {  // setup
+      custom::aligned_allocator<float> a;
+      // exercise
+      // verify
+      assertUnit(a.good_size(1) == 16);
+      assertUnit(a.good_size(16) == 16);
+      assertUnit(a.good_size(17) == 32);
+   }  // teardown
+
+   // elements that do not divide a line fill as many as fit
+   void test_goodSize_oddSize()
+   {  // setup
+      struct Twelve { int a, b, c; };
+      custom::aligned_allocator<Twelve> a;
+      // exercise
+      // verify
+      assertUnit(a.good_size(1) == 5);
+      assertUnit(a.good_size(6) == 10);
+   }  // teardown
+
+   // without padding, what was asked for
+   void test_goodSize_notPadded()
+   {  // setup
+      custom::aligned_allocator<float, 64, false> a;
+      // exercise
+      // verify
+      assertUnit(a.good_size(1) == 1);
+      assertUnit(a.good_size(17) == 17);
+   }  // teardown
+
+   /***************************************
+    * VECTOR AND STACK
+    ***************************************/
+
+   // the buffer stays aligned as it moves
+   void test_vector_alignedEveryGrowth()
+   {  // setup
+      custom::vector<float, custom::aligned_allocator<float>> v;
+      // exercise
+      bool aligned = true;
+      for (int i = 0; i < 10000; i++)
+      {
+         v.push_back((float)i);
+         if (!isAligned(&v[0], 64))
+            aligned = false;
+      }
+      // verify
+      assertUnit(aligned);
+      assertUnit(v[9999] == 9999.0f);
+   }  // teardown
+
+   // the vector's capacity takes in the padding
+   void test_vector_capacityPadded()
+   {  // setup
+      custom::vector<float, custom::aligned_allocator<float>> v;
+      // exercise
+      v.reserve(20);
+      // verify
+      assertUnit(v.capacity() == 32);
+      v.push_back(1.0f);
+      assertUnit(v.capacity() == 32);
+   }  // teardown
+
+   // however the vector is made, its capacity takes in the padding
+   void test_vector_capacityPaddedEveryWay()
+   {  // setup
+      using aligned = custom::vector<float, custom::aligned_allocator<float>>;
+      aligned source(20, 1.0f);
+      // exercise
+      aligned fill(1000, 2.0f);
+      aligned sized(1000);
+      aligned list{ 1.0f, 2.0f, 3.0f };
+      aligned copy(source);
+      aligned assigned;
+      assigned = source;
+      aligned shrunk(10);
+      shrunk.reserve(100);
+      shrunk.shrink_to_fit();
+      // verify
+      assertUnit(source.capacity() == 32);
+      assertUnit(fill.capacity() == 1008);
+      assertUnit(sized.capacity() == 1008);
+      assertUnit(list.capacity() == 16);
+      assertUnit(copy.capacity() == 32);
+      assertUnit(assigned.capacity() == 32);
+      assertUnit(shrunk.capacity() == 16);
+      assertUnit(isAligned(&shrunk[0], 64));
+   }  // teardown
+
+   // the default allocator gives over-aligned elements their due too
+   void test_vector_overAlignedDefault()
+   {  // setup
+      custom::vector<Wide> v;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         v.push_back(Wide{ i });
+      // verify
+      assertUnit(isAligned(&v[0], 128));
+      assertUnit(v[99].value == 99);
+   }  // teardown
+
+   // a stack over an aligned vector
+   void test_stack_aligned()
+   {  // setup
+      custom::stack<float, custom::vector<float, custom::aligned_allocator<float>>> s;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         s.push((float)i);
+      // verify
+      assertUnit(isAligned(&s.top() - 99, 64));
+      assertUnit(s.top() == 99.0f);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,367 @@
+/***********************************************************************
+ * Header:
+ *    TEST ASYNC STACK
+ * Summary:
+ *    Unit tests for async_stack and its executors.  These only run
+ *    when the compiler has coroutines.
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#include "async_stack.h"
+
+#if defined(DEBUG) && defined(__cpp_impl_coroutine)
+#include "unitTest.h"
+#include "spy.h"
+
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+class TestAsyncStack : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Remove
+      test_pop_ready();
+      test_pop_suspends();
+      test_pop_lifo();
+
+      // Insert
+      test_push_noWaiter();
+      test_push_resumesWaiter();
+      test_push_waitersInOrder();
+      test_push_inline();
+      test_pushRange_batch();
+      test_pushRange_leftover();
+
+      // Executors
+      test_manual_runNested();
+      test_scheduleOn_manual();
+      test_threadPool_consumers();
+
+      report("AsyncStack");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // nothing stored, nobody waiting
+   void test_construct_default()
+   {  // setup
+      Spy::reset();
+      // exercise
+      custom::async_stack<Spy> s;
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(s.empty());
+      assertUnit(s.ex == nullptr);
+      assertUnit(s.first == nullptr);
+      assertUnit(s.num_waiting() == 0);
+   }  // teardown
+
+   /***************************************
+    * POP ASYNC
+    ***************************************/
+
+   // a consumer that pops from a non-empty stack never suspends
+   void test_pop_ready()
+   {  // setup
+      custom::async_stack<int> s;
+      s.push(26);
+      int got = 0;
+      // exercise
+      consume(s, got);
+      // verify
+      assertUnit(got == 26);
+      assertUnit(s.empty());
+      assertUnit(s.num_waiting() == 0);
+   }  // teardown
+
+   // a consumer that pops from an empty stack waits
+   void test_pop_suspends()
+   {  // setup
+      custom::manual_executor ex;
+      custom::async_stack<int> s(&ex);
+      int got = 0;
+      // exercise
+      consume(s, got);
+      // verify
+      assertUnit(got == 0);
+      assertUnit(s.num_waiting() == 1);
+      assertUnit(s.first != nullptr);
+      assertUnit(ex.size() == 0);
+      s.push(49);          // teardown: let it finish
+      ex.run();
+      assertUnit(got == 49);
+   }  // teardown
+
+   // elements come out last in, first out
+   void test_pop_lifo()
+   {  // setup
+      custom::async_stack<int> s;
+      s.push(1);
+      s.push(2);
+      s.push(3);
+      int got[3] = {};
+      // exercise
+      consume(s, got[0]);
+      consume(s, got[1]);
+      consume(s, got[2]);
+      // verify
+      assertUnit(got[0] == 3);
+      assertUnit(got[1] == 2);
+      assertUnit(got[2] == 1);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // with nobody waiting, push just stores the element
+   void test_push_noWaiter()
+   {  // setup
+      custom::manual_executor ex;
+      custom::async_stack<Spy> s(&ex);
+      Spy::reset();
+      // exercise
+      s.push(Spy(67));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(s.size() == 1);
+      assertUnit(ex.size() == 0);
+      int value = 0;
+      assertUnit(tryPopSpy(s, value) && value == 67);
+   }  // teardown
+
+   // push hands the element straight to the waiter and schedules it
+   void test_push_resumesWaiter()
+   {  // setup
+      custom::manual_executor ex;
+      custom::async_stack<int> s(&ex);
+      int got = 0;
+      consume(s, got);
+      // exercise
+      s.push(89);
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.num_waiting() == 0);
+      assertUnit(ex.size() == 1);
+      assertUnit(got == 0);     // not until the executor runs it
+      ex.run();
+      assertUnit(got == 89);
+   }  // teardown
+
+   // the longest waiter is served first
+   void test_push_waitersInOrder()
+   {  // setup
+      custom::manual_executor ex;
+      custom::async_stack<int> s(&ex);
+      int got[2] = {};
+      consume(s, got[0]);
+      consume(s, got[1]);
+      // exercise
+      s.push(10);
+      s.push(20);
+      ex.run();
+      // verify
+      assertUnit(got[0] == 10);
+      assertUnit(got[1] == 20);
+   }  // teardown
+
+   // with no executor the waiter runs inside push
+   void test_push_inline()
+   {  // setup
+      custom::async_stack<int> s;
+      int got = 0;
+      consume(s, got);
+      // exercise
+      s.push(5);
+      // verify
+      assertUnit(got == 5);
+      assertUnit(s.num_waiting() == 0);
+   }  // teardown
+
+   // one batch wakes every waiter it can with one call to the executor
+   void test_pushRange_batch()
+   {  // setup
+      CountingExecutor ex;
+      custom::async_stack<int> s(&ex);
+      int got[3] = {};
+      for (int i = 0; i < 3; i++)
+         consume(s, got[i]);
+      int values[] = { 1, 2, 3 };
+      // exercise
+      s.push_range(values, values + 3);
+      // verify
+      assertUnit(ex.numCalls == 1);
+      assertUnit(ex.size() == 3);
+      assertUnit(s.num_waiting() == 0);
+      ex.run();
+      assertUnit(got[0] == 3);
+      assertUnit(got[1] == 2);
+      assertUnit(got[2] == 1);
+   }  // teardown
+
+   // more elements than waiters: the rest stay on the stack
+   void test_pushRange_leftover()
+   {  // setup
+      CountingExecutor ex;
+      custom::async_stack<int> s(&ex);
+      int got = 0;
+      consume(s, got);
+      int values[] = { 1, 2, 3, 4 };
+      // exercise
+      s.push_range(values, values + 4);
+      ex.run();
+      // verify
+      assertUnit(got == 4);
+      assertUnit(ex.numCalls == 1);
+      assertUnit(s.size() == 3);
+      int value = 0;
+      assertUnit(s.try_pop(value) && value == 3);
+   }  // teardown
+
+   /***************************************
+    * EXECUTORS
+    ***************************************/
+
+   // run() keeps going while coroutines schedule more work
+   void test_manual_runNested()
+   {  // setup
+      custom::manual_executor ex;
+      custom::async_stack<int> s(&ex);
+      int got[3] = {};
+      for (int i = 0; i < 3; i++)
+         relay(s, got[i]);
+      // exercise
+      s.push(1);
+      size_t num = ex.run();
+      // verify
+      assertUnit(num == 3);
+      assertUnit(got[0] == 1);
+      assertUnit(got[1] == 2);
+      assertUnit(got[2] == 3);
+      assertUnit(s.size() == 1);
+   }  // teardown
+
+   // schedule_on moves a coroutine onto the executor
+   void test_scheduleOn_manual()
+   {  // setup
+      custom::manual_executor ex;
+      bool done = false;
+      // exercise
+      hop(ex, done);
+      // verify
+      assertUnit(!done);
+      assertUnit(ex.size() == 1);
+      ex.run();
+      assertUnit(done);
+   }  // teardown
+
+   // many consumers on a pool, one producer: every element arrives once
+   void test_threadPool_consumers()
+   {  // setup
+      const int numConsumers = 8;
+      const int numEach = 500;
+      std::atomic<int> numLeft(numConsumers);
+      std::atomic<long long> sum(0);
+      {
+         custom::thread_pool_executor ex(4);
+         custom::async_stack<int> s(&ex);
+         for (int c = 0; c < numConsumers; c++)
+            consumeMany(s, numEach, sum, numLeft);
+         // exercise
+         std::vector<int> batch;
+         for (int i = 1; i <= numConsumers * numEach; i++)
+         {
+            batch.push_back(i);
+            if (batch.size() == 7)
+            {
+               s.push_range(batch.begin(), batch.end());
+               batch.clear();
+            }
+         }
+         s.push_range(batch.begin(), batch.end());
+         while (numLeft != 0)
+            std::this_thread::yield();
+         // verify
+         assertUnit(s.empty());
+      }
+      long long n = numConsumers * numEach;
+      assertUnit(sum == n * (n + 1) / 2);
+   }  // teardown
+
+   /*************************************************************
+    * COROUTINES
+    * Small consumers for the tests above
+    *************************************************************/
+   static custom::detached_task consume(custom::async_stack<int>& s, int& got)
+   {
+      got = co_await s.pop_async();
+   }
+
+   // take one, push one bigger
+   static custom::detached_task relay(custom::async_stack<int>& s, int& got)
+   {
+      got = co_await s.pop_async();
+      s.push(got + 1);
+   }
+
+   static custom::detached_task hop(custom::executor& ex, bool& done)
+   {
+      co_await custom::schedule_on(ex);
+      done = true;
+   }
+
+   static custom::detached_task consumeMany(custom::async_stack<int>& s, int num,
+                                            std::atomic<long long>& sum,
+                                            std::atomic<int>& numLeft)
+   {
+      for (int i = 0; i < num; i++)
+         sum += co_await s.pop_async();
+      numLeft--;
+   }
+
+   bool tryPopSpy(custom::async_stack<Spy>& s, int& value)
+   {
+      Spy spy;
+      if (!s.try_pop(spy))
+         return false;
+      value = spy.get();
+      return true;
+   }
+
+   /*************************************************************
+    * COUNTING EXECUTOR
+    * A manual executor that counts how many times it is called
+    *************************************************************/
+   class CountingExecutor : public custom::manual_executor
+   {
+   public:
+      CountingExecutor() : numCalls(0) {}
+      using custom::manual_executor::schedule;
+      void schedule(const std::coroutine_handle<>* first, size_t num) override
+      {
+         numCalls++;
+         for (size_t i = 0; i < num; i++)
+            schedule(first[i]);
+      }
+      int numCalls;
+   };
+
+};
+
+#endif // DEBUG && __cpp_impl_coroutine
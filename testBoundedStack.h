@@ -0,0 +1,335 @@
+/***********************************************************************
+ * Header:
+ *    TEST BOUNDED STACK
+ * Summary:
+ *    Unit tests for bounded_stack, budget_allocator and allocation_budget
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "bounded_stack.h"
+#include "unitTest.h"
+
+#include <iostream>
+#include <cassert>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+class TestBoundedStack : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Capacity
+      test_tryPush_full();
+      test_tryPush_moveFull();
+      test_push_fullThrows();
+
+      // Watermarks
+      test_watermark_highOnce();
+      test_watermark_lowThenHighAgain();
+      test_watermark_invalid();
+      test_watermark_alreadyHigh();
+
+      // Budget
+      test_budget_takeGiveBack();
+      test_budgetAllocator_rebind();
+      test_budget_stackUsesAndReturns();
+      test_budget_stackOverThrows();
+      test_budget_tryPushFails();
+      test_budget_shared();
+
+      report("BoundedStack");
+   }
+
+   using budget_stack = custom::stack<int, custom::vector<int, custom::budget_allocator<int>>>;
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // no limit unless asked for
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::bounded_stack<int> s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(!s.full());
+      assertUnit(!s.above_high_water());
+      assertUnit(s.max_size() == std::numeric_limits<size_t>::max());
+   }  // teardown
+
+   /***************************************
+    * CAPACITY
+    ***************************************/
+
+   // a full stack turns pushes away without changing
+   void test_tryPush_full()
+   {  // setup
+      custom::bounded_stack<int> s(3);
+      // exercise
+      bool first = s.try_push(1);
+      bool second = s.try_push(2);
+      bool third = s.try_push(3);
+      bool fourth = s.try_push(4);
+      // verify
+      assertUnit(first && second && third);
+      assertUnit(!fourth);
+      assertUnit(s.full());
+      assertUnit(s.size() == 3);
+      assertUnit(s.top() == 3);
+   }  // teardown
+
+   // turning a move away leaves the element with the caller
+   void test_tryPush_moveFull()
+   {  // setup
+      custom::bounded_stack<std::string> s(1);
+      s.push("first");
+      std::string second("second");
+      // exercise
+      bool pushed = s.try_push(std::move(second));
+      // verify
+      assertUnit(!pushed);
+      assertUnit(second == "second");
+      assertUnit(s.top() == "first");
+   }  // teardown
+
+   // push says so when full
+   void test_push_fullThrows()
+   {  // setup
+      custom::bounded_stack<int> s(1);
+      s.push(1);
+      // exercise
+      bool threw = false;
+      try
+      {
+         s.push(2);
+      }
+      catch (const std::length_error&)
+      {
+         threw = true;
+      }
+      // verify
+      assertUnit(threw);
+      assertUnit(s.size() == 1);
+      assertUnit(s.top() == 1);
+   }  // teardown
+
+   /***************************************
+    * WATERMARKS
+    ***************************************/
+
+   // reaching high calls onHigh, and only the once
+   void test_watermark_highOnce()
+   {  // setup
+      custom::bounded_stack<int> s;
+      int numHigh = 0;
+      int numLow = 0;
+      s.set_watermarks(4, 1, [&]() { numHigh++; }, [&]() { numLow++; });
+      // exercise
+      for (int i = 0; i < 3; i++)
+         s.push(i);
+      bool beforeHigh = numHigh == 0 && !s.above_high_water();
+      for (int i = 0; i < 5; i++)
+         s.push(i);
+      // verify
+      assertUnit(beforeHigh);
+      assertUnit(numHigh == 1);
+      assertUnit(numLow == 0);
+      assertUnit(s.above_high_water());
+   }  // teardown
+
+   // back down to low calls onLow; then high can fire again
+   void test_watermark_lowThenHighAgain()
+   {  // setup
+      custom::bounded_stack<int> s;
+      int numHigh = 0;
+      int numLow = 0;
+      s.set_watermarks(4, 1, [&]() { numHigh++; }, [&]() { numLow++; });
+      for (int i = 0; i < 4; i++)
+         s.push(i);
+      // exercise
+      s.pop();
+      s.pop();
+      bool inBetween = numLow == 0 && s.above_high_water();
+      s.pop();
+      // verify
+      assertUnit(inBetween);
+      assertUnit(numLow == 1);
+      assertUnit(!s.above_high_water());
+      s.pop();
+      assertUnit(numLow == 1);
+      for (int i = 0; i < 4; i++)
+         s.push(i);
+      assertUnit(numHigh == 2);
+   }  // teardown
+
+   // low has to be under high
+   void test_watermark_invalid()
+   {  // setup
+      custom::bounded_stack<int> s;
+      // exercise
+      bool threw = false;
+      try
+      {
+         s.set_watermarks(2, 2, nullptr, nullptr);
+      }
+      catch (const std::invalid_argument&)
+      {
+         threw = true;
+      }
+      // verify
+      assertUnit(threw);
+   }  // teardown
+
+   // a stack already past high says so straight away
+   void test_watermark_alreadyHigh()
+   {  // setup
+      custom::bounded_stack<int> s;
+      for (int i = 0; i < 10; i++)
+         s.push(i);
+      int numHigh = 0;
+      // exercise
+      s.set_watermarks(5, 2, [&]() { numHigh++; }, nullptr);
+      // verify
+      assertUnit(numHigh == 1);
+      assertUnit(s.above_high_water());
+      while (s.size() > 2)
+         s.pop();                            // no onLow to call: fine
+      assertUnit(!s.above_high_water());
+   }  // teardown
+
+   /***************************************
+    * BUDGET
+    ***************************************/
+
+   // a budget hands out up to its limit
+   void test_budget_takeGiveBack()
+   {  // setup
+      custom::allocation_budget budget(100);
+      // exercise
+      bool first = budget.try_take(60);
+      bool second = budget.try_take(60);
+      bool third = budget.try_take(40);
+      // verify
+      assertUnit(first);
+      assertUnit(!second);
+      assertUnit(third);
+      assertUnit(budget.used_bytes() == 100);
+      budget.give_back(60);
+      assertUnit(budget.used_bytes() == 40);
+      assertUnit(budget.limit_bytes() == 100);
+   }  // teardown
+
+   // a rebound allocator draws on the same budget
+   void test_budgetAllocator_rebind()
+   {  // setup
+      custom::allocation_budget budget(1000);
+      custom::budget_allocator<int> ints(budget);
+      // exercise
+      custom::budget_allocator<double> doubles(ints);
+      double* p = doubles.allocate(10);
+      // verify
+      assertUnit(doubles == ints);
+      assertUnit(doubles.get_budget() == &budget);
+      assertUnit(budget.used_bytes() == 10 * sizeof(double));
+      assertUnit(custom::budget_allocator<int>() != ints);
+      // teardown
+      doubles.deallocate(p, 10);
+      assertUnit(budget.used_bytes() == 0);
+   }
+
+   // a stack's vector takes from the budget and gives it all back
+   void test_budget_stackUsesAndReturns()
+   {  // setup
+      custom::allocation_budget budget(1024);
+      {
+         budget_stack s{ custom::budget_allocator<int>(budget) };
+         // exercise
+         for (int i = 0; i < 10; i++)
+            s.push(i);
+         // verify
+         assertUnit(budget.used_bytes() == 16 * sizeof(int));
+         assertUnit(s.top() == 9);
+      }
+      assertUnit(budget.used_bytes() == 0);
+   }  // teardown
+
+   // going over throws std::bad_alloc and leaves the stack alone
+   void test_budget_stackOverThrows()
+   {  // setup
+      custom::allocation_budget budget(12 * sizeof(int));  // growing 4 to 8 holds 12
+      budget_stack s{ custom::budget_allocator<int>(budget) };
+      for (int i = 0; i < 8; i++)
+         s.push(i);
+      // exercise
+      bool threw = false;
+      try
+      {
+         s.push(8);
+      }
+      catch (const std::bad_alloc&)
+      {
+         threw = true;
+      }
+      // verify
+      assertUnit(threw);
+      assertUnit(s.size() == 8);
+      assertUnit(s.top() == 7);
+      assertUnit(budget.used_bytes() == 8 * sizeof(int));
+   }  // teardown
+
+   // try_push reports the budget running out as failure
+   void test_budget_tryPushFails()
+   {  // setup
+      custom::allocation_budget budget(6 * sizeof(int));   // growing 2 to 4 holds 6
+      custom::vector<int, custom::budget_allocator<int>> v{ custom::budget_allocator<int>(budget) };
+      custom::bounded_stack<int, custom::vector<int, custom::budget_allocator<int>>> s(100, v);
+      // exercise
+      int numPushed = 0;
+      while (numPushed < 100 && s.try_push(numPushed))
+         numPushed++;
+      // verify
+      assertUnit(numPushed == 4);
+      assertUnit(s.size() == 4);
+      assertUnit(!s.full());
+      assertUnit(s.top() == 3);
+   }  // teardown
+
+   // two stacks share one budget
+   void test_budget_shared()
+   {  // setup
+      custom::allocation_budget budget(14 * sizeof(int));
+      budget_stack a{ custom::budget_allocator<int>(budget) };
+      budget_stack b{ custom::budget_allocator<int>(budget) };
+      for (int i = 0; i < 8; i++)
+         a.push(i);
+      // exercise
+      for (int i = 0; i < 4; i++)
+         b.push(i);
+      bool threw = false;
+      try
+      {
+         b.push(4);
+      }
+      catch (const std::bad_alloc&)
+      {
+         threw = true;
+      }
+      // verify
+      assertUnit(threw);
+      assertUnit(budget.used_bytes() == 12 * sizeof(int));
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,336 @@
+/***********************************************************************
+ * Header:
+ *    TEST COMPACT VECTOR
+ * Summary:
+ *    Unit tests for compact_vector
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "compact_vector.h"
+#include "stack.h"
+#include "unitTest.h"
+
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+
+class TestCompactVector : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_sizeOf();
+      test_construct_sizeOfStateful();
+      test_construct_fill();
+      test_construct_initializerList();
+      test_construct_copy();
+      test_construct_move();
+
+      // Assign
+      test_assign_copy();
+      test_assign_move();
+      test_swap();
+
+      // Insert
+      test_pushBack_grows();
+      test_pushBack_strings();
+      test_reserve_pastMaxSize();
+      test_resize_growShrink();
+
+      // Remove
+      test_popBack_truncate();
+      test_shrinkToFit();
+
+      // Stack
+      test_stack_container();
+      test_stack_sizeOf();
+
+      report("CompactVector");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // nothing allocated
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::compact_vector<int> v;
+      // verify
+      assertUnit(v.data == nullptr);
+      assertUnit(v.size() == 0);
+      assertUnit(v.capacity() == 0);
+      assertUnit(v.empty());
+   }  // teardown
+
+   // a pointer and two 32-bit counts; the allocator takes no room
+   void test_construct_sizeOf()
+   {  // setup
+      // exercise
+      // verify
+      assertUnit(sizeof(custom::compact_vector<int>) == sizeof(int*) + 2 * sizeof(uint32_t));
+      assertUnit(sizeof(custom::compact_vector<int>) < sizeof(custom::vector<int>));
+      assertUnit(custom::compact_vector<int>::max_size() == 0xffffffff);
+   }  // teardown
+
+   // an allocator with something in it still has to be kept
+   void test_construct_sizeOfStateful()
+   {  // setup
+      std::pmr::monotonic_buffer_resource resource;
+      // exercise
+      custom::compact_vector<int, std::pmr::polymorphic_allocator<int>> v(&resource);
+      v.push_back(7);
+      // verify
+      assertUnit(sizeof(v) > sizeof(custom::compact_vector<int>));
+      assertUnit(v.get_allocator().resource() == &resource);
+      assertUnit(v[0] == 7);
+   }  // teardown
+
+   // num copies of a value
+   void test_construct_fill()
+   {  // setup
+      // exercise
+      custom::compact_vector<int> v(5, 42);
+      // verify
+      assertUnit(v.size() == 5);
+      assertUnit(v.capacity() == 5);
+      assertUnit(v[0] == 42);
+      assertUnit(v[4] == 42);
+   }  // teardown
+
+   // in order
+   void test_construct_initializerList()
+   {  // setup
+      // exercise
+      custom::compact_vector<int> v{ 3, 1, 4, 1, 5 };
+      // verify
+      assertUnit(v.size() == 5);
+      assertUnit(v.front() == 3);
+      assertUnit(v.back() == 5);
+   }  // teardown
+
+   // a copy has its own buffer, just big enough
+   void test_construct_copy()
+   {  // setup
+      custom::compact_vector<std::string> v{ "a", "b", "c" };
+      v.reserve(10);
+      // exercise
+      custom::compact_vector<std::string> copy(v);
+      // verify
+      assertUnit(copy.size() == 3);
+      assertUnit(copy.capacity() == 3);
+      assertUnit(copy.data != v.data);
+      assertUnit(copy[2] == "c");
+      assertUnit(v[2] == "c");
+   }  // teardown
+
+   // moving takes the buffer
+   void test_construct_move()
+   {  // setup
+      custom::compact_vector<int> v{ 1, 2, 3 };
+      int* data = v.data;
+      // exercise
+      custom::compact_vector<int> moved(std::move(v));
+      // verify
+      assertUnit(moved.data == data);
+      assertUnit(moved.size() == 3);
+      assertUnit(v.data == nullptr);
+      assertUnit(v.size() == 0);
+      assertUnit(v.capacity() == 0);
+   }  // teardown
+
+   /***************************************
+    * ASSIGN
+    ***************************************/
+
+   // a copy replaces what was there, keeping the buffer if it is big enough
+   void test_assign_copy()
+   {  // setup
+      custom::compact_vector<std::string> v{ "one", "two", "three", "four" };
+      custom::compact_vector<std::string> rhs{ "x", "y" };
+      std::string* data = v.data;
+      // exercise
+      v = rhs;
+      // verify
+      assertUnit(v.size() == 2);
+      assertUnit(v.data == data);
+      assertUnit(v[0] == "x");
+      assertUnit(v[1] == "y");
+   }  // teardown
+
+   // a move takes rhs's buffer and frees our own
+   void test_assign_move()
+   {  // setup
+      custom::compact_vector<int> v{ 1, 2 };
+      custom::compact_vector<int> rhs{ 7, 8, 9 };
+      int* data = rhs.data;
+      // exercise
+      v = std::move(rhs);
+      // verify
+      assertUnit(v.data == data);
+      assertUnit(v.size() == 3);
+      assertUnit(rhs.empty());
+   }  // teardown
+
+   // swapping trades buffers
+   void test_swap()
+   {  // setup
+      custom::compact_vector<int> a{ 1 };
+      custom::compact_vector<int> b{ 2, 3 };
+      // exercise
+      a.swap(b);
+      // verify
+      assertUnit(a.size() == 2);
+      assertUnit(a[1] == 3);
+      assertUnit(b.size() == 1);
+      assertUnit(b[0] == 1);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // capacity doubles, as custom::vector's does
+   void test_pushBack_grows()
+   {  // setup
+      custom::compact_vector<int> v;
+      // exercise
+      v.push_back(10);
+      size_t capacityOne = v.capacity();
+      v.push_back(20);
+      v.push_back(30);
+      // verify
+      assertUnit(capacityOne == 1);
+      assertUnit(v.capacity() == 4);
+      assertUnit(v.size() == 3);
+      assertUnit(v[0] == 10);
+      assertUnit(v[2] == 30);
+   }  // teardown
+
+   // elements that are not just bytes move properly when it grows
+   void test_pushBack_strings()
+   {  // setup
+      custom::compact_vector<std::string> v;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         v.push_back(std::string(30, (char)('a' + i % 26)));
+      // verify
+      assertUnit(v.size() == 100);
+      assertUnit(v[0] == std::string(30, 'a'));
+      assertUnit(v[99] == std::string(30, (char)('a' + 99 % 26)));
+   }  // teardown
+
+   // the counts are 32 bits, so no more than that
+   void test_reserve_pastMaxSize()
+   {  // setup
+      custom::compact_vector<char> v{ 'a' };
+      // exercise
+      bool threw = false;
+      try
+      {
+         v.reserve((size_t)custom::compact_vector<char>::max_size() + 1);
+      }
+      catch (const std::length_error&)
+      {
+         threw = true;
+      }
+      // verify
+      assertUnit(threw);
+      assertUnit(v.size() == 1);
+      assertUnit(v.capacity() == 1);
+      assertUnit(v[0] == 'a');
+   }  // teardown
+
+   // resize adds values and takes them away
+   void test_resize_growShrink()
+   {  // setup
+      custom::compact_vector<int> v{ 1, 2 };
+      // exercise
+      v.resize(5, 9);
+      bool grew = v.size() == 5 && v[1] == 2 && v[4] == 9;
+      v.resize(1);
+      // verify
+      assertUnit(grew);
+      assertUnit(v.size() == 1);
+      assertUnit(v[0] == 1);
+      assertUnit(v.capacity() == 5);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // pop_back and truncate drop from the end
+   void test_popBack_truncate()
+   {  // setup
+      custom::compact_vector<std::string> v{ "a", "b", "c", "d" };
+      // exercise
+      v.pop_back();
+      v.truncate(1);
+      // verify
+      assertUnit(v.size() == 1);
+      assertUnit(v.back() == "a");
+      v.pop_back();
+      v.pop_back();                       // nothing to pop: fine
+      assertUnit(v.empty());
+   }  // teardown
+
+   // shrinking to nothing frees the buffer
+   void test_shrinkToFit()
+   {  // setup
+      custom::compact_vector<int> v{ 1, 2, 3 };
+      v.reserve(100);
+      // exercise
+      v.shrink_to_fit();
+      bool fits = v.capacity() == 3 && v[2] == 3;
+      v.clear();
+      v.shrink_to_fit();
+      // verify
+      assertUnit(fits);
+      assertUnit(v.capacity() == 0);
+      assertUnit(v.data == nullptr);
+   }  // teardown
+
+   /***************************************
+    * STACK
+    ***************************************/
+
+   // it holds everything a stack needs
+   void test_stack_container()
+   {  // setup
+      custom::stack<int, custom::compact_vector<int>> s;
+      // exercise
+      for (int i = 0; i < 10; i++)
+         s.push(i);
+      s.pop();
+      s.pop_to(5);
+      // verify
+      assertUnit(s.size() == 5);
+      assertUnit(s.top() == 4);
+   }  // teardown
+
+   // and the stack is no bigger than it is: 16 bytes on a 64-bit build,
+   // half the default
+   void test_stack_sizeOf()
+   {  // setup
+      // exercise
+      // verify
+      assertUnit(sizeof(custom::compact_vector<int>) == sizeof(int*) + 2 * sizeof(uint32_t));
+      assertUnit(sizeof(custom::stack<int, custom::compact_vector<int>>) == sizeof(int*) + 2 * sizeof(uint32_t));
+      assertUnit(sizeof(custom::stack<int>) == 2 * sizeof(int*) + 2 * sizeof(size_t));
+   }  // teardown
+};
+
+#endif // DEBUG
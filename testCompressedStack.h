@@ -0,0 +1,314 @@
+/***********************************************************************
+ * Header:
+ *    TEST COMPRESSED STACK
+ * Summary:
+ *    Unit tests for compressed_stack
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "compressed_stack.h"
+#include "unitTest.h"
+
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <random>
+
+class TestCompressedStack : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Insert
+      test_push_hotOnly();
+      test_push_seals();
+      test_push_monotonicSmall();
+      test_push_constantZeroBits();
+
+      // Remove
+      test_pop_roundTrip();
+      test_pop_boundaryNoThrash();
+      test_pop_random();
+      test_clear_standard();
+
+      // Elements
+      test_push_random64();
+      test_push_signedSmall();
+      test_push_wrapping32();
+
+      report("CompressedStack");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // nothing allocated
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::compressed_stack<uint64_t> s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.size() == 0);
+      assertUnit(s.sealed_size() == 0);
+      assertUnit(s.memory_bytes() == 0);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // up to two segments stay as they are
+   void test_push_hotOnly()
+   {  // setup
+      custom::compressed_stack<uint64_t> s;
+      const size_t SEGMENT = custom::compressed_stack<uint64_t>::SEGMENT;
+      // exercise
+      for (uint64_t i = 0; i < 2 * SEGMENT; i++)
+         s.push(i * 1000);
+      // verify
+      assertUnit(s.size() == 2 * SEGMENT);
+      assertUnit(s.sealed_size() == 0);
+      assertUnit(s.blocks.size() == 0);
+      assertUnit(s.top() == (2 * SEGMENT - 1) * 1000);
+   }  // teardown
+
+   // one more seals the bottom segment and leaves one in hot
+   void test_push_seals()
+   {  // setup
+      custom::compressed_stack<uint64_t> s;
+      const size_t SEGMENT = custom::compressed_stack<uint64_t>::SEGMENT;
+      for (uint64_t i = 0; i < 2 * SEGMENT; i++)
+         s.push(i);
+      // exercise
+      s.push(99);
+      // verify
+      assertUnit(s.size() == 2 * SEGMENT + 1);
+      assertUnit(s.sealed_size() == SEGMENT);
+      assertUnit(s.hot.size() == SEGMENT + 1);
+      assertUnit(s.hot[0] == SEGMENT);
+      assertUnit(s.top() == 99);
+      assertUnit(s.blocks[0].first == 0);
+      assertUnit(s.blocks[0].width == 2);     // every difference is 1, zigzagged to 2
+   }  // teardown
+
+   // IDs going up by less than 8 take 4 bits each
+   void test_push_monotonicSmall()
+   {  // setup
+      custom::compressed_stack<uint64_t> s;
+      std::mt19937 random(235);
+      uint64_t id = 1000000000000ULL;
+      // exercise
+      for (size_t i = 0; i < 100000; i++)
+      {
+         id += 1 + random() % 7;
+         s.push(id);
+      }
+      // verify
+      assertUnit(s.size() == 100000);
+      assertUnit(s.top() == id);
+      assertUnit(s.blocks.size() > 0);
+      bool allNarrow = true;
+      for (size_t i = 0; i < s.blocks.size(); i++)
+         if (s.blocks[i].width > 4)
+            allNarrow = false;
+      assertUnit(allNarrow);
+      assertUnit(s.numBytes < 100000 * 4 / 8 + 100);
+   }  // teardown
+
+   // the same value over and over takes no bits at all
+   void test_push_constantZeroBits()
+   {  // setup
+      custom::compressed_stack<int> s;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         s.push(7);
+      // verify
+      assertUnit(s.blocks.size() > 0);
+      assertUnit(s.blocks[0].width == 0);
+      assertUnit(s.numBytes == 0);
+      bool allSeven = true;
+      while (!s.empty())
+      {
+         if (s.top() != 7)
+            allSeven = false;
+         s.pop();
+      }
+      assertUnit(allSeven);
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // everything comes back, last in first out
+   void test_pop_roundTrip()
+   {  // setup
+      custom::compressed_stack<uint32_t> s;
+      for (uint32_t i = 0; i < 10000; i++)
+         s.push(i * 3);
+      // exercise
+      bool inOrder = true;
+      for (uint32_t i = 10000; i-- > 0; )
+      {
+         if (s.top() != i * 3)
+            inOrder = false;
+         s.pop();
+      }
+      // verify
+      assertUnit(inOrder);
+      assertUnit(s.empty());
+      assertUnit(s.sealed_size() == 0);
+      assertUnit(s.numBytes == 0);
+   }  // teardown
+
+   // after a segment is unpacked, pushing back over it does not seal
+   void test_pop_boundaryNoThrash()
+   {  // setup
+      custom::compressed_stack<uint64_t> s;
+      const size_t SEGMENT = custom::compressed_stack<uint64_t>::SEGMENT;
+      for (uint64_t i = 0; i < 3 * SEGMENT; i++)
+         s.push(i);
+      while (s.hot.size() > 1)
+         s.pop();
+      size_t numBlocks = s.blocks.size();
+      // exercise
+      s.pop();
+      // verify
+      assertUnit(s.blocks.size() == numBlocks - 1);
+      assertUnit(s.hot.size() == SEGMENT);
+      s.push(1);
+      s.pop();
+      s.push(2);
+      assertUnit(s.blocks.size() == numBlocks - 1);
+      assertUnit(s.top() == 2);
+   }  // teardown
+
+   // pushes and pops in any order agree with a plain vector
+   void test_pop_random()
+   {  // setup
+      custom::compressed_stack<int64_t> s;
+      custom::vector<int64_t> expected;
+      std::mt19937_64 random(235);
+      int64_t value = 0;
+      // exercise
+      bool same = true;
+      for (int i = 0; i < 50000; i++)
+      {
+         unsigned int pushChance = (i / 3000) % 2 == 0 ? 70 : 30;
+         if (expected.empty() || random() % 100 < pushChance)
+         {
+            value += (int64_t)(random() % 2001) - 1000;
+            s.push(value);
+            expected.push_back(value);
+         }
+         else
+         {
+            s.pop();
+            expected.pop_back();
+         }
+         if (s.size() != expected.size() ||
+             (!expected.empty() && s.top() != expected.back()))
+            same = false;
+      }
+      // verify
+      assertUnit(same);
+   }  // teardown
+
+   // clear empties it all
+   void test_clear_standard()
+   {  // setup
+      custom::compressed_stack<uint64_t> s;
+      for (uint64_t i = 0; i < 1000; i++)
+         s.push(i);
+      // exercise
+      s.clear();
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.size() == 0);
+      assertUnit(s.sealed_size() == 0);
+      s.push(5);
+      assertUnit(s.top() == 5);
+   }  // teardown
+
+   /***************************************
+    * ELEMENTS
+    ***************************************/
+
+   // differences too wide to pack are kept whole
+   void test_push_random64()
+   {  // setup
+      custom::compressed_stack<uint64_t> s;
+      custom::vector<uint64_t> expected;
+      std::mt19937_64 random(235);
+      for (int i = 0; i < 1000; i++)
+      {
+         expected.push_back(random());
+         s.push(expected.back());
+      }
+      // exercise
+      assertUnit(s.blocks.size() > 0);
+      assertUnit(s.blocks[0].width == 64);
+      bool same = true;
+      for (int i = 1000; i-- > 0; )
+      {
+         if (s.top() != expected[i])
+            same = false;
+         s.pop();
+      }
+      // verify
+      assertUnit(same);
+   }  // teardown
+
+   // small values either side of zero pack narrow
+   void test_push_signedSmall()
+   {  // setup
+      custom::compressed_stack<int16_t> s;
+      for (int i = 0; i < 1000; i++)
+         s.push((int16_t)(i % 2 ? -3 : 3));
+      // exercise
+      assertUnit(s.blocks.size() > 0);
+      assertUnit(s.blocks[0].width == 4);     // differences of +-6 zigzag to 11 or 12
+      bool same = true;
+      for (int i = 1000; i-- > 0; )
+      {
+         if (s.top() != (int16_t)(i % 2 ? -3 : 3))
+            same = false;
+         s.pop();
+      }
+      // verify
+      assertUnit(same);
+   }  // teardown
+
+   // a jump that wraps around in 32 bits is still a small difference
+   void test_push_wrapping32()
+   {  // setup
+      custom::compressed_stack<uint32_t> s;
+      uint32_t value = 0xFFFFFF00u;
+      for (int i = 0; i < 1000; i++)
+         s.push(value++);
+      // exercise
+      bool same = true;
+      for (int i = 1000; i-- > 0; )
+      {
+         if (s.top() != --value)
+            same = false;
+         s.pop();
+      }
+      // verify
+      assertUnit(same);
+      assertUnit(s.empty());
+   }  // teardown
+};
+
+#endif // DEBUG
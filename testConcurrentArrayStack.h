@@ -0,0 +1,390 @@
+/***********************************************************************
+ * Header:
+ *    TEST CONCURRENT ARRAY STACK
+ * Summary:
+ *    Unit tests for concurrent_array_stack
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "concurrent_array_stack.h"
+#include "unitTest.h"
+#include "spy.h"
+
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <climits>
+#include <thread>
+#include <vector>
+
+class TestConcurrentArrayStack : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_capacity();
+      test_construct_zero();
+      test_destructor_standard();
+
+      // Insert
+      test_push_empty();
+      test_push_full();
+      test_push_reusesSlot();
+
+      // Remove
+      test_pop_empty();
+      test_pop_standard();
+      test_pop_order();
+      test_pop_bumpsVersion();
+
+      // Threads
+      test_threads_conserve();
+      test_threads_lifoBursts();
+      test_threads_bounded();
+
+      report("ConcurrentArrayStack");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // every slot starts on the free list, no element is built
+   void test_construct_capacity()
+   {  // setup
+      Spy::reset();
+      // exercise
+      custom::concurrent_array_stack<Spy> s(4);
+      // verify
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(s.capacity() == 4);
+      assertUnit(s.empty());
+      assertUnit(listSize(s, s.unused) == 4);
+      assertUnit(listSize(s, s.full) == 0);
+   }  // teardown
+
+   // a stack with no room allocates nothing
+   void test_construct_zero()
+   {  // setup
+      // exercise
+      custom::concurrent_array_stack<int> s(0);
+      // verify
+      assertUnit(s.slots == nullptr);
+      assertUnit(s.capacity() == 0);
+      assertUnit(!s.try_push(1));
+   }  // teardown
+
+   // the destructor destroys what is left
+   void test_destructor_standard()
+   {  // setup
+      {
+         custom::concurrent_array_stack<Spy> s(8);
+         setupStandardFixture(s);
+         Spy::reset();
+      }  // exercise
+      // verify
+      assertUnit(Spy::numDestructor() == 4);
+      assertUnit(Spy::numDelete() == 4);
+   }
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // push moves a slot from one list to the other
+   void test_push_empty()
+   {  // setup
+      custom::concurrent_array_stack<Spy> s(4);
+      Spy::reset();
+      // exercise
+      bool pushed = s.try_push(Spy(26));
+      // verify
+      assertUnit(pushed);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 1);
+      assertUnit(!s.empty());
+      assertUnit(listSize(s, s.full) == 1);
+      assertUnit(listSize(s, s.unused) == 3);
+   }  // teardown
+
+   // a full stack refuses without building anything
+   void test_push_full()
+   {  // setup
+      custom::concurrent_array_stack<Spy> s(4);
+      setupStandardFixture(s);
+      Spy value(99);
+      Spy::reset();
+      // exercise
+      bool pushed = s.try_push(value);
+      // verify
+      assertUnit(!pushed);
+      assertUnit(Spy::numCopy() == 0);
+      assertStandardFixture(s);
+   }  // teardown
+
+   // a popped slot is the next one pushed into
+   void test_push_reusesSlot()
+   {  // setup
+      custom::concurrent_array_stack<int> s(4);
+      s.try_push(1);
+      s.try_push(2);
+      int value;
+      s.try_pop(value);
+      uint32_t freed = s.indexOf(s.unused.load());
+      // exercise
+      s.try_push(3);
+      // verify
+      assertUnit(s.indexOf(s.full.load()) == freed);
+      assertUnit(listSize(s, s.full) == 2);
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // pop an empty stack fails and leaves t alone
+   void test_pop_empty()
+   {  // setup
+      custom::concurrent_array_stack<Spy> s(4);
+      Spy value(7);
+      Spy::reset();
+      // exercise
+      bool popped = s.try_pop(value);
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == Spy(7));
+      assertUnit(Spy::numAssignMove() == 0);
+   }  // teardown
+
+   // pop moves the top out and destroys the slot's element
+   void test_pop_standard()
+   {  // setup
+      custom::concurrent_array_stack<Spy> s(4);
+      setupStandardFixture(s);
+      Spy value;
+      Spy::reset();
+      // exercise
+      bool popped = s.try_pop(value);
+      // verify
+      assertUnit(popped);
+      assertUnit(Spy::numAssignMove() == 1);
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(value == Spy(89));
+      assertUnit(listSize(s, s.full) == 3);
+      assertUnit(listSize(s, s.unused) == 1);
+   }  // teardown
+
+   // one thread sees plain LIFO order
+   void test_pop_order()
+   {  // setup
+      custom::concurrent_array_stack<int> s(100);
+      for (int i = 0; i < 100; i++)
+         s.try_push(i);
+      // exercise
+      bool same = true;
+      int value;
+      for (int i = 100; i-- > 0; )
+         same = same && s.try_pop(value) && value == i;
+      // verify
+      assertUnit(same);
+      assertUnit(s.empty());
+      assertUnit(!s.try_pop(value));
+   }  // teardown
+
+   // every change to a head gives it a new version
+   void test_pop_bumpsVersion()
+   {  // setup
+      custom::concurrent_array_stack<int> s(4);
+      s.try_push(1);
+      uint64_t before = s.full.load();
+      int value;
+      // exercise
+      s.try_pop(value);
+      s.try_push(1);
+      // verify
+      assertUnit(s.indexOf(s.full.load()) == s.indexOf(before));
+      assertUnit(s.versionOf(s.full.load()) == s.versionOf(before) + 2);
+      assertUnit(s.full.load() != before);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // producers and consumers racing: nothing lost, nothing twice
+   void test_threads_conserve()
+   {  // setup
+      const int numThreads = 4;
+      const int numEach = 20000;
+      custom::concurrent_array_stack<int> s(64);
+      std::vector<std::vector<int>> popped(numThreads);
+      std::atomic<int> numDone(0);
+      std::vector<std::thread> threads;
+      // exercise
+      for (int t = 0; t < numThreads; t++)
+         threads.emplace_back([&, t]() {
+            for (int i = 0; i < numEach; i++)
+               while (!s.try_push(t * numEach + i))
+               {
+                  int value;
+                  if (s.try_pop(value))
+                     popped[t].push_back(value);
+               }
+            numDone++;
+            int value;
+            while (numDone < numThreads || !s.empty())
+               if (s.try_pop(value))
+                  popped[t].push_back(value);
+            });
+      for (auto& thread : threads)
+         thread.join();
+      // verify
+      std::vector<int> seen(numThreads * numEach, 0);
+      for (auto& values : popped)
+         for (int value : values)
+            seen[value]++;
+      bool once = true;
+      for (int count : seen)
+         once = once && count == 1;
+      assertUnit(once);
+      assertUnit(s.empty());
+      assertUnit(listSize(s, s.unused) == 64);
+   }  // teardown
+
+   // conserve above would pass a queue too, so check the order.  One
+   // producer pushes a burst of rising values, then waits while the
+   // consumers race to drain it.  With no push in between, every pop
+   // takes the top, so each consumer sees its values falling
+   void test_threads_lifoBursts()
+   {  // setup
+      const int numConsumers = 3;
+      const int numBursts = 500;
+      const int numBurst = 64;
+      custom::concurrent_array_stack<int> s(numBurst);
+      std::atomic<int> numReleased(0);   // bursts pushed so far
+      std::atomic<int> numDrained(0);    // consumers done with a burst
+      std::atomic<int> numPopped(0);
+      std::atomic<bool> falling(true);
+      std::vector<std::thread> consumers;
+      // exercise
+      for (int c = 0; c < numConsumers; c++)
+         consumers.emplace_back([&]() {
+            for (int burst = 1; burst <= numBursts; burst++)
+            {
+               while (numReleased.load() < burst)
+                  std::this_thread::yield();
+               int value;
+               int last = INT_MAX;
+               while (s.try_pop(value))
+               {
+                  if (value >= last)
+                     falling = false;
+                  last = value;
+                  numPopped++;
+               }
+               numDrained++;
+            }
+            });
+      bool pushed = true;
+      int next = 0;
+      for (int burst = 1; burst <= numBursts; burst++)
+      {
+         for (int i = 0; i < numBurst; i++)
+            pushed = s.try_push(next++) && pushed;
+         numReleased = burst;
+         while (numDrained.load() < burst * numConsumers)
+            std::this_thread::yield();
+      }
+      for (auto& thread : consumers)
+         thread.join();
+      // verify
+      assertUnit(pushed);
+      assertUnit(falling);
+      assertUnit(numPopped == numBursts * numBurst);
+      assertUnit(s.empty());
+      assertUnit(listSize(s, s.unused) == numBurst);
+   }  // teardown
+
+   // no matter how threads interleave, the stack never holds more than capacity
+   void test_threads_bounded()
+   {  // setup
+      const int numThreads = 4;
+      custom::concurrent_array_stack<int> s(8);
+      std::atomic<int> numPushed(0);
+      std::atomic<int> numRefused(0);
+      std::vector<std::thread> threads;
+      // exercise
+      for (int t = 0; t < numThreads; t++)
+         threads.emplace_back([&]() {
+            for (int i = 0; i < 1000; i++)
+               if (s.try_push(i))
+                  numPushed++;
+               else
+                  numRefused++;
+            });
+      for (auto& thread : threads)
+         thread.join();
+      // verify
+      assertUnit(numPushed == 8);
+      assertUnit(numRefused == numThreads * 1000 - 8);
+      assertUnit(listSize(s, s.full) == 8);
+      assertUnit(listSize(s, s.unused) == 0);
+   }  // teardown
+
+   /*************************************************************
+    * LIST SIZE
+    * Walk one of the lists; only when no other thread is running
+    *************************************************************/
+   template <class T>
+   size_t listSize(custom::concurrent_array_stack<T>& s, std::atomic<uint64_t>& head)
+   {
+      size_t num = 0;
+      for (uint32_t i = s.indexOf(head.load()); i != s.NIL; i = s.slots[i].next.load())
+         num++;
+      return num;
+   }
+
+   /*************************************************************
+    * SETUP STANDARD FIXTURE
+    *    +----+----+----+----+
+    *    | 26 | 49 | 67 | 89 |
+    *    +----+----+----+----+
+    *************************************************************/
+   void setupStandardFixture(custom::concurrent_array_stack<Spy>& s)
+   {
+      s.try_push(Spy(26));
+      s.try_push(Spy(49));
+      s.try_push(Spy(67));
+      s.try_push(Spy(89));
+   }
+
+   /*************************************************************
+    * VERIFY STANDARD FIXTURE
+    *    +----+----+----+----+
+    *    | 26 | 49 | 67 | 89 |
+    *    +----+----+----+----+
+    *************************************************************/
+   void assertStandardFixtureParameters(custom::concurrent_array_stack<Spy>& s,
+                                        int line, const char* function)
+   {
+      assertIndirect(listSize(s, s.full) == 4);
+      int expected[] = { 89, 67, 49, 26 };
+      uint32_t i = s.indexOf(s.full.load());
+      for (int value : expected)
+      {
+         assertIndirect(i != s.NIL && *s.element(i) == Spy(value));
+         i = i != s.NIL ? s.slots[i].next.load() : s.NIL;
+      }
+   }
+
+};
+
+#endif // DEBUG
@@ -0,0 +1,667 @@
+/***********************************************************************
+ * Header:
+ *    TEST COW STACK
+ * Summary:
+ *    Unit tests for cow_stack
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "cow_stack.h"
+#include "unitTest.h"
+#include "spy.h"
+
+#include <iostream>
+#include <cassert>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include <stack>
+#include <vector>
+
+class TestCowStack : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructCopy_empty();
+      test_constructCopy_standard();
+      test_constructCopy_repeated();
+      test_constructCopy_twice();
+      test_constructCopy_concurrent();
+      test_constructMove_standard();
+      test_destructor_shared();
+      test_destructor_deepChain();
+
+      // Assign
+      test_assignCopy_fullToFull();
+      test_swap_standard();
+
+      // Access
+      test_top_readShared();
+      test_top_writeShared();
+      test_top_writeSharedLong();
+      test_top_writeUnique();
+      test_top_writeAfterThreadCopy();
+
+      // Insert
+      test_push_copy();
+      test_push_appendsUnique();
+      test_push_sharedLong();
+      test_push_trimsHidden();
+      test_push_mergesShortRuns();
+
+      // Remove
+      test_pop_shared();
+      test_pop_unique();
+      test_pop_throughSegments();
+      test_branches_againstStd();
+
+      report("CowStack");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // default constructor, no allocations
+   void test_construct_default()
+   {  // setup
+      Spy::reset();
+      // exercise
+      custom::cow_stack<Spy> s;
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(s.size() == 0);
+      assertUnit(s.empty());
+      assertUnit(s.segment == nullptr);
+      assertUnit(s.numVisible == 0);
+   }  // teardown
+
+   // copy of an empty stack shares nothing
+   void test_constructCopy_empty()
+   {  // setup
+      custom::cow_stack<Spy> sSrc;
+      Spy::reset();
+      // exercise
+      custom::cow_stack<Spy> sDest(sSrc);
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(sDest.empty());
+      assertUnit(sSrc.segment == nullptr);
+      assertUnit(sDest.segment == nullptr);
+   }  // teardown
+
+   // copy of a full stack shares the elements: no element is touched
+   void test_constructCopy_standard()
+   {  // setup
+      custom::cow_stack<Spy> sSrc;
+      setupStandardFixture(sSrc);
+      Spy::reset();
+      // exercise
+      custom::cow_stack<Spy> sDest(sSrc);
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(sSrc.segment == sDest.segment);
+      assertUnit(sDest.numVisible == 4);
+      assertStandardFixture(sSrc);
+      assertStandardFixture(sDest);
+   }  // teardown
+
+   // copying a big stack again and again, with no write between, copies nothing
+   void test_constructCopy_repeated()
+   {  // setup
+      custom::cow_stack<Spy> s;
+      for (int i = 0; i < 100000; i++)
+         s.push(Spy(i));
+      const custom::cow_stack<Spy>& sConst = s;
+      Spy::reset();
+      // exercise
+      custom::cow_stack<Spy> copies[5] = { sConst, sConst, sConst, sConst, sConst };
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(s.segment.use_count() == 6);
+      assertUnit(copies[4].size() == 100000);
+      assertUnit(copies[4].top() == Spy(99999));
+   }  // teardown
+
+   // copying a copy still shares the same segment
+   void test_constructCopy_twice()
+   {  // setup
+      custom::cow_stack<Spy> sSrc;
+      setupStandardFixture(sSrc);
+      custom::cow_stack<Spy> sMiddle(sSrc);
+      Spy::reset();
+      // exercise
+      custom::cow_stack<Spy> sDest(sMiddle);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(sDest.segment == sSrc.segment);
+      assertUnit(sSrc.segment.use_count() == 3);
+      assertStandardFixture(sDest);
+   }  // teardown
+
+   // threads copying one const stack at once each get all of it
+   void test_constructCopy_concurrent()
+   {  // setup
+      custom::cow_stack<int> s;
+      for (int i = 0; i < 1000; i++)
+         s.push(i);
+      const custom::cow_stack<int>& sConst = s;
+      bool same[4] = { false, false, false, false };
+      // exercise
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 4; t++)
+         threads.emplace_back([&sConst, &same, t]() {
+            bool ok = true;
+            for (int round = 0; round < 100; round++)
+            {
+               custom::cow_stack<int> copy(sConst);
+               ok = ok && sConst.size() == 1000 && sConst.top() == 999;
+               for (int i = 999; i >= 0; i--)
+               {
+                  ok = ok && copy.top() == i;
+                  copy.pop();
+               }
+            }
+            same[t] = ok;
+         });
+      for (auto& thread : threads)
+         thread.join();
+      // verify
+      assertUnit(same[0] && same[1] && same[2] && same[3]);
+      assertUnit(s.size() == 1000);
+      assertUnit(s.segment.use_count() == 1);
+      assertUnit(s.segment->items.size() == 1000);
+   }  // teardown
+
+   // move constructor steals everything
+   void test_constructMove_standard()
+   {  // setup
+      custom::cow_stack<Spy> sSrc;
+      setupStandardFixture(sSrc);
+      Spy::reset();
+      // exercise
+      custom::cow_stack<Spy> sDest(std::move(sSrc));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(sSrc.empty());
+      assertStandardFixture(sDest);
+   }  // teardown
+
+   // the elements outlive the stack they were copied from
+   void test_destructor_shared()
+   {  // setup
+      custom::cow_stack<Spy> sDest;
+      {
+         custom::cow_stack<Spy> sSrc;
+         setupStandardFixture(sSrc);
+         sDest = sSrc;
+         Spy::reset();
+      }  // exercise
+      // verify
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertStandardFixture(sDest);
+   }  // teardown
+
+   // a chain of many segments goes away without recursing down it
+   void test_destructor_deepChain()
+   {  // setup
+      std::vector<int> run(custom::cow_stack<int>::MERGE, 7);
+      {
+         custom::cow_stack<int> s;
+         custom::cow_stack<int> copy;
+         for (int i = 0; i < 100000; i++)
+         {
+            for (int value : run)
+               s.push(value);
+            copy = s;                    // each run too long to merge
+         }
+         assertUnit(depth(s) == 100000);
+      }  // exercise
+      // verify
+      assertUnit(true);                  // still here
+   }  // teardown
+
+   /***************************************
+    * ASSIGN
+    ***************************************/
+
+   // assign drops the old elements and shares the new ones
+   void test_assignCopy_fullToFull()
+   {  // setup
+      custom::cow_stack<Spy> sSrc;
+      setupStandardFixture(sSrc);
+      custom::cow_stack<Spy> sDest;
+      sDest.push(Spy(11));
+      sDest.push(Spy(22));
+      Spy::reset();
+      // exercise
+      sDest = sSrc;
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numDestructor() == 2);  // [11,22]
+      assertUnit(Spy::numDelete() == 2);
+      assertStandardFixture(sSrc);
+      assertStandardFixture(sDest);
+   }  // teardown
+
+   // swap exchanges the two stacks
+   void test_swap_standard()
+   {  // setup
+      custom::cow_stack<Spy> sLHS;
+      setupStandardFixture(sLHS);
+      custom::cow_stack<Spy> sRHS;
+      sRHS.push(Spy(11));
+      Spy::reset();
+      // exercise
+      sLHS.swap(sRHS);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(sLHS.size() == 1);
+      assertUnit(sLHS.top() == Spy(11));
+      assertStandardFixture(sRHS);
+   }  // teardown
+
+   /***************************************
+    * TOP
+    ***************************************/
+
+   // reading the top of a shared stack copies nothing
+   void test_top_readShared()
+   {  // setup
+      custom::cow_stack<Spy> sSrc;
+      setupStandardFixture(sSrc);
+      const custom::cow_stack<Spy> sDest(sSrc);
+      Spy::reset();
+      // exercise
+      const Spy& s = sDest.top();
+      // verify
+      assertUnit(s.get() == 89);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(sDest.segment == sSrc.segment);
+   }  // teardown
+
+   // writing the top of a short shared stack copies the run up
+   void test_top_writeShared()
+   {  // setup
+      custom::cow_stack<Spy> sSrc;
+      setupStandardFixture(sSrc);
+      custom::cow_stack<Spy> sDest(sSrc);
+      Spy::reset();
+      // exercise
+      sDest.top() = Spy(99);
+      // verify
+      assertUnit(Spy::numCopy() == 4);        // [89], then [26,49,67] up
+      assertUnit(depth(sDest) == 1);
+      assertUnit(sDest.segment != sSrc.segment);
+      assertUnit(sDest.size() == 4);
+      assertUnit(sDest.top() == Spy(99));
+      assertStandardFixture(sSrc);
+   }  // teardown
+
+   // writing the top of a long shared stack copies that one element
+   void test_top_writeSharedLong()
+   {  // setup
+      custom::cow_stack<Spy> sSrc;
+      for (int i = 0; i < 100; i++)
+         sSrc.push(Spy(i));
+      custom::cow_stack<Spy> sDest(sSrc);
+      Spy::reset();
+      // exercise
+      sDest.top() = Spy(-1);
+      // verify
+      assertUnit(Spy::numCopy() == 1);        // [99] only
+      assertUnit(depth(sDest) == 2);
+      assertUnit(sDest.numVisible == 1);
+      assertUnit(sDest.size() == 100);
+      assertUnit(sDest.top() == Spy(-1));
+      assertUnit(sSrc.top() == Spy(99));
+   }  // teardown
+
+   // writing the top when nobody else shares it copies nothing
+   void test_top_writeUnique()
+   {  // setup
+      custom::cow_stack<Spy> s;
+      setupStandardFixture(s);
+      {
+         custom::cow_stack<Spy> sCopy(s);
+      }
+      Spy::reset();
+      // exercise
+      s.top() = Spy(99);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(depth(s) == 1);
+      assertUnit(s.size() == 4);
+      assertUnit(s.top() == Spy(99));
+   }  // teardown
+
+   // a copy read and dropped on another thread leaves the segment to
+   // this one, which then writes it in place
+   void test_top_writeAfterThreadCopy()
+   {  // setup
+      custom::cow_stack<int> s;
+      for (int i = 0; i < 1000; i++)
+         s.push(i);
+      custom::cow_stack<int> sCopy(s);
+      const void* segment = s.segment.get();
+      long long sum = 0;
+      // exercise
+      std::thread thread([&sum, sCopy = std::move(sCopy)]() mutable {
+         while (!sCopy.empty())
+         {
+            sum += std::as_const(sCopy).top();
+            sCopy.pop();
+         }
+      });
+      while (s.segment.use_count() != 1)
+         std::this_thread::yield();
+      bool inPlace = true;
+      for (int i = 999; i >= 0; i--)
+      {
+         s.top() = -i;
+         inPlace = inPlace && s.segment.get() == segment;
+         s.pop();
+      }
+      thread.join();
+      // verify
+      assertUnit(sum == 999 * 1000 / 2);
+      assertUnit(inPlace);
+      assertUnit(s.empty());
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // pushing onto a copy leaves the original alone
+   void test_push_copy()
+   {  // setup
+      custom::cow_stack<Spy> sSrc;
+      setupStandardFixture(sSrc);
+      custom::cow_stack<Spy> sDest(sSrc);
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      sDest.push(s);
+      // verify
+      assertUnit(Spy::numCopy() == 5);        // [26,49,67,89] up, then [99]
+      assertUnit(Spy::numCopy() <= (int)custom::cow_stack<Spy>::MERGE);
+      assertUnit(sDest.size() == 5);
+      assertUnit(sDest.top() == Spy(99));
+      assertStandardFixture(sSrc);
+   }  // teardown
+
+   // when the copies are gone, pushing adds to the one segment
+   void test_push_appendsUnique()
+   {  // setup
+      custom::cow_stack<Spy> s;
+      setupStandardFixture(s);
+      {
+         custom::cow_stack<Spy> sCopy(s);
+      }
+      Spy t(90);
+      Spy::reset();
+      // exercise
+      s.push(t);
+      // verify
+      assertUnit(Spy::numCopy() == 1);        // [90] only
+      assertUnit(depth(s) == 1);
+      assertUnit(s.numVisible == 5);
+      assertUnit(s.top() == Spy(90));
+   }  // teardown
+
+   // pushing onto a long shared run stacks a segment on it, copying nothing
+   void test_push_sharedLong()
+   {  // setup
+      custom::cow_stack<Spy> s;
+      for (int i = 0; i < 1000; i++)
+         s.push(Spy(i));
+      custom::cow_stack<Spy> sCopy(s);
+      Spy::reset();
+      // exercise
+      s.push(Spy(1000));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(depth(s) == 2);
+      assertUnit(s.numVisible == 1);
+      assertUnit(s.size() == 1001);
+      assertUnit(sCopy.size() == 1000);
+      assertUnit(sCopy.top() == Spy(999));
+   }  // teardown
+
+   // once the copies are gone, elements this stack popped but a copy
+   // still saw are destroyed before pushing in place
+   void test_push_trimsHidden()
+   {  // setup
+      custom::cow_stack<Spy> s;
+      setupStandardFixture(s);
+      {
+         custom::cow_stack<Spy> sCopy(s);
+         s.pop();
+         s.pop();
+      }
+      Spy t(90);
+      Spy::reset();
+      // exercise
+      s.push(t);
+      // verify
+      assertUnit(Spy::numDestructor() == 2);  // [67,89]
+      assertUnit(Spy::numCopy() == 1);        // [90]
+      assertUnit(s.segment->items.size() == 3);
+      assertUnit(s.size() == 3);
+      assertUnit(s.top() == Spy(90));
+   }  // teardown
+
+   // pushing one and copying, over and over, does not stack a segment per copy
+   void test_push_mergesShortRuns()
+   {  // setup
+      custom::cow_stack<int> s;
+      custom::cow_stack<int> copy;
+      // exercise
+      for (int i = 0; i < 1000000; i++)
+      {
+         s.push(i);
+         copy = s;
+      }
+      // verify
+      assertUnit(depth(s) <= 1000000 / custom::cow_stack<int>::MERGE + 1);
+      assertUnit(s.size() == 1000000);
+      assertUnit(copy.size() == 1000000);
+      bool same = true;
+      for (int i = 999999; i >= 999000; i--)
+      {
+         same = same && copy.top() == i;
+         copy.pop();
+      }
+      assertUnit(same);
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // popping a shared element destroys nothing
+   void test_pop_shared()
+   {  // setup
+      custom::cow_stack<Spy> sSrc;
+      setupStandardFixture(sSrc);
+      custom::cow_stack<Spy> sDest(sSrc);
+      Spy::reset();
+      // exercise
+      sDest.pop();
+      sDest.pop();
+      // verify
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(sDest.size() == 2);
+      assertUnit(sDest.top() == Spy(49));
+      assertStandardFixture(sSrc);
+   }  // teardown
+
+   // popping an element nobody else sees destroys it
+   void test_pop_unique()
+   {  // setup
+      custom::cow_stack<Spy> s;
+      setupStandardFixture(s);
+      {
+         custom::cow_stack<Spy> sCopy(s);
+      }
+      Spy::reset();
+      // exercise
+      s.pop();
+      // verify
+      assertUnit(Spy::numDestructor() == 1);  // [89]
+      assertUnit(Spy::numDelete() == 1);
+      assertUnit(s.size() == 3);
+      assertUnit(s.segment->items.size() == 3);
+   }  // teardown
+
+   // pop down through several segments
+   void test_pop_throughSegments()
+   {  // setup
+      const int MERGE = (int)custom::cow_stack<int>::MERGE;
+      custom::cow_stack<int> s;
+      for (int i = 0; i < MERGE; i++)
+         s.push(i);
+      custom::cow_stack<int> sA(s);
+      for (int i = MERGE; i < 2 * MERGE; i++)
+         s.push(i);                    // a segment on top of [0..MERGE)
+      custom::cow_stack<int> sB(s);
+      s.push(2 * MERGE);               // and another on top of that
+      // exercise
+      bool same = depth(s) == 3;
+      for (int expected = 2 * MERGE; expected >= 0; expected--)
+      {
+         same = same && s.size() == (size_t)expected + 1 && s.top() == expected;
+         s.pop();
+      }
+      // verify
+      assertUnit(same);
+      assertUnit(s.empty());
+      assertUnit(s.segment == nullptr);
+      assertUnit(sA.size() == (size_t)MERGE && sA.top() == MERGE - 1);
+      assertUnit(sB.size() == 2 * (size_t)MERGE && sB.top() == 2 * MERGE - 1);
+   }  // teardown
+
+   // a search that copies at every branch agrees with std::stack
+   void test_branches_againstStd()
+   {  // setup
+      custom::cow_stack<int> s;
+      std::stack<int> sStd;
+      std::vector<custom::cow_stack<int>> versions;
+      std::vector<std::stack<int>> versionsStd;
+      unsigned int seed = 7;
+      // exercise
+      for (int i = 0; i < 2000; i++)
+      {
+         seed = seed * 1103515245u + 12345u;
+         switch ((seed >> 8) % 5)
+         {
+         case 0:
+            versions.push_back(s);
+            versionsStd.push_back(sStd);
+            break;
+         case 1:
+            if (!sStd.empty())
+            {
+               s.pop();
+               sStd.pop();
+            }
+            break;
+         case 2:
+            if (!sStd.empty())
+            {
+               s.top() += 1;
+               sStd.top() += 1;
+            }
+            break;
+         default:
+            s.push(i);
+            sStd.push(i);
+         }
+      }
+      // verify
+      versions.push_back(s);
+      versionsStd.push_back(sStd);
+      bool same = true;
+      for (size_t v = 0; v < versions.size(); v++)
+      {
+         same = same && versions[v].size() == versionsStd[v].size();
+         while (same && !versionsStd[v].empty())
+         {
+            same = versions[v].top() == versionsStd[v].top();
+            versions[v].pop();
+            versionsStd[v].pop();
+         }
+      }
+      assertUnit(same);
+   }  // teardown
+
+   // how many segments deep a stack's chain is
+   template <class T>
+   static size_t depth(const custom::cow_stack<T>& s)
+   {
+      size_t num = 0;
+      for (auto p = s.segment.get(); p; p = p->parent.get())
+         num++;
+      return num;
+   }
+
+   /*************************************************************
+    * SETUP STANDARD FIXTURE
+    *    +----+----+----+----+
+    *    | 26 | 49 | 67 | 89 |
+    *    +----+----+----+----+
+    *************************************************************/
+   void setupStandardFixture(custom::cow_stack<Spy>& s)
+   {
+      s.push(Spy(26));
+      s.push(Spy(49));
+      s.push(Spy(67));
+      s.push(Spy(89));
+   }
+
+   /*************************************************************
+    * VERIFY STANDARD FIXTURE
+    *    +----+----+----+----+
+    *    | 26 | 49 | 67 | 89 |
+    *    +----+----+----+----+
+    *************************************************************/
+   void assertStandardFixtureParameters(const custom::cow_stack<Spy>& s,
+                                        int line, const char* function)
+   {
+      assertIndirect(s.size() == 4);
+      custom::cow_stack<Spy> copy(s);
+      int expected[] = { 89, 67, 49, 26 };
+      for (int value : expected)
+      {
+         assertIndirect(!copy.empty() && copy.top() == Spy(value));
+         copy.pop();
+      }
+   }
+
+};
+
+#endif // DEBUG
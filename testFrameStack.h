@@ -0,0 +1,405 @@
+/***********************************************************************
+ * Header:
+ *    TEST FRAME STACK
+ * Summary:
+ *    Unit tests for frame_stack
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "frame_stack.h"
+#include "unitTest.h"
+#include "spy.h"
+
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <string>
+
+class TestFrameStack : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_destructor_standard();
+      test_constructMove_standard();
+
+      // Access
+      test_top_standard();
+      test_top_mixed();
+
+      // Insert
+      test_push_empty();
+      test_push_aligned();
+      test_push_newChunk();
+      test_push_tooBigForChunk();
+      test_push_zeroChunk();
+
+      // Remove
+      test_pop_standard();
+      test_pop_typed();
+      test_pop_reusesChunks();
+      test_unwind_destroys();
+      test_unwind_trivial();
+      test_unwind_acrossChunks();
+      test_clear_standard();
+
+      report("FrameStack");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // default constructor, no allocations
+   void test_construct_default()
+   {  // setup
+      Spy::reset();
+      // exercise
+      custom::frame_stack s;
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(s.chunks.size() == 0);
+      assertUnit(s.last == nullptr);
+      assertUnit(s.next == nullptr);
+      assertUnit(s.numChunkFirst == 4096);
+      assertUnit(s.size() == 0);
+      assertUnit(s.empty());
+   }  // teardown
+
+   // the destructor destroys every record
+   void test_destructor_standard()
+   {  // setup
+      {
+         custom::frame_stack s;
+         setupStandardFixture(s);
+         Spy::reset();
+      }  // exercise
+      // verify
+      assertUnit(Spy::numDestructor() == 4);
+      assertUnit(Spy::numDelete() == 4);
+   }
+
+   // move steals the chunks and the records
+   void test_constructMove_standard()
+   {  // setup
+      custom::frame_stack sSrc;
+      setupStandardFixture(sSrc);
+      Spy::reset();
+      // exercise
+      custom::frame_stack sDest(std::move(sSrc));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(sSrc.empty());
+      assertUnit(sSrc.chunks.size() == 0);
+      assertStandardFixture(sDest);
+   }  // teardown
+
+   /***************************************
+    * TOP
+    ***************************************/
+
+   // top is the last thing pushed
+   void test_top_standard()
+   {  // setup
+      custom::frame_stack s;
+      setupStandardFixture(s);
+      Spy::reset();
+      // exercise
+      Spy& top = s.top<Spy>();
+      // verify
+      assertUnit(top.get() == 89);
+      assertUnit(Spy::numCopy() == 0);
+   }  // teardown
+
+   // records of different types sit on top of each other
+   void test_top_mixed()
+   {  // setup
+      custom::frame_stack s;
+      s.push<char>('a');
+      s.push<double>(2.5);
+      s.push<std::string>("frame");
+      // exercise
+      std::string& str = s.top<std::string>();
+      // verify
+      assertUnit(str == "frame");
+      s.pop<std::string>();
+      assertUnit(s.top<double>() == 2.5);
+      s.pop<double>();
+      assertUnit(s.top<char>() == 'a');
+      assertUnit(s.size() == 1);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // the first push allocates the first chunk
+   void test_push_empty()
+   {  // setup
+      custom::frame_stack s;
+      Spy::reset();
+      // exercise
+      Spy& spy = s.push<Spy>(26);
+      // verify
+      assertUnit(Spy::numAlloc() == 1);
+      assertUnit(Spy::numNondefault() == 1);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(spy == Spy(26));
+      assertUnit(&spy == &s.top<Spy>());
+      assertUnit(s.chunks.size() == 1);
+      assertUnit(s.chunks[0].size == 4096);
+      assertUnit(s.size() == 1);
+      assertUnit(s.numNontrivial == 1);
+   }  // teardown
+
+   // every record is aligned for its type
+   void test_push_aligned()
+   {  // setup
+      struct alignas(64) Line { char bytes[64]; };
+      custom::frame_stack s;
+      // exercise
+      char& c = s.push<char>('x');
+      Line& line = s.push<Line>();
+      char& d = s.push<char>('y');
+      double& f = s.push<double>(1.0);
+      // verify
+      assertUnit(reinterpret_cast<uintptr_t>(&line) % 64 == 0);
+      assertUnit(reinterpret_cast<uintptr_t>(&f) % alignof(double) == 0);
+      assertUnit((void*)&c < (void*)&line);
+      assertUnit((void*)&line < (void*)&d);
+      assertUnit(s.numNontrivial == 0);
+      assertUnit(s.size() == 4);
+   }  // teardown
+
+   // filling a chunk moves on to a bigger one
+   void test_push_newChunk()
+   {  // setup
+      custom::frame_stack s(128);
+      // exercise
+      for (int i = 0; i < 20; i++)
+         s.push<int>(i);
+      // verify
+      assertUnit(s.chunks.size() >= 2);
+      assertUnit(s.chunks[1].size == 256);
+      assertUnit(s.iChunk == s.chunks.size() - 1);
+      bool same = true;
+      for (int i = 20; i-- > 0; )
+      {
+         same = same && s.top<int>() == i;
+         s.pop<int>();
+      }
+      assertUnit(same);
+      assertUnit(s.empty());
+      assertUnit(s.iChunk == 0);
+   }  // teardown
+
+   // a record bigger than a chunk gets a chunk of its own
+   void test_push_tooBigForChunk()
+   {  // setup
+      struct Big { char bytes[1000]; };
+      custom::frame_stack s(64);
+      s.push<int>(7);
+      // exercise
+      Big& big = s.push<Big>();
+      // verify
+      assertUnit(s.chunks.size() == 2);
+      assertUnit(s.chunks[1].size >= 1000);
+      assertUnit((unsigned char*)&big >= s.chunks[1].data);
+      s.pop<Big>();
+      assertUnit(s.iChunk == 0);
+      assertUnit(s.top<int>() == 7);
+   }  // teardown
+
+   // asking for empty chunks still gets chunks that hold a record
+   void test_push_zeroChunk()
+   {  // setup
+      custom::frame_stack s(0);
+      // exercise
+      s.push<int>(7);
+      s.push<double>(2.5);
+      // verify
+      assertUnit(s.chunks.size() >= 1);
+      assertUnit(s.chunks[0].size > 0);
+      assertUnit(s.top<double>() == 2.5);
+      s.pop<double>();
+      assertUnit(s.top<int>() == 7);
+      assertUnit(s.size() == 1);
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // pop runs the destructor through the header
+   void test_pop_standard()
+   {  // setup
+      custom::frame_stack s;
+      setupStandardFixture(s);
+      Spy::reset();
+      // exercise
+      s.pop();
+      // verify
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(Spy::numDelete() == 1);
+      assertUnit(s.size() == 3);
+      assertUnit(s.top<Spy>() == Spy(67));
+   }  // teardown
+
+   // pop<T> destroys the record as a T
+   void test_pop_typed()
+   {  // setup
+      custom::frame_stack s;
+      setupStandardFixture(s);
+      unsigned char* next = s.next;
+      s.push<int>(99);
+      Spy::reset();
+      // exercise
+      s.pop<int>();
+      s.pop<Spy>();
+      // verify
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(s.size() == 3);
+      assertUnit(s.next < next);
+      assertUnit(s.numNontrivial == 3);
+   }  // teardown
+
+   // space freed by pop is handed to the next push
+   void test_pop_reusesChunks()
+   {  // setup
+      custom::frame_stack s(64);
+      for (int i = 0; i < 100; i++)
+         s.push<long>(i);
+      size_t numChunks = s.chunks.size();
+      unsigned char* lastChunk = s.chunks.back().data;
+      for (int i = 0; i < 100; i++)
+         s.pop<long>();
+      // exercise
+      for (int i = 0; i < 100; i++)
+         s.push<long>(i);
+      // verify
+      assertUnit(s.chunks.size() == numChunks);
+      assertUnit(s.chunks.back().data == lastChunk);
+      assertUnit(s.size() == 100);
+   }  // teardown
+
+   // unwinding to a mark destroys only what came after it
+   void test_unwind_destroys()
+   {  // setup
+      custom::frame_stack s;
+      setupStandardFixture(s);
+      custom::frame_stack::mark_type m = s.mark();
+      s.push<Spy>(11);
+      s.push<int>(12);
+      s.push<Spy>(13);
+      Spy::reset();
+      // exercise
+      s.unwind(m);
+      // verify
+      assertUnit(Spy::numDestructor() == 2);
+      assertUnit(Spy::numDelete() == 2);
+      assertStandardFixture(s);
+   }  // teardown
+
+   // with nothing to destroy, unwind jumps straight back
+   void test_unwind_trivial()
+   {  // setup
+      custom::frame_stack s;
+      setupStandardFixture(s);
+      custom::frame_stack::mark_type m = s.mark();
+      unsigned char* next = s.next;
+      for (int i = 0; i < 50; i++)
+         s.push<double>(i);
+      Spy::reset();
+      // exercise
+      s.unwind(m);
+      // verify
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(s.next == next);
+      assertStandardFixture(s);
+   }  // teardown
+
+   // unwinding steps back over chunk boundaries
+   void test_unwind_acrossChunks()
+   {  // setup
+      custom::frame_stack s(64);
+      s.push<int>(1);
+      custom::frame_stack::mark_type m = s.mark();
+      for (int i = 0; i < 40; i++)
+         s.push<std::string>(std::to_string(i));
+      assertUnit(s.iChunk > 0);
+      // exercise
+      s.unwind(m);
+      // verify
+      assertUnit(s.iChunk == 0);
+      assertUnit(s.size() == 1);
+      assertUnit(s.top<int>() == 1);
+      size_t numChunks = s.chunks.size();
+      s.push<int>(2);
+      assertUnit(s.top<int>() == 2);
+      assertUnit(s.chunks.size() == numChunks);
+   }  // teardown
+
+   // clear destroys everything and keeps the chunks
+   void test_clear_standard()
+   {  // setup
+      custom::frame_stack s;
+      setupStandardFixture(s);
+      Spy::reset();
+      // exercise
+      s.clear();
+      // verify
+      assertUnit(Spy::numDestructor() == 4);
+      assertUnit(s.empty());
+      assertUnit(s.last == nullptr);
+      assertUnit(s.chunks.size() == 1);
+      assertUnit(s.numNontrivial == 0);
+   }  // teardown
+
+   /*************************************************************
+    * SETUP STANDARD FIXTURE
+    *    +----+----+----+----+
+    *    | 26 | 49 | 67 | 89 |
+    *    +----+----+----+----+
+    *************************************************************/
+   void setupStandardFixture(custom::frame_stack& s)
+   {
+      s.push<Spy>(26);
+      s.push<Spy>(49);
+      s.push<Spy>(67);
+      s.push<Spy>(89);
+   }
+
+   /*************************************************************
+    * VERIFY STANDARD FIXTURE
+    *    +----+----+----+----+
+    *    | 26 | 49 | 67 | 89 |
+    *    +----+----+----+----+
+    *************************************************************/
+   void assertStandardFixtureParameters(const custom::frame_stack& s,
+                                        int line, const char* function)
+   {
+      assertIndirect(s.size() == 4);
+      assertIndirect(s.numNontrivial == 4);
+      int expected[] = { 89, 67, 49, 26 };
+      const custom::frame_stack::Header* header = s.last;
+      for (int value : expected)
+      {
+         assertIndirect(header != nullptr && *static_cast<const Spy*>(header->object) == Spy(value));
+         header = header ? header->prev : nullptr;
+      }
+      assertIndirect(header == nullptr);
+   }
+
+};
+
+#endif // DEBUG
@@ -0,0 +1,567 @@
+/***********************************************************************
+ * Header:
+ *    TEST HASH
+ * Summary:
+ *    Unit tests for unordered_set and unordered_map
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "hash.h"
+#include "unitTest.h"
+#include "spy.h"
+
+#include <iostream>
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <unordered_set>
+
+/*************************************************************
+ * SPY HASH
+ * Hash a Spy by its value, empty Spys hash to zero
+ *************************************************************/
+struct SpyHash
+{
+   size_t operator () (const Spy& s) const
+   {
+      return s.empty() ? 0 : std::hash<int>()(s.get());
+   }
+};
+
+/*************************************************************
+ * FRAGILE
+ * An int whose copy constructor throws once copiesLeft runs
+ * out, counting how many are alive
+ *************************************************************/
+struct Fragile
+{
+   Fragile(int value) : value(value) { numLive++; }
+   Fragile(const Fragile& rhs) : value(rhs.value)
+   {
+      if (copiesLeft-- == 0)
+         throw std::runtime_error("Fragile: no more copies");
+      numLive++;
+   }
+   ~Fragile() { numLive--; }
+   bool operator == (const Fragile& rhs) const { return value == rhs.value; }
+
+   int value;
+   static inline int numLive = 0;
+   static inline int copiesLeft = 0;
+};
+
+struct FragileHash
+{
+   size_t operator () (const Fragile& f) const { return std::hash<int>()(f.value); }
+};
+
+class TestHash : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_buckets();
+      test_constructCopy_standard();
+      test_constructCopy_throws();
+      test_constructMove_standard();
+      test_destructor_standard();
+
+      // Access
+      test_find_empty();
+      test_find_standard();
+      test_find_missing();
+      test_find_heterogeneous();
+      test_iterator_standard();
+
+      // Insert
+      test_insert_empty();
+      test_insert_duplicate();
+      test_insertMove_standard();
+      test_insert_grow();
+      test_reserve_noRehash();
+      test_mapSubscript_standard();
+      test_mapAt_missing();
+
+      // Remove
+      test_erase_missing();
+      test_erase_standard();
+      test_erase_shiftsRun();
+      test_clear_standard();
+      test_random_againstStd();
+
+      report("Hash");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // default constructor, no allocations
+   void test_construct_default()
+   {  // setup
+      Spy::reset();
+      // exercise
+      custom::unordered_set<Spy, SpyHash> s;
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(s.slots.size() == 0);
+      assertUnit(s.controls.size() == 0);
+      assertUnit(s.numElements == 0);
+   }  // teardown
+
+   // ask for a bucket count, get the next power of two
+   void test_construct_buckets()
+   {  // setup
+      // exercise
+      custom::unordered_set<int> s(100);
+      // verify
+      assertUnit(s.bucket_count() == 128);
+      assertUnit(s.controls.size() == 128 + 16);
+      assertUnit(s.size() == 0);
+      assertUnit(s.begin() == s.end());
+   }  // teardown
+
+   // copy constructor copies each element once
+   void test_constructCopy_standard()
+   {  // setup
+      custom::unordered_set<Spy, SpyHash> sSrc;
+      setupStandardFixture(sSrc);
+      Spy::reset();
+      // exercise
+      custom::unordered_set<Spy, SpyHash> sDest(sSrc);
+      // verify
+      assertUnit(Spy::numCopy() == 4);
+      assertUnit(Spy::numAlloc() == 4);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertStandardFixture(sSrc);
+      assertStandardFixture(sDest);
+   }  // teardown
+
+   // a copy that throws part way leaves nothing alive behind it
+   void test_constructCopy_throws()
+   {  // setup
+      Fragile::numLive = 0;
+      Fragile::copiesLeft = 1000;
+      custom::unordered_set<Fragile, FragileHash> sSrc;
+      for (int i = 0; i < 10; i++)
+         sSrc.insert(Fragile(i));
+      Fragile::copiesLeft = 5;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::unordered_set<Fragile, FragileHash> sDest(sSrc);
+      }
+      catch (const std::runtime_error&)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(Fragile::numLive == 10);   // sSrc's only
+      assertUnit(sSrc.size() == 10);
+   }  // teardown
+
+   // move constructor steals the buckets
+   void test_constructMove_standard()
+   {  // setup
+      custom::unordered_set<Spy, SpyHash> sSrc;
+      setupStandardFixture(sSrc);
+      Spy::reset();
+      // exercise
+      custom::unordered_set<Spy, SpyHash> sDest(std::move(sSrc));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(sSrc.size() == 0);
+      assertStandardFixture(sDest);
+   }  // teardown
+
+   // destructor destroys every element
+   void test_destructor_standard()
+   {  // setup
+      {
+         custom::unordered_set<Spy, SpyHash> s;
+         setupStandardFixture(s);
+         Spy::reset();
+      }  // exercise
+      // verify
+      assertUnit(Spy::numDestructor() == 4);
+      assertUnit(Spy::numDelete() == 4);
+   }
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // find in an empty table does not hash
+   void test_find_empty()
+   {  // setup
+      custom::unordered_set<Spy, SpyHash> s;
+      Spy key(26);
+      Spy::reset();
+      // exercise
+      auto it = s.find(key);
+      // verify
+      assertUnit(it == s.end());
+      assertUnit(Spy::numEquals() == 0);
+   }  // teardown
+
+   // find an element that is there: one real comparison
+   void test_find_standard()
+   {  // setup
+      custom::unordered_set<Spy, SpyHash> s;
+      setupStandardFixture(s);
+      Spy key(67);
+      Spy::reset();
+      // exercise
+      auto it = s.find(key);
+      // verify
+      assertUnit(it != s.end());
+      if (it != s.end())
+         assertUnit((*it).get() == 67);
+      assertUnit(Spy::numEquals() == 1);   // only the matching bucket is compared
+      assertUnit(Spy::numCopy() == 0);
+   }  // teardown
+
+   // find an element that is not there
+   void test_find_missing()
+   {  // setup
+      custom::unordered_set<Spy, SpyHash> s;
+      setupStandardFixture(s);
+      Spy key(50);
+      Spy::reset();
+      // exercise
+      auto it = s.find(key);
+      // verify
+      assertUnit(it == s.end());
+      assertUnit(Spy::numCopy() == 0);
+      assertStandardFixture(s);
+   }  // teardown
+
+   // find a std::string key with a string_view and a const char *
+   void test_find_heterogeneous()
+   {  // setup
+      custom::unordered_set<std::string, custom::string_hash, std::equal_to<>> s;
+      s.insert("alpha");
+      s.insert("beta");
+      // exercise
+      auto it = s.find(std::string_view("beta"));
+      bool found = s.contains("alpha");
+      bool missing = s.contains("gamma");
+      // verify
+      assertUnit(it != s.end());
+      if (it != s.end())
+         assertUnit(*it == "beta");
+      assertUnit(found);
+      assertUnit(!missing);
+   }  // teardown
+
+   // the iterator visits every element exactly once
+   void test_iterator_standard()
+   {  // setup
+      custom::unordered_set<int> s;
+      for (int i = 0; i < 100; i++)
+         s.insert(i * 3);
+      int sum = 0;
+      int count = 0;
+      // exercise
+      for (auto it = s.begin(); it != s.end(); ++it)
+      {
+         sum += *it;
+         count++;
+      }
+      // verify
+      assertUnit(count == 100);
+      assertUnit(sum == 3 * 99 * 100 / 2);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // insert into an empty table allocates the smallest table
+   void test_insert_empty()
+   {  // setup
+      custom::unordered_set<Spy, SpyHash> s;
+      Spy key(26);
+      Spy::reset();
+      // exercise
+      auto result = s.insert(key);
+      // verify
+      assertUnit(result.second == true);
+      assertUnit(result.first != s.end());
+      assertUnit(Spy::numCopy() == 1);
+      assertUnit(Spy::numAlloc() == 1);
+      assertUnit(s.size() == 1);
+      assertUnit(s.bucket_count() == 16);
+   }  // teardown
+
+   // insert a key that is already there does not copy it
+   void test_insert_duplicate()
+   {  // setup
+      custom::unordered_set<Spy, SpyHash> s;
+      setupStandardFixture(s);
+      Spy key(49);
+      Spy::reset();
+      // exercise
+      auto result = s.insert(key);
+      // verify
+      assertUnit(result.second == false);
+      assertUnit(result.first != s.end());
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertStandardFixture(s);
+   }  // teardown
+
+   // insert by move does not copy
+   void test_insertMove_standard()
+   {  // setup
+      custom::unordered_set<Spy, SpyHash> s;
+      setupStandardFixture(s);
+      Spy key(99);
+      Spy::reset();
+      // exercise
+      auto result = s.insert(std::move(key));
+      // verify
+      assertUnit(result.second == true);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 1);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(key.empty());
+      assertUnit(s.size() == 5);
+   }  // teardown
+
+   // the table doubles when it is more than 4/5 full
+   void test_insert_grow()
+   {  // setup
+      custom::unordered_set<int> s;
+      // exercise
+      for (int i = 0; i < 12; i++)
+         s.insert(i);
+      size_t bucketsBefore = s.bucket_count();
+      s.insert(12);
+      // verify
+      assertUnit(bucketsBefore == 16);
+      assertUnit(s.bucket_count() == 32);
+      assertUnit(s.size() == 13);
+      for (int i = 0; i < 13; i++)
+         assertUnit(s.contains(i));
+   }  // teardown
+
+   // after reserve, inserting that many never rehashes
+   void test_reserve_noRehash()
+   {  // setup
+      custom::unordered_set<Spy, SpyHash> s;
+      s.reserve(100);
+      size_t buckets = s.bucket_count();
+      Spy::reset();
+      // exercise
+      for (int i = 0; i < 100; i++)
+         s.insert(Spy(i));
+      // verify
+      assertUnit(s.bucket_count() == buckets);
+      assertUnit(Spy::numCopyMove() == 100);  // straight into the bucket
+      assertUnit(s.load_factor() <= s.max_load_factor());
+   }  // teardown
+
+   // map subscript inserts a default and then updates in place
+   void test_mapSubscript_standard()
+   {  // setup
+      custom::unordered_map<std::string, int> m;
+      // exercise
+      m["one"] = 1;
+      m["two"] = 2;
+      m["one"] += 10;
+      // verify
+      assertUnit(m.size() == 2);
+      assertUnit(m.at("one") == 11);
+      assertUnit(m.at("two") == 2);
+   }  // teardown
+
+   // map at throws when the key is not there
+   void test_mapAt_missing()
+   {  // setup
+      custom::unordered_map<int, int> m{ {1, 10}, {2, 20} };
+      bool thrown = false;
+      // exercise
+      try
+      {
+         m.at(3);
+      }
+      catch (const std::out_of_range&)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(m.size() == 2);
+   }  // teardown
+
+   /***************************************
+    * ERASE
+    ***************************************/
+
+   // erase something that is not there
+   void test_erase_missing()
+   {  // setup
+      custom::unordered_set<Spy, SpyHash> s;
+      setupStandardFixture(s);
+      Spy key(50);
+      Spy::reset();
+      // exercise
+      size_t num = s.erase(key);
+      // verify
+      assertUnit(num == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertStandardFixture(s);
+   }  // teardown
+
+   // erase destroys the element and leaves no tombstone
+   void test_erase_standard()
+   {  // setup
+      custom::unordered_set<Spy, SpyHash> s;
+      setupStandardFixture(s);
+      Spy key(49);
+      Spy::reset();
+      // exercise
+      size_t num = s.erase(key);
+      // verify
+      assertUnit(num == 1);
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(Spy::numDelete() == 1);
+      assertUnit(s.size() == 3);
+      assertUnit(!s.contains(Spy(49)));
+      assertUnit(s.contains(Spy(26)));
+      assertUnit(s.contains(Spy(67)));
+      assertUnit(s.contains(Spy(89)));
+      assertUnit(countControls(s) == 3);
+   }  // teardown
+
+   // erase from the front of a long run shifts the rest back
+   void test_erase_shiftsRun()
+   {  // setup
+      //    every key lands on the same home, one long run
+      custom::unordered_set<int, ZeroHash> s;
+      for (int i = 0; i < 10; i++)
+         s.insert(i);
+      // exercise
+      s.erase(0);
+      // verify
+      assertUnit(s.size() == 9);
+      for (int i = 1; i < 10; i++)
+         assertUnit(s.contains(i));
+      assertUnit(countControls(s) == 9);
+      assertUnit(s.controls[9] == decltype(s)::EMPTY);
+   }  // teardown
+
+   // clear destroys everything and keeps the buckets
+   void test_clear_standard()
+   {  // setup
+      custom::unordered_set<Spy, SpyHash> s;
+      setupStandardFixture(s);
+      size_t buckets = s.bucket_count();
+      Spy::reset();
+      // exercise
+      s.clear();
+      // verify
+      assertUnit(Spy::numDestructor() == 4);
+      assertUnit(s.size() == 0);
+      assertUnit(s.bucket_count() == buckets);
+      assertUnit(countControls(s) == 0);
+      assertUnit(s.begin() == s.end());
+   }  // teardown
+
+   // a long random mix of insert and erase agrees with std
+   void test_random_againstStd()
+   {  // setup
+      custom::unordered_set<int> s;
+      std::unordered_set<int> sStd;
+      unsigned int seed = 42;
+      bool same = true;
+      // exercise
+      for (int i = 0; i < 20000; i++)
+      {
+         seed = seed * 1103515245u + 12345u;
+         int key = (int)((seed >> 8) % 2000);
+         if ((seed >> 4) % 3 != 0)
+            same = same && s.insert(key).second == sStd.insert(key).second;
+         else
+            same = same && s.erase(key) == sStd.erase(key);
+      }
+      // verify
+      assertUnit(same);
+      assertUnit(s.size() == sStd.size());
+      for (int key = 0; key < 2000; key++)
+         same = same && s.contains(key) == (sStd.count(key) == 1);
+      assertUnit(same);
+   }  // teardown
+
+   /*************************************************************
+    * ZERO HASH
+    * Every key collides
+    *************************************************************/
+   struct ZeroHash
+   {
+      size_t operator () (int) const { return 0; }
+   };
+
+   /*************************************************************
+    * COUNT CONTROLS
+    * How many buckets are marked full
+    *************************************************************/
+   template <class Table>
+   size_t countControls(const Table& t)
+   {
+      size_t num = 0;
+      for (size_t i = 0; i < t.slots.size(); i++)
+         if (t.controls[i] != Table::EMPTY)
+            num++;
+      return num;
+   }
+
+   /*************************************************************
+    * SETUP STANDARD FIXTURE
+    *    { 26, 49, 67, 89 }
+    *************************************************************/
+   void setupStandardFixture(custom::unordered_set<Spy, SpyHash>& s)
+   {
+      s.insert(Spy(26));
+      s.insert(Spy(49));
+      s.insert(Spy(67));
+      s.insert(Spy(89));
+   }
+
+   /*************************************************************
+    * VERIFY STANDARD FIXTURE
+    *    { 26, 49, 67, 89 }
+    *************************************************************/
+   void assertStandardFixtureParameters(const custom::unordered_set<Spy, SpyHash>& s,
+                                        int line, const char* function)
+   {
+      assertIndirect(s.size() == 4);
+      assertIndirect(s.bucket_count() == 16);
+      assertIndirect(countControls(s) == 4);
+      assertIndirect(s.contains(Spy(26)));
+      assertIndirect(s.contains(Spy(49)));
+      assertIndirect(s.contains(Spy(67)));
+      assertIndirect(s.contains(Spy(89)));
+   }
+
+};
+
+#endif // DEBUG
@@ -0,0 +1,127 @@
+/***********************************************************************
+ * Header:
+ *    TEST HINTED STACK
+ * Summary:
+ *    Unit tests for hinted_stack
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "hinted_stack.h"
+#include "unitTest.h"
+
+#include <iostream>
+#include <cassert>
+#include <deque>
+
+class TestHintedStack : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_reserves();
+
+      // Destructor
+      test_destructor_records();
+      test_destructor_afterPops();
+      test_destructor_popTo();
+      test_destructor_deque();
+
+      report("HintedStack");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // it reserves what the hint suggests
+   void test_construct_reserves()
+   {  // setup
+      custom::sizing_hint hint;
+      hint.record(25);
+      // exercise
+      custom::hinted_stack<int> s(hint);
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.items.container.capacity() == 25);
+      assertUnit(s.highWater == 0);
+   }  // teardown
+
+   /***************************************
+    * DESTRUCTOR
+    ***************************************/
+
+   // going away, it tells the hint how big it is
+   void test_destructor_records()
+   {  // setup
+      custom::sizing_hint hint;
+      {
+         custom::hinted_stack<int> s(hint);
+         for (int i = 0; i < 12; i++)
+            s.push(i);
+      }  // exercise
+      // verify
+      assertUnit(hint.num_recorded() == 1);
+      assertUnit(hint.suggested() == 12);
+   }  // teardown
+
+   // the most it held, even after pops
+   void test_destructor_afterPops()
+   {  // setup
+      custom::sizing_hint hint;
+      {
+         custom::hinted_stack<int> s(hint);
+         for (int i = 0; i < 40; i++)
+            s.push(i);
+         s.pop_n(30);
+         for (int i = 0; i < 5; i++)
+            s.push(i);
+         s.pop();
+      }  // exercise
+      // verify
+      assertUnit(hint.num_recorded() == 1);
+      assertUnit(hint.suggested() == 40);
+      {
+         custom::hinted_stack<int> s(hint);
+         assertUnit(s.items.container.capacity() == 40);
+      }
+      assertUnit(hint.num_recorded() == 2);
+   }  // teardown
+
+   // pop_to counts as a pop
+   void test_destructor_popTo()
+   {  // setup
+      custom::sizing_hint hint;
+      {
+         custom::hinted_stack<int> s(hint);
+         for (int i = 0; i < 9; i++)
+            s.push(i);
+         s.pop_to(2);
+         assertUnit(s.top() == 1);
+      }  // exercise
+      // verify
+      assertUnit(hint.suggested() == 9);
+   }  // teardown
+
+   // a container that cannot reserve still records
+   void test_destructor_deque()
+   {  // setup
+      custom::sizing_hint hint;
+      {
+         custom::hinted_stack<int, std::deque<int>> s(hint);
+         for (int i = 0; i < 7; i++)
+            s.push(i);
+      }  // exercise
+      // verify
+      assertUnit(hint.num_recorded() == 1);
+      assertUnit(hint.suggested() == 7);
+   }  // teardown
+};
+
+#endif // DEBUG
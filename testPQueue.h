@@ -0,0 +1,528 @@
+/***********************************************************************
+ * Header:
+ *    TEST PQUEUE
+ * Summary:
+ *    Unit tests for priority_queue
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "priority_queue.h"
+#include "unitTest.h"
+#include "spy.h"
+
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <functional>
+
+#include <queue>
+#include <vector>
+
+class TestPQueue : public UnitTest
+{
+   // the filler slots in front of a 4-ary heap's root
+   static const int ROOT = (int)custom::priority_queue<Spy>::ROOT;
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructCopy_standard();
+      test_constructMove_standard();
+      test_constructRange_empty();
+      test_constructRange_standard();
+      test_constructContainer_standard();
+
+      // Access
+      test_top_empty();
+      test_top_standard();
+
+      // Insert
+      test_push_empty();
+      test_push_standard();
+      test_push_newTop();
+      test_pushMove_standard();
+      test_emplace_standard();
+      test_pushRange_empty();
+      test_pushRange_small();
+      test_push_siblingsOnOneLine();
+
+      // Remove
+      test_pop_empty();
+      test_pop_one();
+      test_pop_standard();
+      test_pop_sorted();
+      test_pop_sortedBinary();
+      test_pop_sortedGreater();
+      test_pop_sortedVector();
+
+      report("PQueue");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // default constructor, no allocations
+   void test_construct_default()
+   {  // setup
+      Spy::reset();
+      // exercise
+      custom::priority_queue<Spy> pq;
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(pq.container.size() == 0);
+      assertUnit(pq.container.capacity() == 0);
+   }  // teardown
+
+   // copy constructor copies the heap as-is
+   void test_constructCopy_standard()
+   {  // setup
+      custom::priority_queue<Spy> pqSrc;
+      setupStandardFixture(pqSrc);
+      Spy::reset();
+      // exercise
+      custom::priority_queue<Spy> pqDest(pqSrc);
+      // verify
+      assertUnit(Spy::numCopy() == 6 + ROOT);  // the fillers too
+      assertUnit(Spy::numAlloc() == 6);
+      assertUnit(Spy::numLessthan() == 0);
+      assertStandardFixture(pqSrc);
+      assertStandardFixture(pqDest);
+   }  // teardown
+
+   // move constructor steals the buffer
+   void test_constructMove_standard()
+   {  // setup
+      custom::priority_queue<Spy> pqSrc;
+      setupStandardFixture(pqSrc);
+      Spy::reset();
+      // exercise
+      custom::priority_queue<Spy> pqDest(std::move(pqSrc));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(pqSrc.container.size() == 0);
+      assertStandardFixture(pqDest);
+   }  // teardown
+
+   // range constructor with nothing in it
+   void test_constructRange_empty()
+   {  // setup
+      std::vector<Spy> v;
+      Spy::reset();
+      // exercise
+      custom::priority_queue<Spy> pq(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(pq.container.size() == 0);
+   }  // teardown
+
+   // range constructor heapifies the input
+   void test_constructRange_standard()
+   {  // setup
+      std::vector<Spy> v{Spy(3), Spy(9), Spy(1), Spy(7), Spy(5), Spy(8)};
+      Spy::reset();
+      // exercise
+      custom::priority_queue<Spy> pq(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 6);
+      assertUnit(pq.size() == 6);
+      assertUnit(isHeap(pq));
+      assertUnit(pq.top() == Spy(9));
+   }  // teardown
+
+   // container constructor heapifies the container
+   void test_constructContainer_standard()
+   {  // setup
+      custom::vector<Spy, custom::aligned_allocator<Spy>> v{Spy(3), Spy(9), Spy(1), Spy(7), Spy(5), Spy(8)};
+      Spy::reset();
+      // exercise
+      custom::priority_queue<Spy> pq(std::less<Spy>(), std::move(v));
+      // verify
+      assertUnit(Spy::numCopy() == ROOT);      // the fillers only
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(pq.size() == 6);
+      assertUnit(isHeap(pq));
+      assertUnit(pq.top() == Spy(9));
+   }  // teardown
+
+   /***************************************
+    * TOP
+    ***************************************/
+
+   // top of an empty heap throws
+   void test_top_empty()
+   {  // setup
+      custom::priority_queue<Spy> pq;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         pq.top();
+      }
+      catch (const std::out_of_range&)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   // top is the largest element
+   void test_top_standard()
+   {  // setup
+      custom::priority_queue<Spy> pq;
+      setupStandardFixture(pq);
+      Spy::reset();
+      // exercise
+      const Spy& s = pq.top();
+      // verify
+      assertUnit(s == Spy(9));
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numLessthan() == 0);
+      assertStandardFixture(pq);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // push onto an empty heap
+   void test_push_empty()
+   {  // setup
+      custom::priority_queue<Spy> pq;
+      Spy s(7);
+      Spy::reset();
+      // exercise
+      pq.push(s);
+      // verify
+      assertUnit(Spy::numCopy() == 1);
+      assertUnit(Spy::numAlloc() == 1);
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(pq.size() == 1);
+      assertUnit(pq.top() == Spy(7));
+   }  // teardown
+
+   // push a small element onto a heap: it stays at the bottom
+   void test_push_standard()
+   {  // setup
+      custom::priority_queue<Spy> pq;
+      setupStandardFixture(pq);
+      Spy s(2);
+      Spy::reset();
+      // exercise
+      pq.push(s);
+      // verify
+      assertUnit(Spy::numCopy() == 1);
+      assertUnit(Spy::numLessthan() == 1);   // compared with its parent only
+      assertUnit(pq.size() == 7);
+      assertUnit(isHeap(pq));
+      assertUnit(pq.top() == Spy(9));
+   }  // teardown
+
+   // push a large element: it rises to the root
+   void test_push_newTop()
+   {  // setup
+      custom::priority_queue<Spy> pq;
+      setupStandardFixture(pq);
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      pq.push(s);
+      // verify
+      assertUnit(Spy::numCopy() == 1);
+      assertUnit(pq.size() == 7);
+      assertUnit(isHeap(pq));
+      assertUnit(pq.top() == Spy(99));
+   }  // teardown
+
+   // push by move does not copy
+   void test_pushMove_standard()
+   {  // setup
+      custom::priority_queue<Spy> pq;
+      setupStandardFixture(pq);
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      pq.push(std::move(s));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(s.empty());
+      assertUnit(isHeap(pq));
+      assertUnit(pq.top() == Spy(99));
+   }  // teardown
+
+   // emplace builds the element from its arguments
+   void test_emplace_standard()
+   {  // setup
+      custom::priority_queue<Spy> pq;
+      setupStandardFixture(pq);
+      Spy::reset();
+      // exercise
+      pq.emplace(42);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(isHeap(pq));
+      assertUnit(pq.top() == Spy(42));
+   }  // teardown
+
+   // push an empty range does nothing
+   void test_pushRange_empty()
+   {  // setup
+      custom::priority_queue<Spy> pq;
+      setupStandardFixture(pq);
+      std::vector<Spy> v;
+      Spy::reset();
+      // exercise
+      pq.push_range(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numLessthan() == 0);
+      assertStandardFixture(pq);
+   }  // teardown
+
+   // push a range smaller than the heap: sift each one up
+   void test_pushRange_small()
+   {  // setup
+      custom::priority_queue<Spy> pq;
+      setupStandardFixture(pq);
+      std::vector<Spy> v{Spy(10), Spy(0)};
+      Spy::reset();
+      // exercise
+      pq.push_range(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 2);
+      assertUnit(pq.size() == 8);
+      assertUnit(isHeap(pq));
+      assertUnit(pq.top() == Spy(10));
+   }  // teardown
+
+   // the root follows D - 1 fillers, so with a line-aligned buffer
+   // every run of siblings lies within one cache line
+   void test_push_siblingsOnOneLine()
+   {  // setup
+      custom::priority_queue<unsigned long long> pq;
+      const size_t D = 4;
+      // exercise
+      for (unsigned long long i = 0; i < 1000; i++)
+         pq.push((i * 7919) % 1000);
+      // verify
+      assertUnit(pq.size() == 1000);
+      assertUnit((uintptr_t)&pq.container[0] % 64 == 0);
+      assertUnit((uintptr_t)&pq.at(1) % (D * sizeof(unsigned long long)) == 0);
+      bool oneLine = true;
+      for (size_t first = 1; first < pq.size(); first += D)
+      {
+         size_t last = first + D - 1 < pq.size() ? first + D - 1 : pq.size() - 1;
+         oneLine = oneLine && (uintptr_t)&pq.at(first) / 64 == (uintptr_t)&pq.at(last) / 64;
+      }
+      assertUnit(oneLine);
+      assertUnit(isHeap(pq));
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // pop from an empty heap does nothing
+   void test_pop_empty()
+   {  // setup
+      custom::priority_queue<Spy> pq;
+      Spy::reset();
+      // exercise
+      pq.pop();
+      // verify
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(pq.container.size() == 0);
+   }  // teardown
+
+   // pop the only element
+   void test_pop_one()
+   {  // setup
+      custom::priority_queue<Spy> pq;
+      pq.push(Spy(7));
+      Spy::reset();
+      // exercise
+      pq.pop();
+      // verify
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(Spy::numDelete() == 1);
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(pq.empty());
+   }  // teardown
+
+   // pop the top off of the standard heap
+   void test_pop_standard()
+   {  // setup
+      custom::priority_queue<Spy> pq;
+      setupStandardFixture(pq);
+      Spy::reset();
+      // exercise
+      pq.pop();
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDelete() == 1);      // delete [9]
+      assertUnit(pq.size() == 5);
+      assertUnit(isHeap(pq));
+      assertUnit(pq.top() == Spy(8));
+   }  // teardown
+
+   // popping everything yields a sorted sequence
+   void test_pop_sorted()
+   {  // setup
+      custom::priority_queue<int> pq;
+      for (int i = 0; i < 1000; i++)
+         pq.push((i * 7919) % 1000);
+      bool sorted = true;
+      // exercise
+      for (int expected = 999; expected >= 0; expected--)
+      {
+         sorted = sorted && pq.top() == expected;
+         pq.pop();
+      }
+      // verify
+      assertUnit(sorted);
+      assertUnit(pq.empty());
+   }  // teardown
+
+   // a binary heap behaves the same as the 4-ary one
+   void test_pop_sortedBinary()
+   {  // setup
+      custom::priority_queue<int, custom::vector<int>, std::less<int>, 2> pq;
+      custom::vector<int> v;
+      for (int i = 0; i < 1000; i++)
+         v.push_back((i * 7919) % 1000);
+      pq.push_range(v.begin(), v.end());
+      bool sorted = true;
+      // exercise
+      for (int expected = 999; expected >= 0; expected--)
+      {
+         sorted = sorted && pq.top() == expected;
+         pq.pop();
+      }
+      // verify
+      assertUnit(sorted);
+      assertUnit(pq.empty());
+   }  // teardown
+
+   // std::greater gives a min-heap
+   void test_pop_sortedGreater()
+   {  // setup
+      custom::priority_queue<int, custom::vector<int>, std::greater<int>> pq;
+      for (int i = 0; i < 1000; i++)
+         pq.push((i * 7919) % 1000);
+      bool sorted = true;
+      // exercise
+      for (int expected = 0; expected < 1000; expected++)
+      {
+         sorted = sorted && pq.top() == expected;
+         pq.pop();
+      }
+      // verify
+      assertUnit(sorted);
+      assertUnit(pq.empty());
+   }  // teardown
+
+   // agrees with std::priority_queue when built on std::vector
+   void test_pop_sortedVector()
+   {  // setup
+      custom::priority_queue<int, std::vector<int>, std::less<int>, 8> pq;
+      std::priority_queue<int> pqStd;
+      for (int i = 0; i < 1000; i++)
+      {
+         pq.push((i * 104729) % 997);
+         pqStd.push((i * 104729) % 997);
+      }
+      bool same = true;
+      // exercise
+      while (!pqStd.empty())
+      {
+         same = same && !pq.empty() && pq.top() == pqStd.top();
+         pq.pop();
+         pqStd.pop();
+      }
+      // verify
+      assertUnit(same);
+      assertUnit(pq.empty());
+   }  // teardown
+
+   /*************************************************************
+    * IS HEAP
+    * Every parent must be no smaller than any of its D children
+    *************************************************************/
+   template <class T, class Container, class Compare, size_t D>
+   bool isHeap(const custom::priority_queue<T, Container, Compare, D>& pq)
+   {
+      for (size_t i = 1; i < pq.size(); i++)
+         if (pq.compare(pq.at((i - 1) / D), pq.at(i)))
+            return false;
+      return true;
+   }
+
+   /*************************************************************
+    * SETUP STANDARD FIXTURE
+    * after the ROOT fillers:
+    *      0    1    2    3    4    5
+    *    +----+----+----+----+----+----+
+    *    |  9 |  5 |  8 |  1 |  7 |  3 |
+    *    +----+----+----+----+----+----+
+    * root 9 with children 5,8,1,7 and 3 the child of 5
+    *************************************************************/
+   void setupStandardFixture(custom::priority_queue<Spy>& pq)
+   {
+      pq.container.reserve(6 + ROOT);
+      for (int i = 0; i < ROOT; i++)
+         pq.container.push_back(Spy());
+      pq.container.push_back(Spy(9));
+      pq.container.push_back(Spy(5));
+      pq.container.push_back(Spy(8));
+      pq.container.push_back(Spy(1));
+      pq.container.push_back(Spy(7));
+      pq.container.push_back(Spy(3));
+   }
+
+   /*************************************************************
+    * VERIFY STANDARD FIXTURE
+    *************************************************************/
+   void assertStandardFixtureParameters(const custom::priority_queue<Spy>& pq,
+                                        int line, const char* function)
+   {
+      assertIndirect(pq.size() == 6);
+      if (pq.size() >= 6)
+      {
+         assertIndirect(pq.at(0) == Spy(9));
+         assertIndirect(pq.at(1) == Spy(5));
+         assertIndirect(pq.at(2) == Spy(8));
+         assertIndirect(pq.at(3) == Spy(1));
+         assertIndirect(pq.at(4) == Spy(7));
+         assertIndirect(pq.at(5) == Spy(3));
+      }
+   }
+
+};
+
+#endif // DEBUG
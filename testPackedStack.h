@@ -0,0 +1,296 @@
+/***********************************************************************
+ * Header:
+ *    TEST PACKED STACK
+ * Summary:
+ *    Unit tests for packed_stack and bit_stack
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "packed_stack.h"
+#include "unitTest.h"
+
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+
+class TestPackedStack : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_valueType();
+
+      // Insert
+      test_push_bits();
+      test_push_wordBoundary();
+      test_push_straddle();
+      test_push_masksWide();
+      test_pushMany_bits();
+      test_pushMany_straddle();
+
+      // Remove
+      test_pop_shrinks();
+      test_pop_overwrite();
+      test_popMany_order();
+      test_random_agrees();
+      test_clear_standard();
+
+      report("PackedStack");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // nothing allocated
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::bit_stack s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.size() == 0);
+      assertUnit(s.words.size() == 0);
+      assertUnit(s.memory_bytes() == 0);
+   }  // teardown
+
+   // the smallest type that holds a value
+   void test_valueType()
+   {  // setup
+      // exercise
+      // verify
+      assertUnit((std::is_same<custom::packed_stack<1>::value_type, bool>::value));
+      assertUnit((std::is_same<custom::packed_stack<3>::value_type, uint8_t>::value));
+      assertUnit((std::is_same<custom::packed_stack<12>::value_type, uint16_t>::value));
+      assertUnit((std::is_same<custom::packed_stack<17>::value_type, uint32_t>::value));
+      assertUnit((std::is_same<custom::packed_stack<64>::value_type, uint64_t>::value));
+      assertUnit(custom::packed_stack<1>::PER_WORD == 64);
+      assertUnit(custom::packed_stack<5>::PER_WORD == 12);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // bools go one to a bit, lowest first
+   void test_push_bits()
+   {  // setup
+      custom::bit_stack s;
+      // exercise
+      s.push(true);
+      s.push(false);
+      s.push(true);
+      s.push(true);
+      // verify
+      assertUnit(s.size() == 4);
+      assertUnit(s.top() == true);
+      assertUnit(s.words.size() == 1);
+      assertUnit((s.words[0] & 0xF) == 0xD);
+   }  // teardown
+
+   // the 65th bit starts a second word
+   void test_push_wordBoundary()
+   {  // setup
+      custom::bit_stack s;
+      for (int i = 0; i < 64; i++)
+         s.push(i % 3 == 0);
+      assertUnit(s.words.size() == 1);
+      // exercise
+      s.push(true);
+      // verify
+      assertUnit(s.words.size() == 2);
+      assertUnit(s.size() == 65);
+      assertUnit(s.top() == true);
+      assertUnit((s.words[1] & 1) == 1);
+   }  // teardown
+
+   // a 5-bit value at bit 60 spans two words
+   void test_push_straddle()
+   {  // setup
+      custom::packed_stack<5> s;
+      for (int i = 0; i < 12; i++)
+         s.push((uint8_t)i);
+      // exercise
+      s.push(27);
+      // verify
+      assertUnit(s.size() == 13);
+      assertUnit(s.words.size() == 2);
+      assertUnit(s.top() == 27);
+      s.pop();
+      assertUnit(s.top() == 11);
+   }  // teardown
+
+   // bits past the width are dropped, not spilled into the next value
+   void test_push_masksWide()
+   {  // setup
+      custom::packed_stack<3> s;
+      // exercise
+      s.push(0xFF);
+      s.push(2);
+      // verify
+      assertUnit(s.top() == 2);
+      s.pop();
+      assertUnit(s.top() == 7);
+   }  // teardown
+
+   // a whole word of bits at once
+   void test_pushMany_bits()
+   {  // setup
+      custom::bit_stack s;
+      s.push(true);
+      // exercise
+      s.push_many(0xF0F0F0F0F0F0F0F0ULL, 64);
+      // verify
+      assertUnit(s.size() == 65);
+      assertUnit(s.words.size() == 2);
+      assertUnit(s.top() == true);          // bit 63 of the word
+      s.pop();
+      s.pop();
+      s.pop();
+      s.pop();
+      assertUnit(s.top() == false);         // bit 59
+   }  // teardown
+
+   // many values at an odd offset
+   void test_pushMany_straddle()
+   {  // setup
+      custom::packed_stack<7> s;
+      s.push(1);
+      s.push(2);
+      uint64_t values = 0;
+      for (uint64_t i = 0; i < 9; i++)
+         values |= (100 + i) << (i * 7);
+      // exercise
+      s.push_many(values, 9);
+      // verify
+      assertUnit(s.size() == 11);
+      bool same = true;
+      for (int i = 8; i >= 0; i--)
+      {
+         if (s.top() != 100 + i)
+            same = false;
+         s.pop();
+      }
+      assertUnit(same);
+      assertUnit(s.top() == 2);
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // words above the top are let go
+   void test_pop_shrinks()
+   {  // setup
+      custom::bit_stack s;
+      for (int i = 0; i < 65; i++)
+         s.push(true);
+      // exercise
+      s.pop();
+      // verify
+      assertUnit(s.size() == 64);
+      assertUnit(s.words.size() == 1);
+   }  // teardown
+
+   // pushing over a popped value replaces it
+   void test_pop_overwrite()
+   {  // setup
+      custom::packed_stack<4> s;
+      s.push(9);
+      s.push(15);
+      s.pop();
+      // exercise
+      s.push(3);
+      // verify
+      assertUnit(s.top() == 3);
+      s.pop();
+      assertUnit(s.top() == 9);
+   }  // teardown
+
+   // pop_many hands back what push_many took
+   void test_popMany_order()
+   {  // setup
+      custom::packed_stack<4> s;
+      s.push(5);
+      s.push_many(0x4321, 4);
+      // exercise
+      uint64_t values = s.pop_many(3);
+      // verify
+      assertUnit(values == 0x432);
+      assertUnit(s.size() == 2);
+      assertUnit(s.top() == 1);
+      assertUnit(s.pop_many(2) == 0x15);
+      assertUnit(s.empty());
+      assertUnit(s.words.size() == 0);
+   }  // teardown
+
+   // any mix of pushes and pops agrees with a plain vector
+   void test_random_agrees()
+   {  // setup
+      custom::packed_stack<13> s;
+      custom::vector<uint16_t> expected;
+      std::mt19937 random(235);
+      // exercise
+      bool same = true;
+      for (int i = 0; i < 20000; i++)
+      {
+         unsigned int choice = random() % 10;
+         if (choice < 5 || expected.empty())
+         {
+            uint16_t value = (uint16_t)(random() & 0x1FFF);
+            s.push(value);
+            expected.push_back(value);
+         }
+         else if (choice < 7)
+         {
+            size_t num = 1 + random() % custom::packed_stack<13>::PER_WORD;
+            uint64_t values = 0;
+            for (size_t j = 0; j < num; j++)
+            {
+               uint16_t value = (uint16_t)(random() & 0x1FFF);
+               values |= (uint64_t)value << (j * 13);
+               expected.push_back(value);
+            }
+            s.push_many(values, num);
+         }
+         else
+         {
+            s.pop();
+            expected.pop_back();
+         }
+         if (s.size() != expected.size() ||
+             (!expected.empty() && s.top() != expected.back()))
+            same = false;
+      }
+      // verify
+      assertUnit(same);
+      assertUnit(s.words.size() == (expected.size() * 13 + 63) / 64);
+   }  // teardown
+
+   // clear empties it
+   void test_clear_standard()
+   {  // setup
+      custom::bit_stack s;
+      for (int i = 0; i < 200; i++)
+         s.push(true);
+      // exercise
+      s.clear();
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.words.size() == 0);
+      s.push(false);
+      assertUnit(s.top() == false);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,301 @@
+/***********************************************************************
+ * Header:
+ *    TEST PER THREAD STACKS
+ * Summary:
+ *    Unit tests for per_thread_stacks
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "per_thread_stacks.h"
+#include "unitTest.h"
+#include "spy.h"
+
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+class TestPerThreadStacks : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_slots();
+      test_slot_padded();
+
+      // Access
+      test_local_sameThread();
+      test_local_otherThread();
+      test_local_twoContainers();
+      test_local_tooManyThreads();
+      test_local_threadsComeAndGo();
+
+      // Insert / Remove
+      test_push_standard();
+      test_pop_standard();
+
+      // Status
+      test_size_allThreads();
+
+      // Drain
+      test_drain_standard();
+      test_drainTo_standard();
+
+      report("PerThreadStacks");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // one slot for every hardware thread, none claimed
+   void test_construct_default()
+   {  // setup
+      Spy::reset();
+      // exercise
+      custom::per_thread_stacks<Spy> s;
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(s.num_slots() >= 1);
+      assertUnit(s.num_threads() == 0);
+      assertUnit(s.empty());
+   }  // teardown
+
+   // as many slots as asked for
+   void test_construct_slots()
+   {  // setup
+      // exercise
+      custom::per_thread_stacks<int> s(3);
+      // verify
+      assertUnit(s.num_slots() == 3);
+      assertUnit(s.num_threads() == 0);
+      assertUnit(s.size() == 0);
+   }  // teardown
+
+   // every stack starts on a cache line of its own
+   void test_slot_padded()
+   {  // setup
+      custom::per_thread_stacks<int> s(4);
+      const size_t line = custom::per_thread_stacks<int>::CACHE_LINE;
+      // exercise
+      uintptr_t first  = reinterpret_cast<uintptr_t>(&s.slot(0));
+      uintptr_t second = reinterpret_cast<uintptr_t>(&s.slot(1));
+      // verify
+      assertUnit(first % line == 0);
+      assertUnit(second % line == 0);
+      assertUnit(second - first >= line);
+      assertUnit(sizeof(custom::per_thread_stacks<int>::Slot) % line == 0);
+   }  // teardown
+
+   /***************************************
+    * LOCAL
+    ***************************************/
+
+   // a thread always gets the same stack, and claims one slot
+   void test_local_sameThread()
+   {  // setup
+      custom::per_thread_stacks<int> s(4);
+      // exercise
+      custom::stack<int>* first = &s.local();
+      custom::stack<int>* second = &s.local();
+      // verify
+      assertUnit(first == second);
+      assertUnit(first == &s.slot(0));
+      assertUnit(s.num_threads() == 1);
+   }  // teardown
+
+   // another thread gets a different stack
+   void test_local_otherThread()
+   {  // setup
+      custom::per_thread_stacks<int> s(4);
+      custom::stack<int>* mine = &s.local();
+      custom::stack<int>* theirs = nullptr;
+      // exercise
+      std::thread other([&]() { theirs = &s.local(); });
+      other.join();
+      // verify
+      assertUnit(theirs != nullptr);
+      assertUnit(mine != theirs);
+      assertUnit(theirs == &s.slot(1));
+      assertUnit(s.num_threads() == 1);       // the other has exited
+      assertUnit(&s.local() == mine);
+   }  // teardown
+
+   // switching between containers finds the right slot in each, and a
+   // slot given up by a thread that exited is claimed again
+   void test_local_twoContainers()
+   {  // setup
+      custom::per_thread_stacks<int> a(2);
+      custom::per_thread_stacks<int> b(2);
+      std::thread other([&]() { b.local(); });
+      other.join();
+      // exercise
+      custom::stack<int>* inA = &a.local();
+      custom::stack<int>* inB = &b.local();
+      // verify
+      assertUnit(inA == &a.slot(0));
+      assertUnit(inB == &b.slot(0));
+      assertUnit(&a.local() == inA);
+      assertUnit(&b.local() == inB);
+   }  // teardown
+
+   // a thread that finds every slot taken gets an exception
+   void test_local_tooManyThreads()
+   {  // setup
+      custom::per_thread_stacks<int> s(1);
+      s.local();
+      bool thrown = false;
+      // exercise
+      std::thread other([&]() {
+         try
+         {
+            s.local();
+         }
+         catch (const std::length_error&)
+         {
+            thrown = true;
+         }
+         });
+      other.join();
+      // verify
+      assertUnit(thrown);
+      assertUnit(s.num_threads() == 1);
+   }  // teardown
+
+   // more threads than slots, one after another, each get a slot
+   void test_local_threadsComeAndGo()
+   {  // setup
+      custom::per_thread_stacks<int> s(1);
+      bool thrown = false;
+      // exercise
+      for (int t = 0; t < 10; t++)
+      {
+         std::thread other([&s, &thrown, t]() {
+            try
+            {
+               s.push(t);
+            }
+            catch (const std::length_error&)
+            {
+               thrown = true;
+            }
+            });
+         other.join();
+      }
+      // verify
+      assertUnit(!thrown);
+      assertUnit(s.num_threads() == 0);
+      assertUnit(s.slot(0).size() == 10);
+      assertUnit(s.slot(0).top() == 9);
+   }  // teardown
+
+   /***************************************
+    * PUSH and POP
+    ***************************************/
+
+   // push goes to the calling thread's stack
+   void test_push_standard()
+   {  // setup
+      custom::per_thread_stacks<Spy> s(2);
+      Spy::reset();
+      // exercise
+      s.push(Spy(26));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 1);
+      assertUnit(s.local().size() == 1);
+      assertUnit(s.slot(1).empty());
+      assertUnit(s.top() == Spy(26));
+   }  // teardown
+
+   // pop comes off the calling thread's stack, last in first out
+   void test_pop_standard()
+   {  // setup
+      custom::per_thread_stacks<int> s(2);
+      s.push(26);
+      s.push(49);
+      // exercise
+      s.pop();
+      // verify
+      assertUnit(s.size() == 1);
+      assertUnit(s.top() == 26);
+   }  // teardown
+
+   /***************************************
+    * SIZE
+    ***************************************/
+
+   // size adds up every thread's stack
+   void test_size_allThreads()
+   {  // setup
+      custom::per_thread_stacks<int> s(4);
+      std::vector<std::thread> threads;
+      // exercise
+      for (int t = 0; t < 4; t++)
+         threads.emplace_back([&s, t]() {
+            for (int i = 0; i <= t; i++)
+               s.push(i);
+            });
+      for (auto& thread : threads)
+         thread.join();
+      // verify
+      assertUnit(s.size() == 1 + 2 + 3 + 4);
+      assertUnit(s.num_threads() == 0);       // they kept their elements but exited
+      assertUnit(!s.empty());
+   }  // teardown
+
+   /***************************************
+    * DRAIN
+    ***************************************/
+
+   // drain hands over every element, top first, and empties every stack
+   void test_drain_standard()
+   {  // setup
+      custom::per_thread_stacks<Spy> s(2);
+      s.push(Spy(26));
+      s.push(Spy(49));
+      std::thread other([&]() { s.push(Spy(67)); });
+      other.join();
+      std::vector<int> values;
+      Spy::reset();
+      // exercise
+      s.drain([&values](Spy&& spy) { values.push_back(spy.get()); });
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numDestructor() == 3);
+      assertUnit(values.size() == 3);
+      assertUnit(values[0] == 49);
+      assertUnit(values[1] == 26);
+      assertUnit(values[2] == 67);
+      assertUnit(s.empty());
+   }  // teardown
+
+   // drain_to moves everything onto one stack
+   void test_drainTo_standard()
+   {  // setup
+      custom::per_thread_stacks<int> s(2);
+      s.push(26);
+      std::thread other([&]() { s.push(49); s.push(67); });
+      other.join();
+      custom::stack<int> out;
+      // exercise
+      s.drain_to(out);
+      // verify
+      assertUnit(s.empty());
+      assertUnit(out.size() == 3);
+      assertUnit(out.top() == 49);
+   }  // teardown
+
+};
+
+#endif // DEBUG
@@ -0,0 +1,378 @@
+/***********************************************************************
+ * Header:
+ *    TEST PERSISTENT STACK
+ * Summary:
+ *    Unit tests for persistent_stack
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "persistent_stack.h"
+#include "unitTest.h"
+#include "spy.h"
+
+#include <iostream>
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+
+#include <stack>
+#include <vector>
+
+class TestPersistentStack : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructCopy_standard();
+      test_destructor_standard();
+      test_destructor_shared();
+
+      // Access
+      test_top_standard();
+
+      // Insert
+      test_push_empty();
+      test_push_leavesOriginal();
+      test_push_branch();
+      test_push_throws();
+      test_push_throwsEmpty();
+
+      // Remove
+      test_pop_empty();
+      test_pop_shares();
+      test_pop_reusesNodes();
+      test_versions_againstStd();
+
+      report("PersistentStack");
+   }
+
+   // a Spy whose copy throws when its value is negative
+   struct Grenade
+   {
+      Grenade(int value) : spy(value) {}
+      Grenade(Grenade&& rhs) = default;
+      Grenade(const Grenade& rhs) : spy(rhs.spy)
+      {
+         if (spy.get() < 0)
+            throw std::runtime_error("Grenade: pin pulled");
+      }
+      Spy spy;
+   };
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // default constructor, no allocations
+   void test_construct_default()
+   {  // setup
+      Spy::reset();
+      // exercise
+      custom::persistent_stack<Spy> s;
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(s.head == nullptr);
+      assertUnit(s.pool == nullptr);
+      assertUnit(s.size() == 0);
+      assertUnit(s.empty());
+   }  // teardown
+
+   // copying a version copies no element
+   void test_constructCopy_standard()
+   {  // setup
+      custom::persistent_stack<Spy> sSrc = setupStandardFixture();
+      Spy::reset();
+      // exercise
+      custom::persistent_stack<Spy> sDest(sSrc);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(sDest.head == sSrc.head);
+      assertUnit(sDest.head->refs == 2);
+      assertUnit(sDest.pool->refs == 2);
+      assertStandardFixture(sSrc);
+      assertStandardFixture(sDest);
+   }  // teardown
+
+   // the last version destroys every element
+   void test_destructor_standard()
+   {  // setup
+      {
+         custom::persistent_stack<Spy> s = setupStandardFixture();
+         Spy::reset();
+      }  // exercise
+      // verify
+      assertUnit(Spy::numDestructor() == 4);
+      assertUnit(Spy::numDelete() == 4);
+   }
+
+   // destroying one version leaves the shared elements alone
+   void test_destructor_shared()
+   {  // setup
+      custom::persistent_stack<Spy> sBase = setupStandardFixture();
+      {
+         custom::persistent_stack<Spy> s = sBase.push(Spy(99));
+         Spy::reset();
+      }  // exercise
+      // verify
+      assertUnit(Spy::numDestructor() == 1);  // [99] only
+      assertUnit(Spy::numDelete() == 1);
+      assertUnit(sBase.head->refs == 1);
+      assertStandardFixture(sBase);
+   }  // teardown
+
+   /***************************************
+    * TOP
+    ***************************************/
+
+   // top is the last thing pushed
+   void test_top_standard()
+   {  // setup
+      custom::persistent_stack<Spy> s = setupStandardFixture();
+      Spy::reset();
+      // exercise
+      const Spy& top = s.top();
+      // verify
+      assertUnit(top.get() == 89);
+      assertUnit(Spy::numCopy() == 0);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // push onto an empty stack makes the pool
+   void test_push_empty()
+   {  // setup
+      custom::persistent_stack<Spy> s;
+      Spy value(26);
+      Spy::reset();
+      // exercise
+      custom::persistent_stack<Spy> sNew = s.push(value);
+      // verify
+      assertUnit(Spy::numCopy() == 1);
+      assertUnit(Spy::numAlloc() == 1);
+      assertUnit(s.empty());
+      assertUnit(sNew.size() == 1);
+      assertUnit(sNew.top() == Spy(26));
+      assertUnit(sNew.pool != nullptr);
+      assertUnit(sNew.pool->chunks.size() == 1);
+   }  // teardown
+
+   // push does not change the version it was called on
+   void test_push_leavesOriginal()
+   {  // setup
+      custom::persistent_stack<Spy> s = setupStandardFixture();
+      Spy::reset();
+      // exercise
+      custom::persistent_stack<Spy> sNew = s.push(Spy(99));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 1);
+      assertUnit(sNew.size() == 5);
+      assertUnit(sNew.top() == Spy(99));
+      assertUnit(sNew.head->next == s.head);
+      assertUnit(sNew.pool == s.pool);
+      assertStandardFixture(s);
+   }  // teardown
+
+   // two pushes on the same version share everything underneath
+   void test_push_branch()
+   {  // setup
+      custom::persistent_stack<Spy> s = setupStandardFixture();
+      Spy::reset();
+      // exercise
+      custom::persistent_stack<Spy> sLeft = s.push(Spy(11));
+      custom::persistent_stack<Spy> sRight = s.push(Spy(22));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 2);
+      assertUnit(sLeft.head->next == sRight.head->next);
+      assertUnit(s.head->refs == 3);
+      assertUnit(sLeft.top() == Spy(11));
+      assertUnit(sRight.top() == Spy(22));
+      assertStandardFixture(s);
+   }  // teardown
+
+   // a push whose copy throws takes no counts and keeps no block
+   void test_push_throws()
+   {  // setup
+      custom::persistent_stack<Grenade> s;
+      s = s.push(Grenade(1)).push(Grenade(2));
+      void* freeList = s.pool->freeList;
+      Grenade pin(-1);
+      Spy::reset();
+      // exercise
+      bool threw = false;
+      try
+      {
+         custom::persistent_stack<Grenade> sNew = s.push(pin);
+      }
+      catch (const std::runtime_error&)
+      {
+         threw = true;
+      }
+      // verify
+      assertUnit(threw);
+      assertUnit(Spy::numCopy() == 1);
+      assertUnit(Spy::numDestructor() == 1);   // the half-built copy's Spy
+      assertUnit(s.head->refs == 1);
+      assertUnit(s.pool->refs == 1);
+      assertUnit(s.pool->freeList == freeList);
+      assertUnit(s.size() == 2);
+      assertUnit(s.top().spy == Spy(2));
+   }  // teardown
+
+   // the first push throwing leaves no pool behind
+   void test_push_throwsEmpty()
+   {  // setup
+      custom::persistent_stack<Grenade> s;
+      Grenade pin(-1);
+      // exercise
+      bool threw = false;
+      try
+      {
+         custom::persistent_stack<Grenade> sNew = s.push(pin);
+      }
+      catch (const std::runtime_error&)
+      {
+         threw = true;
+      }
+      // verify
+      assertUnit(threw);
+      assertUnit(s.empty());
+      assertUnit(s.pool == nullptr);
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // pop an empty stack is still empty
+   void test_pop_empty()
+   {  // setup
+      custom::persistent_stack<Spy> s;
+      Spy::reset();
+      // exercise
+      custom::persistent_stack<Spy> sNew = s.pop();
+      // verify
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(sNew.empty());
+      assertUnit(sNew.pool == nullptr);
+   }  // teardown
+
+   // pop shares the rest and destroys nothing
+   void test_pop_shares()
+   {  // setup
+      custom::persistent_stack<Spy> s = setupStandardFixture();
+      Spy::reset();
+      // exercise
+      custom::persistent_stack<Spy> sNew = s.pop();
+      // verify
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(sNew.head == s.head->next);
+      assertUnit(sNew.size() == 3);
+      assertUnit(sNew.top() == Spy(67));
+      assertStandardFixture(s);
+   }  // teardown
+
+   // a node freed by one version is handed to the next push
+   void test_pop_reusesNodes()
+   {  // setup
+      custom::persistent_stack<int> s;
+      s = s.push(1).push(2);
+      s = s.pop();
+      void* freed = s.pool->freeList;
+      // exercise
+      s = s.push(3);
+      // verify
+      assertUnit((void*)s.head == freed);
+      assertUnit(s.pool->chunks.size() == 1);
+      assertUnit(s.size() == 2);
+      assertUnit(s.top() == 3);
+   }  // teardown
+
+   // many versions kept alive at once all agree with std::stack
+   void test_versions_againstStd()
+   {  // setup
+      std::vector<custom::persistent_stack<int>> versions(1);
+      std::vector<std::stack<int>> versionsStd(1);
+      unsigned int seed = 3;
+      // exercise
+      for (int i = 0; i < 3000; i++)
+      {
+         seed = seed * 1103515245u + 12345u;
+         size_t from = (seed >> 8) % versions.size();
+         if ((seed >> 4) % 3 == 0)
+         {
+            versions.push_back(versions[from].pop());
+            versionsStd.push_back(versionsStd[from]);
+            if (!versionsStd.back().empty())
+               versionsStd.back().pop();
+         }
+         else
+         {
+            versions.push_back(versions[from].push(i));
+            versionsStd.push_back(versionsStd[from]);
+            versionsStd.back().push(i);
+         }
+      }
+      // verify
+      bool same = true;
+      for (size_t v = 0; v < versions.size(); v++)
+      {
+         custom::persistent_stack<int> s = versions[v];
+         same = same && s.size() == versionsStd[v].size();
+         while (same && !versionsStd[v].empty())
+         {
+            same = s.top() == versionsStd[v].top();
+            s = s.pop();
+            versionsStd[v].pop();
+         }
+      }
+      assertUnit(same);
+   }  // teardown
+
+   /*************************************************************
+    * SETUP STANDARD FIXTURE
+    *    +----+----+----+----+
+    *    | 26 | 49 | 67 | 89 |
+    *    +----+----+----+----+
+    *************************************************************/
+   custom::persistent_stack<Spy> setupStandardFixture()
+   {
+      return custom::persistent_stack<Spy>().push(Spy(26)).push(Spy(49)).push(Spy(67)).push(Spy(89));
+   }
+
+   /*************************************************************
+    * VERIFY STANDARD FIXTURE
+    *    +----+----+----+----+
+    *    | 26 | 49 | 67 | 89 |
+    *    +----+----+----+----+
+    *************************************************************/
+   void assertStandardFixtureParameters(const custom::persistent_stack<Spy>& s,
+                                        int line, const char* function)
+   {
+      assertIndirect(s.size() == 4);
+      custom::persistent_stack<Spy> version(s);
+      int expected[] = { 89, 67, 49, 26 };
+      for (int value : expected)
+      {
+         assertIndirect(!version.empty() && version.top() == Spy(value));
+         version = version.pop();
+      }
+   }
+
+};
+
+#endif // DEBUG
@@ -0,0 +1,250 @@
+/***********************************************************************
+ * Header:
+ *    TEST REALLOC ALLOCATOR
+ * Summary:
+ *    Unit tests for realloc_allocator and mremap_allocator
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "realloc_allocator.h"
+#include "vector.h"
+#include "unitTest.h"
+
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <string>
+
+class TestReallocAllocator : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // realloc_allocator
+      test_realloc_allocate();
+      test_realloc_reallocateKeeps();
+      test_realloc_tryExpandSlack();
+      test_realloc_vector();
+      test_realloc_vectorNotTrivial();
+
+      // mremap_allocator
+      test_mremap_small();
+      test_mremap_bigPageAligned();
+      test_mremap_leaveHeap();
+      test_mremap_reallocateKeeps();
+      test_mremap_shrinkToHeap();
+      test_mremap_vector();
+
+      report("ReallocAllocator");
+   }
+
+   /***************************************
+    * REALLOC ALLOCATOR
+    ***************************************/
+
+   // a block to write in and give back
+   void test_realloc_allocate()
+   {  // setup
+      custom::realloc_allocator<int> a;
+      // exercise
+      int* p = a.allocate(10);
+      p[0] = 1;
+      p[9] = 9;
+      // verify
+      assertUnit(p != nullptr);
+      assertUnit(p[9] == 9);
+      assertUnit(a == custom::realloc_allocator<double>());
+      // teardown
+      a.deallocate(p, 10);
+   }
+
+   // growing keeps what was there
+   void test_realloc_reallocateKeeps()
+   {  // setup
+      custom::realloc_allocator<int> a;
+      int* p = a.allocate(4);
+      for (int i = 0; i < 4; i++)
+         p[i] = i + 100;
+      // exercise
+      p = a.reallocate(p, 4, 100000);
+      p[99999] = 7;
+      // verify
+      assertUnit(p[0] == 100);
+      assertUnit(p[3] == 103);
+      // teardown
+      a.deallocate(p, 100000);
+   }
+
+   // try_expand says yes as far as the block really goes, and no further
+   void test_realloc_tryExpandSlack()
+   {  // setup
+      custom::realloc_allocator<char> a;
+      char* p = a.allocate(1);
+      // exercise
+#ifdef __GLIBC__
+      size_t usable = malloc_usable_size(p);
+      bool upToUsable = a.try_expand(p, 1, usable);
+      bool pastUsable = a.try_expand(p, 1, usable + 1);
+      // verify
+      assertUnit(upToUsable);
+      assertUnit(!pastUsable);
+#else
+      bool byOne = a.try_expand(p, 1, 2);
+      // verify
+      assertUnit(!byOne);
+#endif
+      // teardown
+      a.deallocate(p, 1);
+   }
+
+   // a vector over it holds its numbers through every growth
+   void test_realloc_vector()
+   {  // setup
+      custom::vector<uint64_t, custom::realloc_allocator<uint64_t>> v;
+      // exercise
+      for (uint64_t i = 0; i < 100000; i++)
+         v.push_back(i * 3);
+      // verify
+      bool same = true;
+      for (uint64_t i = 0; i < 100000; i++)
+         if (v[i] != i * 3)
+            same = false;
+      assertUnit(same);
+      assertUnit(v.size() == 100000);
+   }  // teardown
+
+   // elements that are not just bytes are moved properly
+   void test_realloc_vectorNotTrivial()
+   {  // setup
+      custom::vector<std::string, custom::realloc_allocator<std::string>> v;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         v.push_back(std::string(40, (char)('a' + i % 26)));
+      // verify
+      assertUnit(v.size() == 1000);
+      assertUnit(v[0] == std::string(40, 'a'));
+      assertUnit(v[999] == std::string(40, (char)('a' + 999 % 26)));
+   }  // teardown
+
+   /***************************************
+    * MREMAP ALLOCATOR
+    ***************************************/
+
+   // small blocks come from the heap, as realloc_allocator's do
+   void test_mremap_small()
+   {  // setup
+      custom::mremap_allocator<int> a;
+      // exercise
+      int* p = a.allocate(16);
+      p = a.reallocate(p, 16, 64);
+      p[63] = 63;
+      // verify
+      assertUnit(p[63] == 63);
+      // teardown
+      a.deallocate(p, 64);
+   }
+
+   // big blocks are pages of their own
+   void test_mremap_bigPageAligned()
+   {  // setup
+      custom::mremap_allocator<char> a;
+      const size_t big = custom::mremap_allocator<char>::MAP_THRESHOLD;
+      // exercise
+      char* p = a.allocate(big);
+      p[0] = 'x';
+      p[big - 1] = 'y';
+      // verify
+#ifdef __linux__
+      assertUnit(reinterpret_cast<uintptr_t>(p) % 4096 == 0);
+#endif
+      assertUnit(p[big - 1] == 'y');
+      // teardown
+      a.deallocate(p, big);
+   }
+
+   // crossing the threshold copies once, keeping everything
+   void test_mremap_leaveHeap()
+   {  // setup
+      custom::mremap_allocator<int> a;
+      const size_t big = custom::mremap_allocator<int>::MAP_THRESHOLD / sizeof(int);
+      int* p = a.allocate(1000);
+      for (int i = 0; i < 1000; i++)
+         p[i] = i;
+      // exercise
+      bool expanded = a.try_expand(p, 1000, big);
+      p = a.reallocate(p, 1000, big);
+      // verify
+      assertUnit(!expanded);
+      assertUnit(p[0] == 0);
+      assertUnit(p[999] == 999);
+      p[big - 1] = 1;
+      // teardown
+      a.deallocate(p, big);
+   }
+
+   // remapping keeps the pages' contents, wherever they end up
+   void test_mremap_reallocateKeeps()
+   {  // setup
+      custom::mremap_allocator<uint64_t> a;
+      const size_t big = custom::mremap_allocator<uint64_t>::MAP_THRESHOLD / sizeof(uint64_t);
+      uint64_t* p = a.allocate(big);
+      for (size_t i = 0; i < big; i++)
+         p[i] = i * 7;
+      // exercise
+      if (!a.try_expand(p, big, big * 4))
+         p = a.reallocate(p, big, big * 4);
+      p[big * 4 - 1] = 1;
+      // verify
+      bool same = true;
+      for (size_t i = 0; i < big; i++)
+         if (p[i] != i * 7)
+            same = false;
+      assertUnit(same);
+      // teardown
+      a.deallocate(p, big * 4);
+   }
+
+   // shrinking below the threshold puts the block back on the heap,
+   // where deallocate will look for it
+   void test_mremap_shrinkToHeap()
+   {  // setup
+      custom::mremap_allocator<int> a;
+      const size_t big = custom::mremap_allocator<int>::MAP_THRESHOLD / sizeof(int);
+      int* p = a.allocate(big);
+      for (int i = 0; i < 1000; i++)
+         p[i] = i;
+      // exercise
+      bool expanded = a.try_expand(p, big, 1000);
+      p = a.reallocate(p, big, 1000);
+      // verify
+      assertUnit(!expanded);
+      assertUnit(p[0] == 0);
+      assertUnit(p[999] == 999);
+      // teardown
+      a.deallocate(p, 1000);
+   }
+
+   // a vector over it holds its numbers through every growth
+   void test_mremap_vector()
+   {  // setup
+      custom::vector<uint64_t, custom::mremap_allocator<uint64_t>> v;
+      // exercise
+      for (uint64_t i = 0; i < 1000000; i++)
+         v.push_back(i ^ 0x5555);
+      // verify
+      bool same = true;
+      for (uint64_t i = 0; i < 1000000; i++)
+         if (v[i] != (i ^ 0x5555))
+            same = false;
+      assertUnit(same);
+      assertUnit(v.size() == 1000000);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,408 @@
+/***********************************************************************
+ * Header:
+ *    TEST SOA STACK
+ * Summary:
+ *    Unit tests for soa_stack
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "soa_stack.h"
+#include "unitTest.h"
+#include "spy.h"
+
+#include <iostream>
+#include <cassert>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+class TestSOAStack : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructCopy_standard();
+      test_constructMove_standard();
+      test_destructor_standard();
+
+      // Access
+      test_top_standard();
+      test_top_writes();
+      test_column_standard();
+      test_column_empty();
+
+      // Insert
+      test_push_empty();
+      test_push_grow();
+      test_push_tuple();
+      test_push_throwsMidRow();
+      test_reserve_moves();
+      test_reserve_throwsMidColumns();
+
+      // Remove
+      test_pop_standard();
+      test_pop_empty();
+      test_clear_standard();
+
+      report("SOAStack");
+   }
+
+   // a field that refuses negative numbers
+   struct Fussy
+   {
+      Fussy(int value) : value(value)
+      {
+         if (value < 0)
+            throw std::invalid_argument("Fussy: negative");
+      }
+      int value;
+   };
+
+   // a field so big that no column of a million of them can be had
+   struct Huge
+   {
+      char bytes[(size_t)1 << 44];
+   };
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // default constructor, no allocations
+   void test_construct_default()
+   {  // setup
+      Spy::reset();
+      // exercise
+      custom::soa_stack<Spy, char> s;
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(std::get<0>(s.columns) == nullptr);
+      assertUnit(std::get<1>(s.columns) == nullptr);
+      assertUnit(s.size() == 0);
+      assertUnit(s.capacity() == 0);
+      assertUnit(s.empty());
+   }  // teardown
+
+   // copy copies every column
+   void test_constructCopy_standard()
+   {  // setup
+      custom::soa_stack<Spy, char> sSrc;
+      setupStandardFixture(sSrc);
+      Spy::reset();
+      // exercise
+      custom::soa_stack<Spy, char> sDest(sSrc);
+      // verify
+      assertUnit(Spy::numCopy() == 4);
+      assertUnit(std::get<0>(sDest.columns) != std::get<0>(sSrc.columns));
+      assertUnit(sDest.capacity() == 4);
+      assertStandardFixture(sSrc);
+      assertStandardFixture(sDest);
+   }  // teardown
+
+   // move steals every column
+   void test_constructMove_standard()
+   {  // setup
+      custom::soa_stack<Spy, char> sSrc;
+      setupStandardFixture(sSrc);
+      Spy* column = std::get<0>(sSrc.columns);
+      Spy::reset();
+      // exercise
+      custom::soa_stack<Spy, char> sDest(std::move(sSrc));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(std::get<0>(sDest.columns) == column);
+      assertUnit(std::get<0>(sSrc.columns) == nullptr);
+      assertUnit(sSrc.empty());
+      assertStandardFixture(sDest);
+   }  // teardown
+
+   // the destructor destroys every element
+   void test_destructor_standard()
+   {  // setup
+      {
+         custom::soa_stack<Spy, char> s;
+         setupStandardFixture(s);
+         Spy::reset();
+      }  // exercise
+      // verify
+      assertUnit(Spy::numDestructor() == 4);
+      assertUnit(Spy::numDelete() == 4);
+   }
+
+   /***************************************
+    * TOP
+    ***************************************/
+
+   // top gathers the last row from every column
+   void test_top_standard()
+   {  // setup
+      custom::soa_stack<Spy, char> s;
+      setupStandardFixture(s);
+      Spy::reset();
+      // exercise
+      std::tuple<Spy&, char&> top = s.top();
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(std::get<0>(top) == Spy(89));
+      assertUnit(std::get<1>(top) == 'd');
+      assertUnit(&std::get<0>(top) == std::get<0>(s.columns) + 3);
+   }  // teardown
+
+   // writing through the proxy writes the columns
+   void test_top_writes()
+   {  // setup
+      custom::soa_stack<int, std::string> s;
+      s.push(1, "one");
+      s.push(2, "two");
+      // exercise
+      std::get<0>(s.top()) = 22;
+      std::get<1>(s[0]) = "uno";
+      // verify
+      assertUnit(std::get<0>(s.columns)[1] == 22);
+      assertUnit(std::get<1>(s.columns)[0] == "uno");
+      assertUnit(std::get<1>(s.top()) == "two");
+   }  // teardown
+
+   // a column is a span over one field of every element
+   void test_column_standard()
+   {  // setup
+      custom::soa_stack<Spy, char> s;
+      setupStandardFixture(s);
+      // exercise
+      std::span<char> tags = s.column<1>();
+      // verify
+      assertUnit(tags.size() == 4);
+      assertUnit(tags.data() == std::get<1>(s.columns));
+      assertUnit(tags[0] == 'a');
+      assertUnit(tags[3] == 'd');
+      std::string all;
+      for (char tag : tags)
+         all += tag;
+      assertUnit(all == "abcd");
+      const custom::soa_stack<Spy, char>& sConst = s;
+      assertUnit(sConst.column<0>()[1] == Spy(49));
+   }  // teardown
+
+   // an empty stack has empty columns
+   void test_column_empty()
+   {  // setup
+      custom::soa_stack<int, double> s;
+      // exercise
+      std::span<double> values = s.column<1>();
+      // verify
+      assertUnit(values.empty());
+      assertUnit(values.begin() == values.end());
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // push onto an empty stack allocates every column
+   void test_push_empty()
+   {  // setup
+      custom::soa_stack<Spy, char> s;
+      Spy::reset();
+      // exercise
+      s.push(Spy(26), 'a');
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 1);
+      assertUnit(s.size() == 1);
+      assertUnit(s.capacity() == 1);
+      assertUnit(std::get<0>(s.columns) != nullptr);
+      assertUnit(std::get<1>(s.columns) != nullptr);
+      assertUnit(std::get<0>(s.top()) == Spy(26));
+   }  // teardown
+
+   // the columns grow together
+   void test_push_grow()
+   {  // setup
+      custom::soa_stack<int, char, double> s;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         s.push(i, (char)('a' + i % 26), i * 0.5);
+      // verify
+      assertUnit(s.size() == 100);
+      assertUnit(s.capacity() == 128);
+      bool same = true;
+      for (int i = 0; i < 100; i++)
+         same = same && s.column<0>()[i] == i
+                     && s.column<1>()[i] == (char)('a' + i % 26)
+                     && s.column<2>()[i] == i * 0.5;
+      assertUnit(same);
+   }  // teardown
+
+   // push a whole tuple at once
+   void test_push_tuple()
+   {  // setup
+      custom::soa_stack<int, std::string> s;
+      std::tuple<int, std::string> t(7, "seven");
+      // exercise
+      s.push(t);
+      s.push(std::make_tuple(8, std::string("eight")));
+      // verify
+      assertUnit(std::get<1>(t) == "seven");
+      assertUnit(s.size() == 2);
+      assertUnit(std::get<1>(s[0]) == "seven");
+      assertUnit(std::get<0>(s.top()) == 8);
+   }  // teardown
+
+   // a row whose second field throws leaves no first field behind
+   void test_push_throwsMidRow()
+   {  // setup
+      custom::soa_stack<Spy, Fussy> s;
+      s.reserve(2);
+      s.push(Spy(1), 1);
+      Spy::reset();
+      // exercise
+      bool threw = false;
+      try
+      {
+         s.push(Spy(2), -1);
+      }
+      catch (const std::invalid_argument&)
+      {
+         threw = true;
+      }
+      // verify
+      assertUnit(threw);
+      assertUnit(Spy::numCopyMove() == 1);
+      assertUnit(Spy::numDestructor() == 2);   // the argument and its rolled-back copy
+      assertUnit(s.size() == 1);
+      assertUnit(std::get<0>(s.top()) == Spy(1));
+      assertUnit(std::get<1>(s.top()).value == 1);
+   }  // teardown
+
+   // growing moves the elements rather than copying them
+   void test_reserve_moves()
+   {  // setup
+      custom::soa_stack<Spy, char> s;
+      setupStandardFixture(s);
+      Spy::reset();
+      // exercise
+      s.reserve(10);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 4);
+      assertUnit(s.capacity() == 10);
+      assertStandardFixture(s);
+   }  // teardown
+
+   // when a later column cannot be had, the earlier ones are given back
+   void test_reserve_throwsMidColumns()
+   {  // setup
+      custom::soa_stack<char, Huge> s;
+      // exercise
+      bool threw = false;
+      try
+      {
+         s.reserve((size_t)1 << 20);
+      }
+      catch (const std::bad_alloc&)
+      {
+         threw = true;
+      }
+      // verify
+      assertUnit(threw);
+      assertUnit(s.capacity() == 0);
+      assertUnit(std::get<0>(s.columns) == nullptr);
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // pop destroys the top row of every column
+   void test_pop_standard()
+   {  // setup
+      custom::soa_stack<Spy, char> s;
+      setupStandardFixture(s);
+      Spy::reset();
+      // exercise
+      s.pop();
+      // verify
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(s.size() == 3);
+      assertUnit(s.capacity() == 4);
+      assertUnit(std::get<0>(s.top()) == Spy(67));
+      assertUnit(std::get<1>(s.top()) == 'c');
+   }  // teardown
+
+   // pop an empty stack does nothing
+   void test_pop_empty()
+   {  // setup
+      custom::soa_stack<Spy, char> s;
+      // exercise
+      s.pop();
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.capacity() == 0);
+   }  // teardown
+
+   // clear destroys everything and keeps the columns
+   void test_clear_standard()
+   {  // setup
+      custom::soa_stack<Spy, char> s;
+      setupStandardFixture(s);
+      Spy::reset();
+      // exercise
+      s.clear();
+      // verify
+      assertUnit(Spy::numDestructor() == 4);
+      assertUnit(s.empty());
+      assertUnit(s.capacity() == 4);
+   }  // teardown
+
+   /*************************************************************
+    * SETUP STANDARD FIXTURE
+    *    +----+----+----+----+
+    *    | 26 | 49 | 67 | 89 |
+    *    | a  | b  | c  | d  |
+    *    +----+----+----+----+
+    *************************************************************/
+   void setupStandardFixture(custom::soa_stack<Spy, char>& s)
+   {
+      s.reserve(4);
+      s.push(Spy(26), 'a');
+      s.push(Spy(49), 'b');
+      s.push(Spy(67), 'c');
+      s.push(Spy(89), 'd');
+   }
+
+   /*************************************************************
+    * VERIFY STANDARD FIXTURE
+    *    +----+----+----+----+
+    *    | 26 | 49 | 67 | 89 |
+    *    | a  | b  | c  | d  |
+    *    +----+----+----+----+
+    *************************************************************/
+   void assertStandardFixtureParameters(const custom::soa_stack<Spy, char>& s,
+                                        int line, const char* function)
+   {
+      assertIndirect(s.size() == 4);
+      assertIndirect(s.capacity() >= 4);
+      int values[] = { 26, 49, 67, 89 };
+      const char* tags = "abcd";
+      for (size_t i = 0; i < 4; i++)
+      {
+         assertIndirect(std::get<0>(s.columns)[i] == Spy(values[i]));
+         assertIndirect(std::get<1>(s.columns)[i] == tags[i]);
+      }
+   }
+
+};
+
+#endif // DEBUG
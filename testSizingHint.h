@@ -0,0 +1,148 @@
+/***********************************************************************
+ * Header:
+ *    TEST SIZING HINT
+ * Summary:
+ *    Unit tests for sizing_hint
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "sizing_hint.h"
+#include "unitTest.h"
+
+#include <iostream>
+#include <cassert>
+#include <thread>
+
+class TestSizingHint : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_percentileClamped();
+
+      // Record
+      test_record_first();
+      test_record_betweenRecomputes();
+      test_record_percentile();
+      test_record_median();
+      test_record_ringForgets();
+      test_record_threads();
+
+      report("SizingHint");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // nothing known, nothing suggested
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::sizing_hint hint;
+      // verify
+      assertUnit(hint.suggested() == 0);
+      assertUnit(hint.num_recorded() == 0);
+      assertUnit(hint.percentile == 90);
+   }  // teardown
+
+   // past 100 means the most
+   void test_construct_percentileClamped()
+   {  // setup
+      // exercise
+      custom::sizing_hint hint(250);
+      // verify
+      assertUnit(hint.percentile == 100);
+   }  // teardown
+
+   /***************************************
+    * RECORD
+    ***************************************/
+
+   // the first one is taken as it is
+   void test_record_first()
+   {  // setup
+      custom::sizing_hint hint;
+      // exercise
+      hint.record(37);
+      // verify
+      assertUnit(hint.num_recorded() == 1);
+      assertUnit(hint.suggested() == 37);
+   }  // teardown
+
+   // the suggestion only moves every RECOMPUTE records
+   void test_record_betweenRecomputes()
+   {  // setup
+      custom::sizing_hint hint;
+      hint.record(5);
+      // exercise
+      for (size_t i = 2; i < custom::sizing_hint::RECOMPUTE; i++)
+         hint.record(1000);
+      bool unchanged = hint.suggested() == 5;
+      hint.record(1000);
+      // verify
+      assertUnit(unchanged);
+      assertUnit(hint.suggested() == 1000);
+   }  // teardown
+
+   // the 90th percentile ignores the odd outlier
+   void test_record_percentile()
+   {  // setup
+      custom::sizing_hint hint;
+      // exercise
+      for (size_t i = 0; i < custom::sizing_hint::HISTORY; i++)
+         hint.record(i % 32 == 31 ? 100000 : 20 + i % 4);
+      // verify
+      assertUnit(hint.suggested() == 23);
+   }  // teardown
+
+   // any percentile can be asked for
+   void test_record_median()
+   {  // setup
+      custom::sizing_hint hint(50);
+      // exercise
+      for (size_t i = 1; i <= custom::sizing_hint::RECOMPUTE; i++)
+         hint.record(i);
+      // verify
+      assertUnit(hint.suggested() == 8);
+   }  // teardown
+
+   // old marks fall out of the ring
+   void test_record_ringForgets()
+   {  // setup
+      custom::sizing_hint hint(100);
+      for (size_t i = 0; i < custom::sizing_hint::HISTORY; i++)
+         hint.record(500);
+      assertUnit(hint.suggested() == 500);
+      // exercise
+      for (size_t i = 0; i < custom::sizing_hint::HISTORY; i++)
+         hint.record(12);
+      // verify
+      assertUnit(hint.suggested() == 12);
+      assertUnit(hint.num_recorded() == 2 * custom::sizing_hint::HISTORY);
+   }  // teardown
+
+   // threads can share one
+   void test_record_threads()
+   {  // setup
+      custom::sizing_hint hint;
+      // exercise
+      std::thread a([&hint]() { for (int i = 0; i < 1000; i++) hint.record(64); });
+      std::thread b([&hint]() { for (int i = 0; i < 1000; i++) hint.record(64); });
+      a.join();
+      b.join();
+      // verify
+      assertUnit(hint.num_recorded() == 2000);
+      assertUnit(hint.suggested() == 64);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,354 @@
+/***********************************************************************
+ * Header:
+ *    TEST SPILLING STACK
+ * Summary:
+ *    Unit tests for spilling_stack
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "spilling_stack.h"
+#include "unitTest.h"
+
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <system_error>
+
+class TestSpillingStack : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_sizes();
+
+      // Insert
+      test_push_withinBudget();
+      test_push_overBudget();
+
+      // Remove
+      test_pop_roundTrip();
+      test_pop_random();
+      test_top_acrossSpill();
+      test_clear_standard();
+
+      // Failure
+      test_push_writeFails();
+      test_pop_readFails();
+
+      // Elements
+      test_push_struct();
+
+      report("SpillingStack");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // nothing in memory, no file
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::spilling_stack<int> s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.size() == 0);
+      assertUnit(s.memory_bytes() == 0);
+      assertUnit(s.spilled_size() == 0);
+      assertUnit(s.file == nullptr);
+      assertUnit(s.resident.size() == 0);
+   }  // teardown
+
+   // segments are a whole number of elements, and the budget covers
+   // the resident ones plus one in flight and one last spilled
+   void test_construct_sizes()
+   {  // setup
+      // exercise
+      custom::spilling_stack<int32_t> s(128, 18);
+      // verify
+      assertUnit(s.numPerSegment == 4);
+      assertUnit(s.segmentBytes == 16);
+      assertUnit(s.maxResident == 6);
+      assertUnit(s.empty());
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // under the budget nothing is written
+   void test_push_withinBudget()
+   {  // setup
+      custom::spilling_stack<int32_t> s(128, 16);
+      // exercise
+      for (int32_t i = 0; i < 24; i++)
+         s.push(i);
+      // verify
+      assertUnit(s.size() == 24);
+      assertUnit(s.top() == 23);
+      assertUnit(s.spilled_size() == 0);
+      assertUnit(s.file == nullptr);
+      assertUnit(s.resident.size() == 6);
+      assertUnit(s.memory_bytes() == 6 * 16);
+   }  // teardown
+
+   // past the budget the bottom goes to disk, and memory stays put
+   void test_push_overBudget()
+   {  // setup
+      custom::spilling_stack<int32_t> s(128, 16);
+      // exercise
+      for (int32_t i = 0; i < 1000; i++)
+         s.push(i);
+      // verify
+      assertUnit(s.size() == 1000);
+      assertUnit(s.top() == 999);
+      assertUnit(s.file != nullptr);
+      assertUnit(s.spilled_size() > 0);
+      assertUnit(s.spilled_size() % 4 == 0);
+      assertUnit(s.resident.size() <= 6);
+      assertUnit(s.memory_bytes() <= 128);
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // everything comes back, last in first out
+   void test_pop_roundTrip()
+   {  // setup
+      custom::spilling_stack<int32_t> s(128, 16);
+      for (int32_t i = 0; i < 1000; i++)
+         s.push(i);
+      // exercise
+      bool inOrder = true;
+      for (int32_t i = 999; i >= 0; i--)
+      {
+         if (s.top() != i)
+            inOrder = false;
+         s.pop();
+      }
+      // verify
+      assertUnit(inOrder);
+      assertUnit(s.empty());
+      assertUnit(s.spilled_size() == 0);
+      assertUnit(s.memory_bytes() <= 128);
+   }  // teardown
+
+   // pushes and pops in any order agree with a stack in memory,
+   // including pushing again over segments that came back from disk
+   void test_pop_random()
+   {  // setup
+      custom::spilling_stack<int32_t> s(128, 16);
+      custom::vector<int32_t> expected;
+      std::mt19937 random(235);
+      // exercise
+      bool same = true;
+      for (int32_t i = 0; i < 20000; i++)
+      {
+         // mostly pushing for a while, then mostly popping
+         unsigned int pushChance = (i / 2000) % 2 == 0 ? 70 : 30;
+         if (expected.empty() || random() % 100 < pushChance)
+         {
+            s.push(i);
+            expected.push_back(i);
+         }
+         else
+         {
+            s.pop();
+            expected.pop_back();
+         }
+         if (s.size() != expected.size() ||
+             (!expected.empty() && s.top() != expected.back()))
+            same = false;
+      }
+      while (!expected.empty())
+      {
+         if (s.top() != expected.back())
+            same = false;
+         s.pop();
+         expected.pop_back();
+      }
+      // verify
+      assertUnit(same);
+      assertUnit(s.empty());
+      assertUnit(s.memory_bytes() <= 128);
+   }  // teardown
+
+   // top can be changed, and the change survives a trip to disk
+   void test_top_acrossSpill()
+   {  // setup
+      custom::spilling_stack<int32_t> s(128, 16);
+      s.push(-1);
+      s.top() = 42;
+      for (int32_t i = 0; i < 100; i++)
+         s.push(i);
+      assertUnit(s.spilled_size() > 0);
+      // exercise
+      for (int32_t i = 0; i < 100; i++)
+         s.pop();
+      // verify
+      assertUnit(s.size() == 1);
+      assertUnit(s.top() == 42);
+   }  // teardown
+
+   // clear empties the stack and keeps the buffers for later
+   void test_clear_standard()
+   {  // setup
+      custom::spilling_stack<int32_t> s(128, 16);
+      for (int32_t i = 0; i < 100; i++)
+         s.push(i);
+      size_t bytes = s.memory_bytes();
+      // exercise
+      s.clear();
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.spilled_size() == 0);
+      assertUnit(s.memory_bytes() == bytes);
+      s.push(7);
+      s.push(8);
+      assertUnit(s.size() == 2);
+      assertUnit(s.top() == 8);
+      s.pop();
+      assertUnit(s.top() == 7);
+      assertUnit(s.memory_bytes() == bytes);
+   }  // teardown
+
+   /***************************************
+    * FAILURE
+    ***************************************/
+
+   // an empty file that cannot be written, to stand in for the scratch file
+   static std::FILE* openReadOnly()
+   {
+      const char* name = "testSpillingStack.tmp";
+      std::FILE* f = std::fopen(name, "w");
+      assert(f != nullptr);
+      std::fclose(f);
+      f = std::fopen(name, "r");
+      assert(f != nullptr);
+      std::remove(name);   // POSIX lets the name go while open; elsewhere the empty file stays
+      return f;
+   }
+
+   // a failed write leaves its segment in memory, and pushing on works
+   void test_push_writeFails()
+   {  // setup
+      custom::spilling_stack<int32_t> s(128, 16);
+      for (int32_t i = 0; i < 24; i++)
+         s.push(i);
+      s.file = openReadOnly();
+      // exercise
+      int32_t next = 24;
+      bool threw = false;
+      try
+      {
+         for (; next < 100; next++)
+            s.push(next);
+      }
+      catch (const std::system_error&)
+      {
+         threw = true;
+      }
+      // verify
+      assertUnit(threw);
+      assertUnit(s.size() == (size_t)next);
+      assertUnit(s.top() == next - 1);
+      assertUnit(s.spilled_size() == 0);
+      std::fclose(s.file);
+      s.file = nullptr;
+      for (; next < 1000; next++)
+         s.push(next);
+      assertUnit(s.spilled_size() > 0);
+      assertUnit(s.resident.size() <= s.maxResident);
+      bool inOrder = true;
+      for (int32_t i = 999; i >= 0; i--)
+      {
+         if (s.top() != i)
+            inOrder = false;
+         s.pop();
+      }
+      assertUnit(inOrder);
+      assertUnit(s.empty());
+   }  // teardown
+
+   // a failed read leaves its segment on disk, and popping on works
+   void test_pop_readFails()
+   {  // setup
+      custom::spilling_stack<int32_t> s(128, 16);
+      for (int32_t i = 0; i < 1000; i++)
+         s.push(i);
+      s.finishPending();
+      std::FILE* file = s.file;
+      s.file = openReadOnly();
+      // exercise
+      int32_t next = 999;
+      bool threw = false;
+      try
+      {
+         for (; next >= 0; next--)
+            s.pop();
+      }
+      catch (const std::system_error&)
+      {
+         threw = true;
+      }
+      // verify
+      assertUnit(threw);
+      assertUnit(s.size() == (size_t)next + 1);
+      assertUnit(s.top() == next);
+      assertUnit(s.spilled_size() > 0);
+      std::fclose(s.file);
+      s.file = file;
+      bool inOrder = true;
+      for (; next >= 0; next--)
+      {
+         if (s.top() != next)
+            inOrder = false;
+         s.pop();
+      }
+      assertUnit(inOrder);
+      assertUnit(s.empty());
+   }  // teardown
+
+   /***************************************
+    * ELEMENTS
+    ***************************************/
+
+   // any trivially copyable element comes back byte for byte
+   void test_push_struct()
+   {  // setup
+      struct Point
+      {
+         double x;
+         int32_t y;
+         char tag;
+      };
+      custom::spilling_stack<Point> s(sizeof(Point) * 24, sizeof(Point) * 3);
+      for (int32_t i = 0; i < 300; i++)
+         s.push(Point{ i * 0.5, -i, (char)('a' + i % 26) });
+      // exercise
+      bool same = true;
+      for (int32_t i = 299; i >= 0; i--)
+      {
+         const Point& p = s.top();
+         if (p.x != i * 0.5 || p.y != -i || p.tag != (char)('a' + i % 26))
+            same = false;
+         s.pop();
+      }
+      // verify
+      assertUnit(same);
+      assertUnit(s.empty());
+   }  // teardown
+};
+
+#endif // DEBUG
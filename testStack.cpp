@@ -15,6 +15,25 @@
 #include "testStack.h"       // for the stack unit tests
 #include "testSpy.h"         // for the spy unit tests
 #include "testVector.h"      // for the vector unit tests
+#include "testPQueue.h"      // for the priority queue unit tests
+#include "testHash.h"        // for the hash unit tests
+#include "testCowStack.h"    // for the copy-on-write stack unit tests
+#include "testPersistentStack.h" // for the persistent stack unit tests
+#include "testFrameStack.h"  // for the frame stack unit tests
+#include "testSOAStack.h"    // for the struct-of-arrays stack unit tests
+#include "testConcurrentArrayStack.h" // for the concurrent array stack unit tests
+#include "testAsyncStack.h"  // for the coroutine stack unit tests
+#include "testSynchronizedStack.h" // for the synchronized stack unit tests
+#include "testPerThreadStacks.h" // for the per-thread stacks unit tests
+#include "testSpillingStack.h" // for the spilling stack unit tests
+#include "testCompressedStack.h" // for the compressed stack unit tests
+#include "testPackedStack.h"  // for the packed stack unit tests
+#include "testBoundedStack.h" // for the bounded stack unit tests
+#include "testSizingHint.h"   // for the sizing hint unit tests
+#include "testHintedStack.h"  // for the hinted stack unit tests
+#include "testReallocAllocator.h" // for the realloc allocator unit tests
+#include "testAlignedAllocator.h" // for the aligned allocator unit tests
+#include "testCompactVector.h" // for the compact vector unit tests
 int Spy::counters[] = {};
 
 /**********************************************************************
@@ -28,6 +47,27 @@ int main()
    TestSpy().run();
    TestVector().run();
    TestStack().run();
+   TestPQueue().run();
+   TestHash().run();
+   TestCowStack().run();
+   TestPersistentStack().run();
+   TestFrameStack().run();
+   TestSOAStack().run();
+   TestConcurrentArrayStack().run();
+#ifdef __cpp_impl_coroutine
+   TestAsyncStack().run();
+#endif // __cpp_impl_coroutine
+   TestSynchronizedStack().run();
+   TestPerThreadStacks().run();
+   TestSpillingStack().run();
+   TestCompressedStack().run();
+   TestPackedStack().run();
+   TestBoundedStack().run();
+   TestSizingHint().run();
+   TestHintedStack().run();
+   TestReallocAllocator().run();
+   TestAlignedAllocator().run();
+   TestCompactVector().run();
 #endif // DEBUG
   
    return 0;
@@ -16,11 +16,14 @@
 
 #include <iostream>
 #include <cassert>
+#include <cstdio>
 #include <memory>
+#include <memory_resource>
 
 #include <stack>
 #include <vector>
 #include <list>
+#include <deque>
 
 class TestStack : public UnitTest
 {
@@ -31,6 +34,8 @@ public:
 
       // Construct
       test_construct_default();
+      test_construct_pmrResource();
+      test_constructCopy_pmrResource();
       test_constructCopy_empty();
       test_constructCopy_standard();
       test_constructCopy_partiallyFilled();
@@ -48,6 +53,8 @@ public:
       test_destructor_empty();
       test_destructor_standard();
       test_destructor_partiallyFilled();
+      test_construct_sizingHint();
+      test_sizingHint_costsNothing();
 
       // Assign
       test_assignCopy_emptyToEmpty();
@@ -81,6 +88,18 @@ public:
       test_pop_empty();
       test_pop_standard();
       test_pop_standardList();
+      test_popN_empty();
+      test_popN_standard();
+      test_popN_tooMany();
+      test_popN_standardList();
+      test_popTo_standard();
+      test_popTo_larger();
+
+      // Input / Output
+      test_writeTo_readFrom_vector();
+      test_writeTo_deque();
+      test_readFrom_deque();
+      test_readFrom_dequePartialElement();
 
       // Status
       test_size_empty();
@@ -120,6 +139,42 @@ public:
       teardownStandardFixture(s);
    } 
 
+   // a pmr stack hands its memory resource to the vector underneath
+   void test_construct_pmrResource()
+   {  // setup
+      alignas(16) unsigned char buffer[256];
+      std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                                   std::pmr::null_memory_resource());
+      // exercise
+      custom::pmr::stack<int> s(&resource);
+      s.push(26);
+      s.push(49);
+      // verify
+      unsigned char* data = reinterpret_cast<unsigned char*>(s.container.data);
+      assertUnit(s.container.get_allocator().resource() == &resource);
+      assertUnit(data >= buffer && data < buffer + sizeof(buffer));
+      assertUnit(s.size() == 2);
+      assertUnit(s.top() == 49);
+   }  // teardown
+
+   // copy a pmr stack into another resource
+   void test_constructCopy_pmrResource()
+   {  // setup
+      alignas(16) unsigned char buffer[256];
+      std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                                   std::pmr::null_memory_resource());
+      custom::pmr::stack<int> sSrc;
+      sSrc.push(26);
+      // exercise
+      custom::pmr::stack<int> sDest(sSrc, &resource);
+      // verify
+      unsigned char* data = reinterpret_cast<unsigned char*>(sDest.container.data);
+      assertUnit(sDest.container.get_allocator().resource() == &resource);
+      assertUnit(data >= buffer && data < buffer + sizeof(buffer));
+      assertUnit(sDest.top() == 26);
+      assertUnit(sSrc.size() == 1);
+   }  // teardown
+
 
    /***************************************
     * DESTRUCTOR
@@ -183,6 +238,44 @@ public:
       assertUnit(Spy::numAssign() == 0);
    }
 
+   /***************************************
+    * SIZING HINT
+    ***************************************/
+
+   // a stack made with a hint reserves what it suggests
+   void test_construct_sizingHint()
+   {  // setup
+      custom::sizing_hint hint;
+      for (size_t i = 1; i <= custom::sizing_hint::RECOMPUTE; i++)
+         hint.record(i * 10);
+      size_t suggested = hint.suggested();
+      Spy::reset();
+      // exercise
+      custom::stack<Spy> s(hint);
+      // verify
+      assertUnit(suggested == 150);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(s.container.capacity() == 150);
+      assertUnit(s.empty());
+   }  // teardown
+
+   // the hint is only read: nothing is stored, and nothing recorded
+   void test_sizingHint_costsNothing()
+   {  // setup
+      custom::sizing_hint hint;
+      hint.record(40);
+      {
+         // exercise
+         custom::stack<int> s(hint);
+         for (int i = 0; i < 50; i++)
+            s.push(i);
+      }
+      // verify
+      assertUnit(hint.num_recorded() == 1);
+      assertUnit(sizeof(custom::stack<int>) == sizeof(custom::vector<int>));
+   }  // teardown
+
    /***************************************
     * COPY CONSTRUCTOR
     ***************************************/
@@ -1596,6 +1689,280 @@ public:
       s.container.clear();
    }
 
+   /***************************************
+    * POP N / POP TO
+    ***************************************/
+
+   // pop several when the stack is empty
+   void test_popN_empty()
+   {  // setup
+      custom::stack<Spy> s;
+      Spy::reset();
+      // exercise
+      s.pop_n(3);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertEmptyFixture(s);
+   }  // teardown
+
+   // pop two from the standard stack
+   void test_popN_standard()
+   {  // setup
+      //    +----+----+----+----+
+      //    | 26 | 49 | 67 | 89 |
+      //    +----+----+----+----+
+      custom::stack<Spy> s;
+      setupStandardFixture(s);
+      Spy::reset();
+      // exercise
+      s.pop_n(2);
+      // verify
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDelete() == 2);      // delete of [67,89]
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 2);  // destroy of [67,89]
+      //    +----+----+----+----+
+      //    | 26 | 49 |    |    |
+      //    +----+----+----+----+
+      assertUnit(s.container.size() == 2);
+      assertUnit(s.container.capacity() == 4);
+      if (s.container.size() >= 2)
+      {
+         assertUnit(s.container[0] == Spy(26));
+         assertUnit(s.container[1] == Spy(49));
+      }
+      // teardown
+      teardownStandardFixture(s);
+   }
+
+   // pop more than there are elements
+   void test_popN_tooMany()
+   {  // setup
+      //    +----+----+----+----+
+      //    | 26 | 49 | 67 | 89 |
+      //    +----+----+----+----+
+      custom::stack<Spy> s;
+      setupStandardFixture(s);
+      Spy::reset();
+      // exercise
+      s.pop_n(10);
+      // verify
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDelete() == 4);      // delete of [26,49,67,89]
+      assertUnit(Spy::numDestructor() == 4);  // destroy of [26,49,67,89]
+      assertUnit(s.container.size() == 0);
+      assertUnit(s.container.capacity() == 4);
+      // teardown
+      teardownStandardFixture(s);
+   }
+
+   // pop several using std::list as container
+   void test_popN_standardList()
+   {  // setup
+      //    +----+----+----+----+
+      //    | 26 | 49 | 67 | 89 |
+      //    +----+----+----+----+
+      custom::stack<Spy, std::list<Spy>> s;
+      s.container.push_back(Spy(26));
+      s.container.push_back(Spy(49));
+      s.container.push_back(Spy(67));
+      s.container.push_back(Spy(89));
+      Spy::reset();
+      // exercise
+      s.pop_n(3);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDelete() == 3);      // delete of [49,67,89]
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 3);  // destroy of [49,67,89]
+      //    +----+
+      //    | 26 |
+      //    +----+
+      assertUnit(s.container.size() == 1);
+      if (s.container.size() >= 1)
+         assertUnit(s.container.front() == Spy(26));
+      // teardown
+      s.container.clear();
+   }
+
+   // pop down to a single element
+   void test_popTo_standard()
+   {  // setup
+      //    +----+----+----+----+
+      //    | 26 | 49 | 67 | 89 |
+      //    +----+----+----+----+
+      custom::stack<Spy> s;
+      setupStandardFixture(s);
+      Spy::reset();
+      // exercise
+      s.pop_to(1);
+      // verify
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDelete() == 3);      // delete of [49,67,89]
+      assertUnit(Spy::numDestructor() == 3);  // destroy of [49,67,89]
+      //    +----+----+----+----+
+      //    | 26 |    |    |    |
+      //    +----+----+----+----+
+      assertUnit(s.container.size() == 1);
+      if (s.container.size() >= 1)
+         assertUnit(s.container[0] == Spy(26));
+      // teardown
+      teardownStandardFixture(s);
+   }
+
+   // pop to a size above the current size does nothing
+   void test_popTo_larger()
+   {  // setup
+      //    +----+----+----+----+
+      //    | 26 | 49 | 67 | 89 |
+      //    +----+----+----+----+
+      custom::stack<Spy> s;
+      setupStandardFixture(s);
+      Spy::reset();
+      // exercise
+      s.pop_to(6);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertStandardFixture(s);
+      // teardown
+      teardownStandardFixture(s);
+   }
+
+
+   /***************************************
+    * INPUT / OUTPUT
+    ***************************************/
+
+   // a stack over a vector writes and reads in one block, bottom first
+   void test_writeTo_readFrom_vector()
+   {  // setup
+      std::FILE* file = std::tmpfile();
+      custom::stack<int> sSrc;
+      sSrc.push(26);
+      sSrc.push(49);
+      sSrc.push(67);
+      custom::stack<int> sDest;
+      // exercise
+      size_t numWritten = sSrc.write_to(fdOf(file));
+      std::fseek(file, 0, SEEK_SET);
+      size_t numRead = sDest.read_from(fdOf(file), 100);
+      // verify
+      assertUnit(numWritten == 3);
+      assertUnit(numRead == 3);
+      assertUnit(sDest.size() == 3);
+      assertUnit(sDest.top() == 67);
+      assertUnit(sDest.container.data[0] == 26);
+      // teardown
+      std::fclose(file);
+   }
+
+   // a stack over a deque writes its blocks with one writev
+   void test_writeTo_deque()
+   {  // setup
+      std::FILE* file = std::tmpfile();
+      custom::stack<int, std::deque<int>> s;
+      for (int i = 0; i < 1000; i++)
+         s.push(i);
+      custom::vector<int> v;
+      // exercise
+      size_t numWritten = s.write_to(fdOf(file));
+      std::fseek(file, 0, SEEK_SET);
+      v.read_from(fdOf(file), 2000);
+      // verify
+      assertUnit(numWritten == 1000);
+      assertUnit(v.size() == 1000);
+      bool same = v.size() == 1000;
+      for (int i = 0; same && i < 1000; i++)
+         same = v[i] == i;
+      assertUnit(same);
+      // teardown
+      std::fclose(file);
+   }
+
+   // a stack over a deque reads a block at a time
+   void test_readFrom_deque()
+   {  // setup
+      std::FILE* file = std::tmpfile();
+      custom::vector<int> v;
+      for (int i = 0; i < 5000; i++)
+         v.push_back(i);
+      v.write_to(fdOf(file));
+      std::fseek(file, 0, SEEK_SET);
+      custom::stack<int, std::deque<int>> s;
+      // exercise
+      size_t numRead = s.read_from(fdOf(file), 4500);
+      // verify
+      assertUnit(numRead == 4500);
+      assertUnit(s.size() == 4500);
+      assertUnit(s.top() == 4499);
+      assertUnit(s.container[0] == 0);
+      // teardown
+      std::fclose(file);
+   }
+
+   // a stack over a deque keeps the whole elements before a partial one
+   void test_readFrom_dequePartialElement()
+   {  // setup
+      std::FILE* file = std::tmpfile();
+      custom::vector<int> v{ 26, 49 };
+      v.write_to(fdOf(file));
+      custom::vector<char> half{ 1, 2 };
+      half.write_to(fdOf(file));                // 2.5 elements in all
+      std::fseek(file, 0, SEEK_SET);
+      custom::stack<int, std::deque<int>> s;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         s.read_from(fdOf(file), 10);
+      }
+      catch (const std::runtime_error&)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(s.size() == 2);
+      assertUnit(s.top() == 49);
+      assertUnit(s.container[0] == 26);
+      // teardown
+      std::fclose(file);
+   }
+
+   /*************************************************************
+    * FD OF
+    * The file descriptor underneath a FILE
+    *************************************************************/
+   static int fdOf(std::FILE* file)
+   {
+#ifdef _WIN32
+      return _fileno(file);
+#else
+      return fileno(file);
+#endif
+   }
+
    
    /*************************************************************
     * SETUP STANDARD FIXTURE
@@ -0,0 +1,386 @@
+/***********************************************************************
+ * Header:
+ *    TEST SYNCHRONIZED STACK
+ * Summary:
+ *    Unit tests for synchronized_stack and its locks
+ * Author
+ *    Br. Helfrich
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+#include "synchronized_stack.h"
+#include "unitTest.h"
+#include "spy.h"
+
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+class TestSynchronizedStack : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Locks
+      test_spinlock_tryLock();
+      test_spinlock_exclusive();
+      test_ticketLock_tryLock();
+      test_ticketLock_exclusive();
+
+      // Construct
+      test_construct_default();
+
+      // Insert
+      test_push_standard();
+      test_pushBulk_standard();
+
+      // Remove
+      test_tryPop_empty();
+      test_tryPop_lifo();
+      test_popWait_ready();
+      test_popWait_blocks();
+      test_popFor_timeout();
+      test_popFor_arrives();
+      test_pushBulk_wakesAll();
+
+      // Threads
+      test_threads_mutex();
+      test_threads_spinlock();
+      test_threads_ticketLock();
+
+      report("SynchronizedStack");
+   }
+
+   /***************************************
+    * LOCKS
+    ***************************************/
+
+   // try_lock fails while the spinlock is held
+   void test_spinlock_tryLock()
+   {  // setup
+      custom::spinlock lock;
+      // exercise
+      bool first = lock.try_lock();
+      bool second = lock.try_lock();
+      lock.unlock();
+      bool third = lock.try_lock();
+      // verify
+      assertUnit(first);
+      assertUnit(!second);
+      assertUnit(third);
+      lock.unlock();
+   }  // teardown
+
+   // threads incrementing under the spinlock lose nothing
+   void test_spinlock_exclusive()
+   {  // setup
+      custom::spinlock lock;
+      // exercise
+      long count = countUnder(lock);
+      // verify
+      assertUnit(count == 4 * 10000);
+   }  // teardown
+
+   // try_lock fails while a ticket is being served
+   void test_ticketLock_tryLock()
+   {  // setup
+      custom::ticket_lock lock;
+      // exercise
+      bool first = lock.try_lock();
+      bool second = lock.try_lock();
+      lock.unlock();
+      bool third = lock.try_lock();
+      // verify
+      assertUnit(first);
+      assertUnit(!second);
+      assertUnit(third);
+      assertUnit(lock.next == 2);
+      assertUnit(lock.serving == 1);
+      lock.unlock();
+   }  // teardown
+
+   // threads incrementing under the ticket lock lose nothing
+   void test_ticketLock_exclusive()
+   {  // setup
+      custom::ticket_lock lock;
+      // exercise
+      long count = countUnder(lock);
+      // verify
+      assertUnit(count == 4 * 10000);
+      assertUnit(lock.next == lock.serving);
+   }  // teardown
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // empty, nobody waiting
+   void test_construct_default()
+   {  // setup
+      Spy::reset();
+      // exercise
+      custom::synchronized_stack<Spy> s;
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(s.empty());
+      assertUnit(s.numWaiting == 0);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // push moves the element onto the stack
+   void test_push_standard()
+   {  // setup
+      custom::synchronized_stack<Spy> s;
+      Spy::reset();
+      // exercise
+      s.push(Spy(26));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 1);
+      assertUnit(s.size() == 1);
+      assertUnit(s.items.top() == Spy(26));
+   }  // teardown
+
+   // push_bulk pushes in order, so the last is on top
+   void test_pushBulk_standard()
+   {  // setup
+      custom::synchronized_stack<int> s;
+      int values[] = { 26, 49, 67, 89 };
+      // exercise
+      s.push_bulk(values, values + 4);
+      // verify
+      assertUnit(s.size() == 4);
+      assertUnit(s.items.top() == 89);
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // try_pop on an empty stack leaves t alone
+   void test_tryPop_empty()
+   {  // setup
+      custom::synchronized_stack<int> s;
+      int value = 7;
+      // exercise
+      bool popped = s.try_pop(value);
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == 7);
+   }  // teardown
+
+   // try_pop takes the last thing pushed
+   void test_tryPop_lifo()
+   {  // setup
+      custom::synchronized_stack<int> s;
+      s.push(1);
+      s.push(2);
+      int value = 0;
+      // exercise
+      bool popped = s.try_pop(value);
+      // verify
+      assertUnit(popped);
+      assertUnit(value == 2);
+      assertUnit(s.size() == 1);
+   }  // teardown
+
+   // pop_wait on a non-empty stack does not block
+   void test_popWait_ready()
+   {  // setup
+      custom::synchronized_stack<int> s;
+      s.push(49);
+      // exercise
+      int value = s.pop_wait();
+      // verify
+      assertUnit(value == 49);
+      assertUnit(s.empty());
+      assertUnit(s.numWaiting == 0);
+   }  // teardown
+
+   // pop_wait blocks until another thread pushes
+   void test_popWait_blocks()
+   {  // setup
+      custom::synchronized_stack<int> s;
+      std::atomic<int> got(0);
+      std::thread consumer([&]() { got = s.pop_wait(); });
+      waitForWaiters(s, 1);
+      // exercise
+      assertUnit(got == 0);
+      s.push(67);
+      consumer.join();
+      // verify
+      assertUnit(got == 67);
+      assertUnit(s.numWaiting == 0);
+   }  // teardown
+
+   // pop_for gives up when nothing arrives
+   void test_popFor_timeout()
+   {  // setup
+      custom::synchronized_stack<int> s;
+      int value = 7;
+      auto begin = std::chrono::steady_clock::now();
+      // exercise
+      bool popped = s.pop_for(value, std::chrono::milliseconds(20));
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == 7);
+      assertUnit(std::chrono::steady_clock::now() - begin >= std::chrono::milliseconds(20));
+      assertUnit(s.numWaiting == 0);
+   }  // teardown
+
+   // pop_for takes an element that arrives in time
+   void test_popFor_arrives()
+   {  // setup
+      custom::synchronized_stack<int, custom::vector<int>, custom::ticket_lock_policy> s;
+      std::atomic<bool> popped(false);
+      int value = 0;
+      std::thread consumer([&]() { popped = s.pop_for(value, std::chrono::seconds(10)); });
+      waitForWaiters(s, 1);
+      // exercise
+      s.push(89);
+      consumer.join();
+      // verify
+      assertUnit(popped);
+      assertUnit(value == 89);
+   }  // teardown
+
+   // one batch wakes every waiting consumer
+   void test_pushBulk_wakesAll()
+   {  // setup
+      custom::synchronized_stack<int, custom::vector<int>, custom::spinlock_policy> s;
+      std::atomic<int> sum(0);
+      std::vector<std::thread> consumers;
+      for (int i = 0; i < 3; i++)
+         consumers.emplace_back([&]() { sum += s.pop_wait(); });
+      waitForWaiters(s, 3);
+      int values[] = { 1, 2, 3 };
+      // exercise
+      s.push_bulk(values, values + 3);
+      for (auto& consumer : consumers)
+         consumer.join();
+      // verify
+      assertUnit(sum == 6);
+      assertUnit(s.empty());
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // producers and blocking consumers, one test per lock policy
+   void test_threads_mutex()
+   {
+      custom::synchronized_stack<int, custom::vector<int>, custom::mutex_policy> s;
+      assertUnit(producersAndConsumers(s));
+   }
+   void test_threads_spinlock()
+   {
+      custom::synchronized_stack<int, custom::vector<int>, custom::spinlock_policy> s;
+      assertUnit(producersAndConsumers(s));
+   }
+   void test_threads_ticketLock()
+   {
+      custom::synchronized_stack<int, custom::vector<int>, custom::ticket_lock_policy> s;
+      assertUnit(producersAndConsumers(s));
+   }
+
+   /*************************************************************
+    * HELPERS
+    *************************************************************/
+
+   // four threads each add 10000 to a plain counter under the lock
+   template <class Lock>
+   long countUnder(Lock& lock)
+   {
+      long count = 0;
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 4; t++)
+         threads.emplace_back([&]() {
+            for (int i = 0; i < 10000; i++)
+            {
+               lock.lock();
+               count++;
+               lock.unlock();
+            }
+            });
+      for (auto& thread : threads)
+         thread.join();
+      return count;
+   }
+
+   // wait until this many consumers are blocked on the stack
+   template <class Stack>
+   void waitForWaiters(Stack& s, size_t num)
+   {
+      for (;;)
+      {
+         {
+            std::unique_lock<decltype(s.lock)> guard(s.lock);
+            if (s.numWaiting >= num)
+               return;
+         }
+         std::this_thread::yield();
+      }
+   }
+
+   // two producers (one pushing singly, one in batches) and three
+   // consumers blocking in pop_wait: every value arrives exactly once
+   template <class Stack>
+   bool producersAndConsumers(Stack& s)
+   {
+      const int numEach = 3000;
+      std::vector<int> seen(2 * numEach, 0);
+      std::vector<std::thread> threads;
+      std::atomic<int> numLeft(2 * numEach);
+      std::mutex seenLock;
+
+      threads.emplace_back([&]() {
+         for (int i = 0; i < numEach; i++)
+            s.push(i);
+         });
+      threads.emplace_back([&]() {
+         std::vector<int> batch;
+         for (int i = numEach; i < 2 * numEach; i++)
+         {
+            batch.push_back(i);
+            if (batch.size() == 10)
+            {
+               s.push_bulk(batch.begin(), batch.end());
+               batch.clear();
+            }
+         }
+         s.push_bulk(batch.begin(), batch.end());
+         });
+      for (int c = 0; c < 3; c++)
+         threads.emplace_back([&]() {
+            int value;
+            while (numLeft > 0)
+               if (s.pop_for(value, std::chrono::milliseconds(5)))
+               {
+                  numLeft--;
+                  std::lock_guard<std::mutex> guard(seenLock);
+                  seen[value]++;
+               }
+            });
+      for (auto& thread : threads)
+         thread.join();
+
+      bool once = true;
+      for (int count : seen)
+         once = once && count == 1;
+      return once && s.empty();
+   }
+
+};
+
+#endif // DEBUG
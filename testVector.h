@@ -17,7 +17,13 @@
 #include "spy.h"
 
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
 #include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <memory_resource>
+#include <new>
 
 class TestVector : public UnitTest
 {
@@ -97,6 +103,11 @@ public:
       test_resize_fourZero();
       test_resize_fourSixDefault();
       test_resize_fourSixValue();
+      test_resizeOverwrite_untouched();
+      test_resizeOverwrite_shrink();
+      test_resizeOverwrite_nontrivial();
+      test_reserveAndWrite_empty();
+      test_reserveAndWrite_grow();
       test_reserve_emptyZero();
       test_reserve_emptyTen();
       test_reserve_fourZero();
@@ -104,6 +115,16 @@ public:
       test_reserve_fourTen();
       test_reserve_standardZero();
       test_reserve_standardTen();
+      test_reserve_tryExpand();
+      test_reserve_reallocateTrivial();
+      test_reserve_reallocateNotTrivial();
+      test_insert_empty();
+      test_insert_middleReallocate();
+      test_insert_middleExcessCapacity();
+      test_insert_move();
+      test_insert_ownElement();
+      test_insert_count();
+      test_insert_trivial();
 
       // Remove
       test_popback_empty();
@@ -112,6 +133,19 @@ public:
       test_clear_empty();
       test_clear_full();
       test_clear_partiallyFilled();
+      test_clear_trivial();
+      test_truncate_empty();
+      test_truncate_fourTwo();
+      test_truncate_fourSix();
+      test_truncate_trivial();
+      test_erase_middle();
+      test_erase_last();
+      test_erase_range();
+      test_erase_rangeEmpty();
+      test_erase_trivial();
+      test_eraseIf_none();
+      test_eraseIf_standard();
+      test_eraseIf_trivial();
       test_shrink_empty();
       test_shrink_toEmpty();
       test_shrink_standard();
@@ -125,6 +159,21 @@ public:
       test_capacity_empty();
       test_capacity_full();
 
+      // Input / Output
+      test_writeTo_readFrom_roundTrip();
+      test_readFrom_appends();
+      test_readFrom_partialElement();
+      test_writeTo_badFd();
+
+      // Allocator
+      test_constructCopy_keepsAllocator();
+      test_assign_propagatesAllocator();
+      test_swap_propagatesAllocator();
+      test_pmr_usesResource();
+      test_pmr_constructCopy_defaultResource();
+      test_pmr_assignMove_sameResource();
+      test_pmr_assignMove_otherResource();
+
       report("Vector");
    }
    
@@ -282,8 +331,8 @@ public:
          //    +----+----+----+----+
          custom::vector<Spy> v;
          v.data = v.alloc.allocate(4);
-         v.alloc.construct(&v.data[0], Spy(99));
-         v.alloc.construct(&v.data[1], Spy(99));
+         new (&v.data[0]) Spy(99);
+         new (&v.data[1]) Spy(99);
          v.numElements = 2;
          v.numCapacity = 4;
          Spy::reset();
@@ -367,8 +416,8 @@ public:
       //    +----+----+----+----+
       custom::vector<Spy> vSrc;
       vSrc.data = vSrc.alloc.allocate(4);
-      vSrc.alloc.construct(&vSrc.data[0], Spy(26));
-      vSrc.alloc.construct(&vSrc.data[1], Spy(49));
+      new (&vSrc.data[0]) Spy(26);
+      new (&vSrc.data[1]) Spy(49);
       vSrc.numElements = 2;
       vSrc.numCapacity = 4;
       Spy::reset();
@@ -479,8 +528,8 @@ public:
       //    +----+----+----+----+
       custom::vector<Spy> vSrc;
       vSrc.data = vSrc.alloc.allocate(4);
-      vSrc.alloc.construct(&vSrc.data[0], Spy(26));
-      vSrc.alloc.construct(&vSrc.data[1], Spy(49));
+      new (&vSrc.data[0]) Spy(26);
+      new (&vSrc.data[1]) Spy(49);
       vSrc.numElements = 2;
       vSrc.numCapacity = 4;
       Spy::reset();
@@ -755,6 +804,97 @@ public:
       // teardown
       teardownStandardFixture(v);
    }
+
+   // grow without writing anything into the new elements
+   void test_resizeOverwrite_untouched()
+   {  // setup
+      custom::vector<int> v{ 26, 49, 67, 89 };
+      v.reserve(8);
+      for (int i = 4; i < 8; i++)
+         v.data[i] = 77;
+      // exercise
+      v.resize_for_overwrite(6);
+      // verify
+      assertUnit(v.numElements == 6);
+      assertUnit(v.numCapacity == 8);
+      assertUnit(v.data[3] == 89);
+      assertUnit(v.data[4] == 77);
+      assertUnit(v.data[5] == 77);
+   }  // teardown
+
+   // shrinking destroys the extra elements, as resize does
+   void test_resizeOverwrite_shrink()
+   {  // setup
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      Spy::reset();
+      // exercise
+      v.resize_for_overwrite(2);
+      // verify
+      assertUnit(Spy::numDestructor() == 2);   // destroy [67,89]
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(v.numElements == 2);
+      assertUnit(v.numCapacity == 4);
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // a class with a constructor still gets constructed
+   void test_resizeOverwrite_nontrivial()
+   {  // setup
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      Spy::reset();
+      // exercise
+      v.resize_for_overwrite(6);
+      // verify
+      assertUnit(Spy::numDefault() == 2);      // default-create [0,0]
+      assertUnit(Spy::numCopyMove() == 4);     // move [26,49,67,89]
+      assertUnit(v.numElements == 6);
+      assertUnit(v.numCapacity == 6);
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // the producer writes fewer than it was offered
+   void test_reserveAndWrite_empty()
+   {  // setup
+      custom::vector<int> v;
+      size_t numOffered = 0;
+      // exercise
+      size_t num = v.reserve_and_write(4, [&numOffered](int* first, size_t num) {
+         numOffered = num;
+         first[0] = 26;
+         first[1] = 49;
+         first[2] = 67;
+         return (size_t)3;
+         });
+      // verify
+      assertUnit(num == 3);
+      assertUnit(numOffered == 4);
+      assertUnit(v.numElements == 3);
+      assertUnit(v.numCapacity == 4);
+      assertUnit(v.data[0] == 26);
+      assertUnit(v.data[2] == 67);
+   }  // teardown
+
+   // the writing starts after the last element, and capacity doubles
+   void test_reserveAndWrite_grow()
+   {  // setup
+      custom::vector<int> v{ 26, 49, 67, 89 };
+      int* dataOld = v.data;
+      // exercise
+      v.reserve_and_write(1, [](int* first, size_t) {
+         *first = 11;
+         return (size_t)1;
+         });
+      // verify
+      assertUnit(v.data != dataOld);
+      assertUnit(v.numElements == 5);
+      assertUnit(v.numCapacity == 8);
+      assertUnit(v.data[3] == 89);
+      assertUnit(v.data[4] == 11);
+   }  // teardown
    
    // reserve zero on an empty vector
    void test_reserve_emptyZero()
@@ -971,6 +1111,67 @@ public:
       teardownStandardFixture(v);
    }
    
+   // an allocator that grows the block in place saves moving anything
+   void test_reserve_tryExpand()
+   {  // setup
+      custom::vector<Spy, GrowingAllocator<Spy>> v;
+      v.reserve(4);
+      v.push_back(Spy(26));
+      v.push_back(Spy(49));
+      Spy* before = v.data;
+      GrowingAllocator<Spy>::reset(true);
+      Spy::reset();
+      // exercise
+      v.reserve(10);
+      // verify
+      assertUnit(GrowingAllocator<Spy>::numExpand == 1);
+      assertUnit(GrowingAllocator<Spy>::numReallocate == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(v.data == before);
+      assertUnit(v.numCapacity == 10);
+      assertUnit(v.numElements == 2);
+      assertUnit(v.data[1] == Spy(49));
+   }  // teardown
+
+   // one that cannot may still move the bytes itself, when they are just bytes
+   void test_reserve_reallocateTrivial()
+   {  // setup
+      custom::vector<int, GrowingAllocator<int>> v;
+      for (int i = 0; i < 4; i++)
+         v.push_back(i * 10);
+      GrowingAllocator<int>::reset(false);
+      // exercise
+      v.reserve(1000);
+      // verify
+      assertUnit(GrowingAllocator<int>::numExpand == 1);
+      assertUnit(GrowingAllocator<int>::numReallocate == 1);
+      assertUnit(v.numCapacity == 1000);
+      assertUnit(v.numElements == 4);
+      assertUnit(v.data[0] == 0);
+      assertUnit(v.data[3] == 30);
+   }  // teardown
+
+   // but elements that are not just bytes are moved one by one
+   void test_reserve_reallocateNotTrivial()
+   {  // setup
+      custom::vector<Spy, GrowingAllocator<Spy>> v;
+      v.reserve(4);
+      v.push_back(Spy(26));
+      v.push_back(Spy(49));
+      GrowingAllocator<Spy>::reset(false);
+      Spy::reset();
+      // exercise
+      v.reserve(10);
+      // verify
+      assertUnit(GrowingAllocator<Spy>::numExpand == 1);
+      assertUnit(GrowingAllocator<Spy>::numReallocate == 0);
+      assertUnit(Spy::numCopyMove() == 2);
+      assertUnit(Spy::numDestructor() == 2);
+      assertUnit(v.numCapacity == 10);
+      assertUnit(v.data[0] == Spy(26));
+   }  // teardown
+
    // shrink an empty fixture
    void test_shrink_empty()
    {  // setup
@@ -1054,10 +1255,10 @@ public:
       //    +----+----+----+----+----+----+
       custom::vector<Spy> v;
       v.data = v.alloc.allocate(6);
-      v.alloc.construct(&v.data[0], Spy(26));
-      v.alloc.construct(&v.data[1], Spy(49));
-      v.alloc.construct(&v.data[2], Spy(67));
-      v.alloc.construct(&v.data[3], Spy(89));
+      new (&v.data[0]) Spy(26);
+      new (&v.data[1]) Spy(49);
+      new (&v.data[2]) Spy(67);
+      new (&v.data[3]) Spy(89);
       v.numElements = 4;
       v.numCapacity = 6;
       Spy::reset();
@@ -1274,8 +1475,8 @@ public:
       //    +----+----+
       custom::vector<Spy> vDest;
       vDest.data = vDest.alloc.allocate(2);
-      vDest.alloc.construct(&vDest.data[0], Spy(99));
-      vDest.alloc.construct(&vDest.data[1], Spy(99));
+      new (&vDest.data[0]) Spy(99);
+      new (&vDest.data[1]) Spy(99);
       vDest.numElements = 2;
       vDest.numCapacity = 2;
       Spy::reset();
@@ -1323,8 +1524,8 @@ public:
       //    +----+----+
       custom::vector<Spy> vSrc;
       vSrc.data = vSrc.alloc.allocate(2);
-      vSrc.alloc.construct(&vSrc.data[0], Spy(99));
-      vSrc.alloc.construct(&vSrc.data[1], Spy(99));
+      new (&vSrc.data[0]) Spy(99);
+      new (&vSrc.data[1]) Spy(99);
       vSrc.numElements = 2;
       vSrc.numCapacity = 2;
       //      0    1    2    3
@@ -1459,8 +1660,8 @@ public:
       //    +----+----+
       custom::vector<Spy> vDest;
       vDest.data = vDest.alloc.allocate(2);
-      vDest.alloc.construct(&vDest.data[0], Spy(99));
-      vDest.alloc.construct(&vDest.data[1], Spy(99));
+      new (&vDest.data[0]) Spy(99);
+      new (&vDest.data[1]) Spy(99);
       vDest.numElements = 2;
       vDest.numCapacity = 2;
       Spy::reset();
@@ -1501,8 +1702,8 @@ public:
       //    +----+----+
       custom::vector<Spy> vSrc;
       vSrc.data = vSrc.alloc.allocate(2);
-      vSrc.alloc.construct(&vSrc.data[0], Spy(99));
-      vSrc.alloc.construct(&vSrc.data[1], Spy(99));
+      new (&vSrc.data[0]) Spy(99);
+      new (&vSrc.data[1]) Spy(99);
       vSrc.numElements = 2;
       vSrc.numCapacity = 2;
       //      0    1    2    3
@@ -1635,8 +1836,8 @@ public:
       //    +----+----+
       custom::vector<Spy> vDest;
       vDest.data = vDest.alloc.allocate(2);
-      vDest.alloc.construct(&vDest.data[0], Spy(99));
-      vDest.alloc.construct(&vDest.data[1], Spy(99));
+      new (&vDest.data[0]) Spy(99);
+      new (&vDest.data[1]) Spy(99);
       vDest.numElements = 2;
       vDest.numCapacity = 2;
       Spy::reset();
@@ -1673,8 +1874,8 @@ public:
       //    +----+----+
       custom::vector<Spy> vSrc;
       vSrc.data = vSrc.alloc.allocate(2);
-      vSrc.alloc.construct(&vSrc.data[0], Spy(99));
-      vSrc.alloc.construct(&vSrc.data[1], Spy(99));
+      new (&vSrc.data[0]) Spy(99);
+      new (&vSrc.data[1]) Spy(99);
       vSrc.numElements = 2;
       vSrc.numCapacity = 2;
       //      0    1    2    3
@@ -1730,8 +1931,8 @@ public:
       try
       {
          vDes.data = vDes.alloc.allocate(4);
-         vDes.alloc.construct(&vDes.data[0], Spy(11));
-         vDes.alloc.construct(&vDes.data[1], Spy(99));
+         new (&vDes.data[0]) Spy(11);
+         new (&vDes.data[1]) Spy(99);
          vDes.numElements = 2;
          vDes.numCapacity = 4;
       }
@@ -1774,8 +1975,8 @@ public:
       try
       {
          vDes.data = vDes.alloc.allocate(4);
-         vDes.alloc.construct(&vDes.data[0], Spy(11));
-         vDes.alloc.construct(&vDes.data[1], Spy(99));
+         new (&vDes.data[0]) Spy(11);
+         new (&vDes.data[1]) Spy(99);
          vDes.numElements = 2;
          vDes.numCapacity = 4;
       }
@@ -2014,8 +2215,8 @@ public:
       try
       {
          v.data = v.alloc.allocate(4);
-         v.alloc.construct(&v.data[0], Spy(11));
-         v.alloc.construct(&v.data[1], Spy(22));
+         new (&v.data[0]) Spy(11);
+         new (&v.data[1]) Spy(22);
          v.numElements = 2;
          v.numCapacity = 4;
       }
@@ -2123,8 +2324,8 @@ public:
       //    +----+----+----+----+
       custom::vector<Spy> v;
       v.data = v.alloc.allocate(4);
-      v.alloc.construct(&v.data[0], Spy(26));
-      v.alloc.construct(&v.data[1], Spy(49));
+      new (&v.data[0]) Spy(26);
+      new (&v.data[1]) Spy(49);
       v.numElements = 2;
       v.numCapacity = 4;
       Spy::reset();
@@ -2220,8 +2421,8 @@ public:
       //    +----+----+----+----+
       custom::vector<Spy> v;
       v.data = v.alloc.allocate(4);
-      v.alloc.construct(&v.data[0], Spy(26));
-      v.alloc.construct(&v.data[1], Spy(49));
+      new (&v.data[0]) Spy(26);
+      new (&v.data[1]) Spy(49);
       v.numElements = 2;
       v.numCapacity = 4;
       Spy::reset();
@@ -2248,6 +2449,138 @@ public:
       teardownStandardFixture(v);
    }
 
+
+   // clear a trivially destructible collection
+   void test_clear_trivial()
+   {  // setup
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 26 | 49 | 67 | 89 |
+      //    +----+----+----+----+
+      custom::vector<int> v{26, 49, 67, 89};
+      int* p = v.data;
+      // exercise
+      v.clear();
+      // verify
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    |    |    |    |    |
+      //    +----+----+----+----+
+      assertUnit(v.numCapacity == 4);
+      assertUnit(v.numElements == 0);
+      assertUnit(v.data == p);
+   }  // teardown
+
+   /***************************************
+    * TRUNCATE
+    ***************************************/
+
+   // truncate an empty collection
+   void test_truncate_empty()
+   {  // setup
+      custom::vector<Spy> v;
+      Spy::reset();
+      // exercise
+      v.truncate(0);
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertEmptyFixture(v);
+   }  // teardown
+
+   // truncate a standard collection down to two elements
+   void test_truncate_fourTwo()
+   {  // setup
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 26 | 49 | 67 | 89 |
+      //    +----+----+----+----+
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      Spy::reset();
+      // exercise
+      v.truncate(2);
+      // verify
+      assertUnit(Spy::numDestructor() == 2);   // destroy [67,89]
+      assertUnit(Spy::numDelete() == 2);       // delete [67,89]
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 26 | 49 |    |    |
+      //    +----+----+----+----+
+      assertUnit(v.numCapacity == 4);
+      assertUnit(v.numElements == 2);
+      assertUnit(v.data != nullptr);
+      if (v.data != nullptr)
+      {
+         assertUnit(v.data[0] == Spy(26));
+         assertUnit(v.data[1] == Spy(49));
+      }
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // truncate to a size larger than the collection does nothing
+   void test_truncate_fourSix()
+   {  // setup
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 26 | 49 | 67 | 89 |
+      //    +----+----+----+----+
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      Spy::reset();
+      // exercise
+      v.truncate(6);
+      // verify
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertStandardFixture(v);
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // truncate a trivially destructible collection
+   void test_truncate_trivial()
+   {  // setup
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 26 | 49 | 67 | 89 |
+      //    +----+----+----+----+
+      custom::vector<int> v{26, 49, 67, 89};
+      // exercise
+      v.truncate(1);
+      // verify
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 26 |    |    |    |
+      //    +----+----+----+----+
+      assertUnit(v.numCapacity == 4);
+      assertUnit(v.numElements == 1);
+      assertUnit(v.data != nullptr);
+      if (v.data != nullptr)
+         assertUnit(v.data[0] == 26);
+   }  // teardown
    
    /***************************************
     * PUSH BACK
@@ -2293,9 +2626,9 @@ public:
       //    +----+----+----+----+
       custom::vector<Spy> v;
       v.data = v.alloc.allocate(4);
-      v.alloc.construct(&v.data[0], Spy(26));
-      v.alloc.construct(&v.data[1], Spy(49));
-      v.alloc.construct(&v.data[2], Spy(67));
+      new (&v.data[0]) Spy(26);
+      new (&v.data[1]) Spy(49);
+      new (&v.data[2]) Spy(67);
       v.numElements = 3;
       v.numCapacity = 4;
       Spy s(89);
@@ -2330,9 +2663,9 @@ public:
       //    +----+----+----+
       custom::vector<Spy> v;
       v.data = v.alloc.allocate(3);
-      v.alloc.construct(&v.data[0], Spy(26));
-      v.alloc.construct(&v.data[1], Spy(49));
-      v.alloc.construct(&v.data[2], Spy(67));
+      new (&v.data[0]) Spy(26);
+      new (&v.data[1]) Spy(49);
+      new (&v.data[2]) Spy(67);
       v.numElements = 3;
       v.numCapacity = 3;
       Spy s(99);
@@ -2408,9 +2741,9 @@ public:
      //    +----+----+----+----+
       custom::vector<Spy> v;
       v.data = v.alloc.allocate(4);
-      v.alloc.construct(&v.data[0], Spy(26));
-      v.alloc.construct(&v.data[1], Spy(49));
-      v.alloc.construct(&v.data[2], Spy(67));
+      new (&v.data[0]) Spy(26);
+      new (&v.data[1]) Spy(49);
+      new (&v.data[2]) Spy(67);
       v.numElements = 3;
       v.numCapacity = 4;
       Spy s(89);
@@ -2445,9 +2778,9 @@ public:
       //    +----+----+----+
       custom::vector<Spy> v;
       v.data = v.alloc.allocate(3);
-      v.alloc.construct(&v.data[0], Spy(26));
-      v.alloc.construct(&v.data[1], Spy(49));
-      v.alloc.construct(&v.data[2], Spy(67));
+      new (&v.data[0]) Spy(26);
+      new (&v.data[1]) Spy(49);
+      new (&v.data[2]) Spy(67);
       v.numElements = 3;
       v.numCapacity = 3;
       Spy s(99);
@@ -2853,6 +3186,712 @@ public:
       // teardown
       teardownStandardFixture(v);
    }
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // insert into an empty vector
+   void test_insert_empty()
+   {  // setup
+      custom::vector<Spy> v;
+      Spy s(26);
+      Spy::reset();
+      // exercise
+      custom::vector<Spy>::iterator it = v.insert(v.begin(), s);
+      // verify
+      assertUnit(Spy::numCopy() == 1);           // copy [26]
+      assertUnit(Spy::numAlloc() == 1);          // allocate [26]
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(v.numElements == 1);
+      assertUnit(v.numCapacity == 1);
+      assertUnit(it.p == v.data);
+      if (v.data != nullptr)
+         assertUnit(v.data[0] == Spy(26));
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // insert into a full vector: each half moves straight into the new buffer
+   void test_insert_middleReallocate()
+   {  // setup
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 26 | 49 | 67 | 89 |
+      //    +----+----+----+----+
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      custom::vector<Spy>::iterator it = v.insert(custom::vector<Spy>::iterator(v.data + 1), s);
+      // verify
+      assertUnit(Spy::numCopyMove() == 4);       // move [26,49,67,89]
+      assertUnit(Spy::numDestructor() == 4);     // destroy the moved-from
+      assertUnit(Spy::numCopy() == 1);           // copy [99]
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      //      0    1    2    3    4    5    6    7
+      //    +----+----+----+----+----+----+----+----+
+      //    | 26 | 99 | 49 | 67 | 89 |    |    |    |
+      //    +----+----+----+----+----+----+----+----+
+      assertUnit(v.numCapacity == 8);
+      assertUnit(v.numElements == 5);
+      assertUnit(it.p == v.data + 1);
+      if (v.data != nullptr && v.numElements == 5)
+      {
+         assertUnit(v.data[0] == Spy(26));
+         assertUnit(v.data[1] == Spy(99));
+         assertUnit(v.data[2] == Spy(49));
+         assertUnit(v.data[3] == Spy(67));
+         assertUnit(v.data[4] == Spy(89));
+      }
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // insert with room to spare: only the elements after pos move
+   void test_insert_middleExcessCapacity()
+   {  // setup
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 26 | 49 | 67 |    |
+      //    +----+----+----+----+
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      v.data[3].~Spy();
+      v.numElements = 3;
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      v.insert(custom::vector<Spy>::iterator(v.data + 1), s);
+      // verify
+      assertUnit(Spy::numCopyMove() == 2);       // move [49,67]
+      assertUnit(Spy::numDestructor() == 2);
+      assertUnit(Spy::numCopy() == 1);           // copy [99]
+      assertUnit(Spy::numAlloc() == 1);          // allocate [99]
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 26 | 99 | 49 | 67 |
+      //    +----+----+----+----+
+      assertUnit(v.numCapacity == 4);
+      assertUnit(v.numElements == 4);
+      if (v.data != nullptr)
+      {
+         assertUnit(v.data[0] == Spy(26));
+         assertUnit(v.data[1] == Spy(99));
+         assertUnit(v.data[2] == Spy(49));
+         assertUnit(v.data[3] == Spy(67));
+      }
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // inserting an rvalue moves it rather than copying
+   void test_insert_move()
+   {  // setup
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      v.insert(v.begin(), std::move(s));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 5);       // move [99,26,49,67,89]
+      assertUnit(v.numElements == 5);
+      if (v.data != nullptr && v.numElements == 5)
+      {
+         assertUnit(v.data[0] == Spy(99));
+         assertUnit(v.data[4] == Spy(89));
+      }
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // inserting one of our own elements copies it before anything moves
+   void test_insert_ownElement()
+   {  // setup
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 26 | 49 | 67 | 89 |
+      //    +----+----+----+----+
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      // exercise
+      v.insert(v.begin(), v.data[3]);
+      // verify
+      //      0    1    2    3    4
+      //    +----+----+----+----+----+
+      //    | 89 | 26 | 49 | 67 | 89 |
+      //    +----+----+----+----+----+
+      assertUnit(v.numElements == 5);
+      if (v.data != nullptr && v.numElements == 5)
+      {
+         assertUnit(v.data[0] == Spy(89));
+         assertUnit(v.data[1] == Spy(26));
+         assertUnit(v.data[4] == Spy(89));
+      }
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // insert several copies at once
+   void test_insert_count()
+   {  // setup
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      custom::vector<Spy>::iterator it = v.insert(v.end(), 3, s);
+      // verify
+      assertUnit(Spy::numCopy() == 3);           // copy [99,99,99]
+      assertUnit(Spy::numCopyMove() == 4);       // move [26,49,67,89]
+      assertUnit(v.numCapacity == 8);
+      assertUnit(v.numElements == 7);
+      assertUnit(it.p == v.data + 4);
+      if (v.data != nullptr && v.numElements == 7)
+      {
+         assertUnit(v.data[3] == Spy(89));
+         assertUnit(v.data[4] == Spy(99));
+         assertUnit(v.data[6] == Spy(99));
+      }
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // trivially copyable elements slide over in one block
+   void test_insert_trivial()
+   {  // setup
+      custom::vector<int> v{ 26, 49, 67, 89 };
+      v.reserve(8);
+      // exercise
+      v.insert(custom::vector<int>::iterator(v.data + 2), 2, 99);
+      v.insert(v.begin(), 11);
+      // verify
+      assertUnit(v.numElements == 7);
+      assertUnit(v.numCapacity == 8);
+      assertUnit(v.data[0] == 11);
+      assertUnit(v.data[1] == 26);
+      assertUnit(v.data[2] == 49);
+      assertUnit(v.data[3] == 99);
+      assertUnit(v.data[4] == 99);
+      assertUnit(v.data[5] == 67);
+      assertUnit(v.data[6] == 89);
+   }  // teardown
+
+   /***************************************
+    * ERASE
+    ***************************************/
+
+   // erase one from the middle: the rest slide forward
+   void test_erase_middle()
+   {  // setup
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 26 | 49 | 67 | 89 |
+      //    +----+----+----+----+
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      Spy::reset();
+      // exercise
+      custom::vector<Spy>::iterator it = v.erase(custom::vector<Spy>::iterator(v.data + 1));
+      // verify
+      assertUnit(Spy::numDestructor() == 3);     // [49], then the moved-from [67,89]
+      assertUnit(Spy::numCopyMove() == 2);       // move [67,89]
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 26 | 67 | 89 |    |
+      //    +----+----+----+----+
+      assertUnit(v.numCapacity == 4);
+      assertUnit(v.numElements == 3);
+      assertUnit(it.p == v.data + 1);
+      if (v.data != nullptr)
+      {
+         assertUnit(v.data[0] == Spy(26));
+         assertUnit(v.data[1] == Spy(67));
+         assertUnit(v.data[2] == Spy(89));
+      }
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // erase the last element: nothing moves
+   void test_erase_last()
+   {  // setup
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      Spy::reset();
+      // exercise
+      custom::vector<Spy>::iterator it = v.erase(custom::vector<Spy>::iterator(v.data + 3));
+      // verify
+      assertUnit(Spy::numDestructor() == 1);     // [89]
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(v.numElements == 3);
+      assertUnit(it == v.end());
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // erase a range from the front
+   void test_erase_range()
+   {  // setup
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      Spy::reset();
+      // exercise
+      v.erase(v.begin(), custom::vector<Spy>::iterator(v.data + 2));
+      // verify
+      assertUnit(Spy::numDestructor() == 4);     // [26,49], then the moved-from [67,89]
+      assertUnit(Spy::numCopyMove() == 2);       // move [67,89]
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 67 | 89 |    |    |
+      //    +----+----+----+----+
+      assertUnit(v.numCapacity == 4);
+      assertUnit(v.numElements == 2);
+      if (v.data != nullptr)
+      {
+         assertUnit(v.data[0] == Spy(67));
+         assertUnit(v.data[1] == Spy(89));
+      }
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // an empty range erases nothing
+   void test_erase_rangeEmpty()
+   {  // setup
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      Spy::reset();
+      // exercise
+      v.erase(v.begin(), v.begin());
+      // verify
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertStandardFixture(v);
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // trivially copyable elements slide over in one block
+   void test_erase_trivial()
+   {  // setup
+      custom::vector<int> v{ 26, 49, 67, 89, 11 };
+      // exercise
+      v.erase(custom::vector<int>::iterator(v.data + 1), custom::vector<int>::iterator(v.data + 3));
+      // verify
+      assertUnit(v.numElements == 3);
+      assertUnit(v.numCapacity == 5);
+      assertUnit(v.data[0] == 26);
+      assertUnit(v.data[1] == 89);
+      assertUnit(v.data[2] == 11);
+   }  // teardown
+
+   /***************************************
+    * ERASE IF
+    ***************************************/
+
+   // nothing matches: nothing moves
+   void test_eraseIf_none()
+   {  // setup
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      Spy::reset();
+      // exercise
+      size_t num = v.erase_if([](const Spy& s) { return s.get() > 100; });
+      // verify
+      assertUnit(num == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertStandardFixture(v);
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // the keepers stay in order
+   void test_eraseIf_standard()
+   {  // setup
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 26 | 49 | 67 | 89 |
+      //    +----+----+----+----+
+      custom::vector<Spy> v;
+      setupStandardFixture(v);
+      Spy::reset();
+      // exercise
+      size_t num = v.erase_if([](const Spy& s) { return s.get() % 2 == 1; });
+      // verify
+      assertUnit(num == 3);
+      assertUnit(Spy::numAssignMove() == 0);     // [26] never moves
+      assertUnit(Spy::numDestructor() == 3);     // [49,67,89]
+      assertUnit(Spy::numAlloc() == 0);
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    | 26 |    |    |    |
+      //    +----+----+----+----+
+      assertUnit(v.numCapacity == 4);
+      assertUnit(v.numElements == 1);
+      if (v.data != nullptr)
+         assertUnit(v.data[0] == Spy(26));
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // numbers go through the branch-free compaction
+   void test_eraseIf_trivial()
+   {  // setup
+      custom::vector<int> v;
+      for (int i = 0; i < 100; i++)
+         v.push_back(i);
+      // exercise
+      size_t num = v.erase_if([](int i) { return i % 3 == 0; });
+      // verify
+      assertUnit(num == 34);
+      assertUnit(v.numElements == 66);
+      bool ordered = true;
+      for (size_t i = 0; i < v.numElements; i++)
+         ordered = ordered && v.data[i] == (int)(i / 2 * 3 + i % 2 + 1);
+      assertUnit(ordered);
+   }  // teardown
+
+   /***************************************
+    * INPUT / OUTPUT
+    ***************************************/
+
+   // what write_to writes, read_from reads back
+   void test_writeTo_readFrom_roundTrip()
+   {  // setup
+      std::FILE* file = std::tmpfile();
+      custom::vector<int> vSrc{ 26, 49, 67, 89 };
+      custom::vector<int> vDest;
+      // exercise
+      size_t numWritten = vSrc.write_to(fdOf(file));
+      std::fseek(file, 0, SEEK_SET);
+      size_t numRead = vDest.read_from(fdOf(file), 10);
+      size_t numCapacity = vDest.numCapacity;
+      size_t numAfter = vDest.read_from(fdOf(file), 10);
+      // verify
+      assertUnit(numWritten == 4);
+      assertUnit(numRead == 4);
+      assertUnit(numCapacity == 10);
+      assertUnit(numAfter == 0);
+      assertUnit(vDest.numElements == 4);
+      assertUnit(vDest.data[0] == 26);
+      assertUnit(vDest.data[3] == 89);
+      // teardown
+      std::fclose(file);
+   }
+
+   // read_from stops at num and adds after the last element
+   void test_readFrom_appends()
+   {  // setup
+      std::FILE* file = std::tmpfile();
+      custom::vector<int> vSrc{ 26, 49, 67, 89 };
+      vSrc.write_to(fdOf(file));
+      std::fseek(file, 0, SEEK_SET);
+      custom::vector<int> v{ 11 };
+      // exercise
+      size_t numRead = v.read_from(fdOf(file), 2);
+      // verify
+      assertUnit(numRead == 2);
+      assertUnit(v.numElements == 3);
+      assertUnit(v.numCapacity == 3);
+      assertUnit(v.data[0] == 11);
+      assertUnit(v.data[1] == 26);
+      assertUnit(v.data[2] == 49);
+      // teardown
+      std::fclose(file);
+   }
+
+   // a file that ends part way through an element is an error, but
+   // the whole elements before it are kept
+   void test_readFrom_partialElement()
+   {  // setup
+      std::FILE* file = std::tmpfile();
+      custom::vector<int> vSrc{ 26, 49 };
+      vSrc.write_to(fdOf(file));
+      custom::vector<char> half{ 1, 2 };
+      half.write_to(fdOf(file));                // 2.5 elements in all
+      std::fseek(file, 0, SEEK_SET);
+      custom::vector<int> v;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         v.read_from(fdOf(file), 10);
+      }
+      catch (const std::runtime_error&)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(v.numElements == 2);
+      assertUnit(v.data[0] == 26);
+      assertUnit(v.data[1] == 49);
+      // teardown
+      std::fclose(file);
+   }
+
+   // a bad file descriptor throws with errno
+   void test_writeTo_badFd()
+   {  // setup
+      custom::vector<int> v{ 26 };
+      bool thrown = false;
+      // exercise
+      try
+      {
+         v.write_to(-1);
+      }
+      catch (const std::system_error&)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   /*************************************************************
+    * FD OF
+    * The file descriptor underneath a FILE
+    *************************************************************/
+   static int fdOf(std::FILE* file)
+   {
+#ifdef _WIN32
+      return _fileno(file);
+#else
+      return fileno(file);
+#endif
+   }
+
+   /***************************************
+    * ALLOCATOR
+    ***************************************/
+
+   // a copy keeps the allocator, which does not ask for anything else
+   void test_constructCopy_keepsAllocator()
+   {  // setup
+      custom::vector<int, TaggedAllocator<int>> vSrc(TaggedAllocator<int>(7));
+      vSrc.push_back(26);
+      vSrc.push_back(49);
+      // exercise
+      custom::vector<int, TaggedAllocator<int>> vDest(vSrc);
+      // verify
+      assertUnit(vDest.alloc.tag == 7);
+      assertUnit(vDest.numElements == 2);
+      assertUnit(vDest.data != vSrc.data);
+      assertUnit(vDest.data[0] == 26);
+      assertUnit(vDest.data[1] == 49);
+   }  // teardown
+
+   // copy assignment takes the allocator when it propagates
+   void test_assign_propagatesAllocator()
+   {  // setup
+      custom::vector<int, TaggedAllocator<int>> vSrc(TaggedAllocator<int>(2));
+      custom::vector<int, TaggedAllocator<int>> vDest(TaggedAllocator<int>(1));
+      vSrc.push_back(26);
+      vDest.push_back(99);
+      vDest.push_back(99);
+      vDest.push_back(99);
+      // exercise
+      vDest = vSrc;
+      // verify
+      assertUnit(vDest.alloc.tag == 2);
+      assertUnit(vDest.numElements == 1);
+      assertUnit(vDest.numCapacity == 1);
+      assertUnit(vDest.data[0] == 26);
+      assertUnit(vSrc.alloc.tag == 2);
+   }  // teardown
+
+   // swap swaps the allocators too when they propagate
+   void test_swap_propagatesAllocator()
+   {  // setup
+      custom::vector<int, TaggedAllocator<int>> vSrc(TaggedAllocator<int>(2));
+      custom::vector<int, TaggedAllocator<int>> vDest(TaggedAllocator<int>(1));
+      vSrc.push_back(26);
+      // exercise
+      vDest.swap(vSrc);
+      // verify
+      assertUnit(vDest.alloc.tag == 2);
+      assertUnit(vSrc.alloc.tag == 1);
+      assertUnit(vDest.numElements == 1);
+      assertUnit(vSrc.empty());
+   }  // teardown
+
+   // a pmr vector gets its memory from the resource
+   void test_pmr_usesResource()
+   {  // setup
+      alignas(16) unsigned char buffer[256];
+      std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                                   std::pmr::null_memory_resource());
+      // exercise
+      custom::pmr::vector<int> v(&resource);
+      v.push_back(26);
+      v.push_back(49);
+      v.push_back(67);
+      // verify
+      assertUnit(v.get_allocator().resource() == &resource);
+      assertUnit(inBuffer(v.data, buffer, sizeof(buffer)));
+      assertUnit(v.numElements == 3);
+      assertUnit(v.data[2] == 67);
+   }  // teardown
+
+   // polymorphic_allocator says a copy uses the default resource
+   void test_pmr_constructCopy_defaultResource()
+   {  // setup
+      alignas(16) unsigned char buffer[256];
+      std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer));
+      custom::pmr::vector<int> vSrc(&resource);
+      vSrc.push_back(26);
+      // exercise
+      custom::pmr::vector<int> vDest(vSrc);
+      // verify
+      assertUnit(vDest.get_allocator().resource() == std::pmr::get_default_resource());
+      assertUnit(!inBuffer(vDest.data, buffer, sizeof(buffer)));
+      assertUnit(vDest.numElements == 1);
+      assertUnit(vDest.data[0] == 26);
+   }  // teardown
+
+   // the same resource: moving takes the buffer
+   void test_pmr_assignMove_sameResource()
+   {  // setup
+      alignas(16) unsigned char buffer[256];
+      std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                                   std::pmr::null_memory_resource());
+      custom::pmr::vector<int> vSrc(&resource);
+      custom::pmr::vector<int> vDest(&resource);
+      vSrc.push_back(26);
+      vSrc.push_back(49);
+      int* dataSrc = vSrc.data;
+      // exercise
+      vDest = std::move(vSrc);
+      // verify
+      assertUnit(vDest.data == dataSrc);
+      assertUnit(vDest.numElements == 2);
+      assertUnit(vSrc.data == nullptr);
+      assertUnit(vSrc.numElements == 0);
+      assertUnit(vSrc.numCapacity == 0);
+   }  // teardown
+
+   // different resources: the elements move, but the buffer stays put
+   void test_pmr_assignMove_otherResource()
+   {  // setup
+      alignas(16) unsigned char bufferSrc[256];
+      alignas(16) unsigned char bufferDest[256];
+      std::pmr::monotonic_buffer_resource resourceSrc(bufferSrc, sizeof(bufferSrc),
+                                                      std::pmr::null_memory_resource());
+      std::pmr::monotonic_buffer_resource resourceDest(bufferDest, sizeof(bufferDest),
+                                                       std::pmr::null_memory_resource());
+      custom::pmr::vector<int> vSrc(&resourceSrc);
+      custom::pmr::vector<int> vDest(&resourceDest);
+      vSrc.push_back(26);
+      vSrc.push_back(49);
+      // exercise
+      vDest = std::move(vSrc);
+      // verify
+      assertUnit(vDest.get_allocator().resource() == &resourceDest);
+      assertUnit(inBuffer(vDest.data, bufferDest, sizeof(bufferDest)));
+      assertUnit(vDest.numElements == 2);
+      assertUnit(vDest.data[0] == 26);
+      assertUnit(vDest.data[1] == 49);
+      assertUnit(vSrc.numElements == 0);
+   }  // teardown
+
+   /*************************************************************
+    * IN BUFFER
+    * Does the pointer point into this buffer?
+    *************************************************************/
+   template <class T>
+   bool inBuffer(const T* p, const unsigned char* buffer, size_t size)
+   {
+      const unsigned char* bytes = reinterpret_cast<const unsigned char*>(p);
+      return p != nullptr && bytes >= buffer && bytes < buffer + size;
+   }
+
+   /*************************************************************
+    * TAGGED ALLOCATOR
+    * A stateful allocator that propagates on copy, move and
+    * swap.  Two are equal when they have the same tag.
+    *************************************************************/
+   template <class T>
+   class TaggedAllocator
+   {
+   public:
+      using value_type = T;
+      using propagate_on_container_copy_assignment = std::true_type;
+      using propagate_on_container_move_assignment = std::true_type;
+      using propagate_on_container_swap            = std::true_type;
+
+      TaggedAllocator(int tag = 0) : tag(tag) {}
+      template <class U>
+      TaggedAllocator(const TaggedAllocator<U>& rhs) : tag(rhs.tag) {}
+
+      T* allocate(size_t num)           { return std::allocator<T>().allocate(num); }
+      void deallocate(T* p, size_t num) { std::allocator<T>().deallocate(p, num);   }
+
+      bool operator == (const TaggedAllocator& rhs) const { return tag == rhs.tag; }
+      bool operator != (const TaggedAllocator& rhs) const { return tag != rhs.tag; }
+
+      int tag;
+   };
+
+   /*************************************************************
+    * GROWING ALLOCATOR
+    * The C heap, offering try_expand and reallocate.  Every
+    * block has room for ROOM, so try_expand can honestly say
+    * yes up to that, when the test lets it.  Both count how
+    * often they are asked.
+    *************************************************************/
+   template <class T>
+   class GrowingAllocator
+   {
+   public:
+      using value_type = T;
+
+      GrowingAllocator() {}
+      template <class U>
+      GrowingAllocator(const GrowingAllocator<U>&) {}
+
+      static const size_t ROOM = 16;
+
+      T* allocate(size_t num)
+      {
+         return static_cast<T*>(std::malloc((num < ROOM ? ROOM : num) * sizeof(T)));
+      }
+      void deallocate(T* p, size_t) { std::free(p); }
+
+      bool try_expand(T*, size_t, size_t numNew)
+      {
+         numExpand++;
+         return canExpand && numNew <= ROOM;
+      }
+      T* reallocate(T* p, size_t, size_t numNew)
+      {
+         numReallocate++;
+         return static_cast<T*>(std::realloc(p, numNew * sizeof(T)));
+      }
+
+      bool operator == (const GrowingAllocator&) const { return true;  }
+      bool operator != (const GrowingAllocator&) const { return false; }
+
+      static void reset(bool expand)
+      {
+         canExpand = expand;
+         numExpand = 0;
+         numReallocate = 0;
+      }
+
+      static inline bool canExpand = false;
+      static inline int  numExpand = 0;
+      static inline int  numReallocate = 0;
+   };
+
    /*************************************************************
     * SETUP STANDARD FIXTURE
     *      0    1    2    3
@@ -2865,10 +3904,10 @@ public:
       try
       {
          v.data = v.alloc.allocate(4);
-         v.alloc.construct(&v.data[0], Spy(26));
-         v.alloc.construct(&v.data[1], Spy(49));
-         v.alloc.construct(&v.data[2], Spy(67));
-         v.alloc.construct(&v.data[3], Spy(89));
+         new (&v.data[0]) Spy(26);
+         new (&v.data[1]) Spy(49);
+         new (&v.data[2]) Spy(67);
+         new (&v.data[3]) Spy(89);
          v.numElements = 4;
          v.numCapacity = 4;
       }
@@ -2918,7 +3957,7 @@ public:
       if (v.data != nullptr && false)
       {
          for (size_t i = 0; i < v.numElements; i++)
-            v.alloc.destroy(&v.data[i]);
+            v.data[i].~Spy();
          v.alloc.deallocate(v.data, v.numCapacity);
 
       }
@@ -13,6 +13,7 @@
  *    This will contain the class definition of:
  *        vector                 : A class that represents a Vector
  *        vector::iterator       : An iterator through Vector
+ *        pmr::vector            : vector over a std::pmr::memory_resource
  * Author
  *    Nathan Bird
  *    Brock Hoskins
@@ -21,8 +22,16 @@
 #pragma once
 
 #include <cassert>  // because I am paranoid
+#include <cstring>  // for std::memmove, std::memcpy
+#include <functional>  // for std::less
 #include <new>      // std::bad_alloc
-#include <memory>   // for std::allocator
+#include <memory>   // for std::allocator, std::allocator_traits
+#include <memory_resource>  // for std::pmr::polymorphic_allocator
+#include <initializer_list> // for std::initializer_list
+#include <type_traits>      // for std::is_trivially_destructible
+#include <utility>          // for std::move, std::forward
+#include <stdexcept>        // for std::runtime_error
+#include "fd_io.h"          // for fd::read, fd::write
 
 class TestVector; // forward declaration for unit tests
 class TestStack;
@@ -43,8 +52,13 @@ namespace custom
       friend class ::TestStack;
       friend class ::TestPQueue;
       friend class ::TestHash;
+
+      using alloc_traits = std::allocator_traits<A>;
+
    public:
 
+      using allocator_type = A;
+
       //
       // Construct
       //
@@ -53,6 +67,7 @@ namespace custom
       vector(size_t numElements, const T& t, const A& a = A());
       vector(const std::initializer_list<T>& l, const A& a = A());
       vector(const vector& rhs);
+      vector(const vector& rhs, const A& a);
       vector(vector&& rhs);
       ~vector();
 
@@ -64,7 +79,13 @@ namespace custom
          std::swap(data, rhs.data);
          std::swap(numElements, rhs.numElements);
          std::swap(numCapacity, rhs.numCapacity);
-         std::swap(alloc, rhs.alloc);
+         if constexpr (alloc_traits::propagate_on_container_swap::value)
+         {
+            using std::swap;
+            swap(alloc, rhs.alloc);
+         }
+         else
+            assert(alloc == rhs.alloc);   // anything else is undefined, as in std::vector
       }
       vector& operator = (const vector& rhs);
       vector& operator = (vector&& rhs);
@@ -100,27 +121,45 @@ namespace custom
       void reserve(size_t newCapacity);
       void resize(size_t newElements);
       void resize(size_t newElements, const T& t);
+      void resize_for_overwrite(size_t newElements);
+      template <class Write>
+      size_t reserve_and_write(size_t num, Write write);
+      iterator insert(iterator pos, const T& t);
+      iterator insert(iterator pos, T&& t);
+      iterator insert(iterator pos, size_t num, const T& t);
+      size_t read_from(int fd, size_t num);
 
       //
       // Remove
       //
       void clear()
       {
-         // Destroy all elements
-         for (size_t i = 0; i < numElements; i++)
-            alloc.destroy(data + i);
-
-         numElements = 0;
+         truncate(0);
+      }
+      void truncate(size_t newElements)
+      {
+         if (newElements < numElements)
+         {
+            destroy(data + newElements, data + numElements);
+            numElements = newElements;
+         }
       }
       void pop_back()
       {
          if (numElements != 0)
          {
-            alloc.destroy(data + numElements - 1);
+            alloc_traits::destroy(alloc, data + numElements - 1);
             numElements--;
          }
       }
       void shrink_to_fit();
+      iterator erase(iterator pos)
+      {
+         return erase(pos, iterator(pos.p + 1));
+      }
+      iterator erase(iterator first, iterator last);
+      template <class Pred>
+      size_t erase_if(Pred pred);
 
       //
       // Status
@@ -128,9 +167,108 @@ namespace custom
       size_t  size()          const { return numElements;      }
       size_t  capacity()      const { return numCapacity;      }
       bool    empty()         const { return numElements == 0; }
+      A       get_allocator() const { return alloc;            }
+
+      //
+      // Output
+      //
+      size_t write_to(int fd) const;
 
    private:
 
+      // every use of the allocator goes through allocator_traits
+      T* allocate(size_t num)
+      {
+         return num != 0 ? alloc_traits::allocate(alloc, num) : nullptr;
+      }
+      void deallocate()
+      {
+         if (data != nullptr)
+            alloc_traits::deallocate(alloc, data, numCapacity);
+      }
+      template <class ... Args>
+      void construct(T* p, Args&& ... args)
+      {
+         alloc_traits::construct(alloc, p, std::forward<Args>(args)...);
+      }
+
+      // destroy [first, last); a no-op when T has a trivial destructor
+      void destroy(T* first, T* last)
+      {
+         if constexpr (!std::is_trivially_destructible<T>::value)
+            for (; first != last; first++)
+               alloc_traits::destroy(alloc, first);
+      }
+
+      // move [first, last) to dest, which may overlap it, leaving
+      // the source as raw memory.  One memmove if T is trivially copyable.
+      void relocate(T* first, T* last, T* dest);
+
+      // make room for num elements at index: raw memory, not yet counted
+      void openGap(size_t index, size_t num);
+
+      // an allocator may offer to grow a block where it is (try_expand),
+      // or to move it the way realloc does (reallocate); most do not
+      template <class Alloc>
+      static auto tryExpand(Alloc& a, T* p, size_t num, size_t numNew, int)
+         -> decltype(a.try_expand(p, num, numNew))
+      {
+         return a.try_expand(p, num, numNew);
+      }
+      template <class Alloc>
+      static bool tryExpand(Alloc&, T*, size_t, size_t, long)
+      {
+         return false;
+      }
+      template <class Alloc>
+      static auto reallocate(Alloc& a, T* p, size_t num, size_t numNew, int)
+         -> decltype(a.reallocate(p, num, numNew))
+      {
+         return a.reallocate(p, num, numNew);
+      }
+      template <class Alloc>
+      static T* reallocate(Alloc&, T*, size_t, size_t, long)
+      {
+         return nullptr;
+      }
+
+      // an allocator that rounds blocks up (to whole cache lines, say)
+      // may say how many elements a block for num really holds.  Every
+      // allocation asks, so the capacity does not depend on how the
+      // vector was made
+      template <class Alloc>
+      static auto goodSize(const Alloc& a, size_t num, int)
+         -> decltype(a.good_size(num))
+      {
+         return a.good_size(num);
+      }
+      template <class Alloc>
+      static size_t goodSize(const Alloc&, size_t num, long)
+      {
+         return num;
+      }
+      size_t capacityFor(size_t num) const
+      {
+         return num != 0 ? goodSize(alloc, num, 0) : 0;
+      }
+
+      // make sure num more elements fit, growing as push_back grows
+      void reserveMore(size_t num)
+      {
+         if (numElements + num > numCapacity)
+         {
+            size_t newCapacity = numCapacity * 2;
+            reserve(newCapacity < numElements + num ? numElements + num : newCapacity);
+         }
+      }
+
+      // is p one of our elements?
+      bool isElement(const T* p) const
+      {
+         std::less<const T*> less;
+         return !less(p, data) && less(p, data + numElements);
+      }
+
       A  alloc;                  // use allocator for memory allocation
       T* data;                   // user data, a dynamically-allocated array
       size_t  numCapacity;       // the capacity of the array
@@ -151,6 +289,7 @@ namespace custom
    template <typename T, typename A>
    class vector <T, A> ::iterator
    {
+      friend class vector <T, A>;
       friend class ::TestVector; // give unit tests access to the privates
       friend class ::TestStack;
       friend class ::TestPQueue;
@@ -160,7 +299,7 @@ namespace custom
       iterator() : p(nullptr) {}
       iterator(T* p) : p(p) {}
       iterator(const iterator& rhs) : p(rhs.p) {}
-      iterator(size_t index, vector<T>& v) : p(v.data + index) { }
+      iterator(size_t index, vector<T, A>& v) : p(v.data + index) { }
       iterator& operator = (const iterator& rhs)
       {
          p = rhs.p;
@@ -222,12 +361,9 @@ namespace custom
     * construct each element, and copy the values over
     ****************************************/
    template <typename T, typename A>
-   vector <T, A> ::vector(const A& a)
+   vector <T, A> ::vector(const A& a) :
+      alloc(a), data(nullptr), numCapacity(0), numElements(0)
    {
-      alloc = a;
-      data = nullptr;
-      numElements = 0;
-      numCapacity = 0;
    }
 
 
@@ -237,15 +373,13 @@ namespace custom
     * construct each element, and copy the values over
     ****************************************/
    template <typename T, typename A>
-   vector <T, A> ::vector(size_t num, const T& t, const A& a)
+   vector <T, A> ::vector(size_t num, const T& t, const A& a) :
+      alloc(a), data(nullptr), numCapacity(capacityFor(num)), numElements(num)
    {
-      alloc = a;
-      numElements = num;
-      numCapacity = num;
-      data = alloc.allocate(num);
-      for (int i = 0; i < num; i++)
+      data = allocate(numCapacity);
+      for (size_t i = 0; i < num; i++)
       {
-         alloc.construct(data + i, t);
+         construct(data + i, t);
       }
    }
 
@@ -254,17 +388,15 @@ namespace custom
     * Create a vector with an initialization list.
     ****************************************/
    template <typename T, typename A>
-   vector <T, A> ::vector(const std::initializer_list<T>& l, const A& a)
+   vector <T, A> ::vector(const std::initializer_list<T>& l, const A& a) :
+      alloc(a), data(nullptr), numCapacity(capacityFor(l.size())), numElements(l.size())
    {
-      alloc = a;
-      numElements = l.size();
-      numCapacity = l.size();
-      data = alloc.allocate(l.size());
+      data = allocate(numCapacity);
 
       T* current = data;
       for (auto it = l.begin(); it != l.end(); it++, current++)
       {
-         alloc.construct(current, *it);
+         construct(current, *it);
       }
    }
 
@@ -274,41 +406,46 @@ namespace custom
     * construct each element, and copy the values over
     ****************************************/
    template <typename T, typename A>
-   vector <T, A> ::vector(size_t num, const A& a)
+   vector <T, A> ::vector(size_t num, const A& a) :
+      alloc(a), data(nullptr), numCapacity(capacityFor(num)), numElements(num)
    {
-      alloc = a;
-      numElements = num;
-      numCapacity = num;
-      data = alloc.allocate(num);
-      for (int i = 0; i < num; i++)
+      data = allocate(numCapacity);
+      for (size_t i = 0; i < num; i++)
       {
-         alloc.construct(data + i);
+         construct(data + i);
       }
    }
 
    /*****************************************
     * VECTOR :: COPY CONSTRUCTOR
     * Allocate the space for numElements and
-    * call the copy constructor on each element
+    * call the copy constructor on each element,
+    * or copy them in one go if they are just bytes.
+    * The allocator decides what a copy of it is.
     ****************************************/
    template <typename T, typename A>
-   vector <T, A> ::vector(const vector& rhs)
+   vector <T, A> ::vector(const vector& rhs) :
+      vector(rhs, alloc_traits::select_on_container_copy_construction(rhs.alloc))
+   {
+   }
+
+   template <typename T, typename A>
+   vector <T, A> ::vector(const vector& rhs, const A& a) :
+      alloc(a), data(nullptr), numCapacity(0), numElements(0)
    {
       if (!rhs.empty())
       {
-         data = alloc.allocate(rhs.numElements);
-         numCapacity = rhs.numElements;
+         numCapacity = capacityFor(rhs.numElements);
+         data = allocate(numCapacity);
          numElements = rhs.numElements;
-         for (int i = 0; i < numElements; i++)
-         {
-            alloc.construct(data + i, rhs.data[i]);
-         }
-      }
-      else
-      {
-         data = nullptr;
-         numElements = 0;
-         numCapacity = 0;
+         if constexpr (std::is_trivially_copyable<T>::value)
+            std::memcpy(static_cast<void*>(data), static_cast<const void*>(rhs.data),
+                        numElements * sizeof(T));
+         else
+            for (size_t i = 0; i < numElements; i++)
+            {
+               construct(data + i, rhs.data[i]);
+            }
       }
    }
 
@@ -317,7 +454,8 @@ namespace custom
     * Steal the values from the RHS and set it to zero.
     ****************************************/
    template <typename T, typename A>
-   vector <T, A> ::vector(vector&& rhs)
+   vector <T, A> ::vector(vector&& rhs) :
+      alloc(std::move(rhs.alloc))
    {
       data = rhs.data;
       rhs.data = nullptr;
@@ -335,11 +473,8 @@ namespace custom
    template <typename T, typename A>
    vector <T, A> :: ~vector()
    {
-      for (int i = 0; i < numElements; i++)
-      {
-         alloc.destroy(data + i);
-      }
-      alloc.deallocate(data, numCapacity);
+      destroy(data, data + numElements);
+      deallocate();
    }
 
    /***************************************
@@ -354,17 +489,14 @@ namespace custom
    {
       if (newElements < numElements)
       {
-         for (size_t i = newElements; i < numElements; i++)
-         {
-            alloc.destroy(data + i);
-         }
+         destroy(data + newElements, data + numElements);
       }
       else if (newElements > numElements)
       {
          if (newElements > numCapacity)
             reserve(newElements);
          for (size_t i = numElements; i < newElements; i++)
-            alloc.construct(data + i);
+            construct(data + i);
       }
       numElements = newElements;
    }
@@ -374,15 +506,14 @@ namespace custom
    {
       if (newElements < numElements)
       {
-         for (size_t i = newElements; i < numElements; i++)
-            alloc.destroy(data + i);
+         destroy(data + newElements, data + numElements);
       }
       else if (newElements > numElements)
       {
          if (newElements > numCapacity)
             reserve(newElements);
          for (size_t i = numElements; i < newElements; i++)
-            alloc.construct(data + i, t);
+            construct(data + i, t);
       }
       numElements = newElements;
    }
@@ -391,7 +522,12 @@ namespace custom
     * VECTOR :: RESERVE
     * This method will grow the current buffer
     * to newCapacity.  It will also copy all
-    * the data from the old buffer into the new
+    * the data from the old buffer into the new.
+    * First ask the allocator whether the block can
+    * grow where it is, and, if the elements are just
+    * bytes, whether it can move them itself.  An
+    * allocator that pads its blocks may round the
+    * capacity up to what the block really holds.
     *     INPUT  : newCapacity the size of the new buffer
     *     OUTPUT :
     **************************************/
@@ -400,14 +536,281 @@ namespace custom
    {
       if (newCapacity <= numCapacity)
          return;
+      newCapacity = capacityFor(newCapacity);
+
+      if (data != nullptr)
+      {
+         if (tryExpand(alloc, data, numCapacity, newCapacity, 0))
+         {
+            numCapacity = newCapacity;
+            return;
+         }
+         if constexpr (std::is_trivially_copyable<T>::value)
+         {
+            T* dataMoved = reallocate(alloc, data, numCapacity, newCapacity, 0);
+            if (dataMoved != nullptr)
+            {
+               data = dataMoved;
+               numCapacity = newCapacity;
+               return;
+            }
+         }
+      }
+
+      T* dataNew = allocate(newCapacity);
+      relocate(data, data + numElements, dataNew);
+      deallocate();
+
+      data = dataNew;
+      numCapacity = newCapacity;
+   }
+
+   /***************************************
+    * VECTOR :: RESIZE FOR OVERWRITE
+    * Like resize(), but new elements are default-initialized:
+    * a number or a plain struct is left as whatever the memory
+    * held, ready for read() or memcpy to fill it in.
+    *     INPUT  : newElements the new size
+    **************************************/
+   template <typename T, typename A>
+   void vector <T, A> ::resize_for_overwrite(size_t newElements)
+   {
+      if (newElements < numElements)
+      {
+         destroy(data + newElements, data + numElements);
+      }
+      else if (newElements > numElements)
+      {
+         if (newElements > numCapacity)
+            reserve(newElements);
+         if constexpr (!std::is_trivially_default_constructible<T>::value)
+            for (size_t i = numElements; i < newElements; i++)
+               construct(data + i);
+      }
+      numElements = newElements;
+   }
+
+   /***************************************
+    * VECTOR :: RESERVE AND WRITE
+    * Make room for num more elements after the last, let
+    * write(first, num) fill in some of them, and keep however
+    * many it says it wrote.  Capacity grows the way push_back
+    * grows it, so writing a little at a time stays cheap.
+    *     INPUT  : num   the most write() may write
+    *              write callable as write(T* first, size_t num),
+    *                    returning how many it wrote
+    *     OUTPUT : how many were written
+    **************************************/
+   template <typename T, typename A>
+   template <class Write>
+   size_t vector <T, A> ::reserve_and_write(size_t num, Write write)
+   {
+      static_assert(std::is_trivial<T>::value,
+                    "reserve_and_write hands out raw memory, so T must be trivial");
+      reserveMore(num);
+      size_t numWritten = write(data + numElements, num);
+      assert(numWritten <= num);
+      numElements += numWritten;
+      return numWritten;
+   }
+
+   /***************************************
+    * VECTOR :: READ FROM
+    * Read up to num elements from a file descriptor straight
+    * into the space after the last one.  Fewer arrive only when
+    * the file ends.  If it ends part way through one, the whole
+    * ones before it are kept (the file has moved past them) and
+    * then this throws.
+    *     INPUT  : fd  where to read
+    *              num the most elements to read
+    *     OUTPUT : how many were read, zero at the end of the file
+    **************************************/
+   template <typename T, typename A>
+   size_t vector <T, A> ::read_from(int fd, size_t num)
+   {
+      static_assert(std::is_trivially_copyable<T>::value,
+                    "read_from copies bytes, so T must be trivially copyable");
+      reserveMore(num);
+      size_t numBytes = fd::read(fd, data + numElements, num * sizeof(T));
+      numElements += numBytes / sizeof(T);
+      if (numBytes % sizeof(T) != 0)
+         throw std::runtime_error("vector::read_from: the file ends inside an element");
+      return numBytes / sizeof(T);
+   }
+
+   /***************************************
+    * VECTOR :: WRITE TO
+    * Write every element, first to last, to a file descriptor
+    *     INPUT  : fd where to write
+    *     OUTPUT : how many were written
+    **************************************/
+   template <typename T, typename A>
+   size_t vector <T, A> ::write_to(int fd) const
+   {
+      static_assert(std::is_trivially_copyable<T>::value,
+                    "write_to copies bytes, so T must be trivially copyable");
+      if (numElements != 0)
+         fd::write(fd, data, numElements * sizeof(T));
+      return numElements;
+   }
+
+   /***************************************
+    * VECTOR :: INSERT
+    * Put t in front of pos, sliding everything after it
+    * back one.  t may be one of our own elements.
+    *     INPUT  : pos where the new element goes
+    *              t   the new element
+    *     OUTPUT : the new element
+    **************************************/
+   template <typename T, typename A>
+   typename vector <T, A> ::iterator vector <T, A> ::insert(iterator pos, const T& t)
+   {
+      if (isElement(&t))
+      {
+         T copy(t);
+         return insert(pos, std::move(copy));
+      }
+      size_t index = pos.p - data;
+      openGap(index, 1);
+      construct(data + index, t);
+      numElements++;
+      return iterator(data + index);
+   }
+
+   template <typename T, typename A>
+   typename vector <T, A> ::iterator vector <T, A> ::insert(iterator pos, T&& t)
+   {
+      size_t index = pos.p - data;
+      openGap(index, 1);
+      construct(data + index, std::move(t));
+      numElements++;
+      return iterator(data + index);
+   }
+
+   template <typename T, typename A>
+   typename vector <T, A> ::iterator vector <T, A> ::insert(iterator pos, size_t num, const T& t)
+   {
+      if (isElement(&t))
+      {
+         T copy(t);
+         return insert(pos, num, copy);
+      }
+      size_t index = pos.p - data;
+      openGap(index, num);
+      for (size_t i = 0; i < num; i++)
+         construct(data + index + i, t);
+      numElements += num;
+      return iterator(data + index);
+   }
+
+   /***************************************
+    * VECTOR :: ERASE
+    * Remove [first, last), sliding everything after it forward
+    *     INPUT  : first the first element to go
+    *              last  the element after the last to go
+    *     OUTPUT : the element that took first's place
+    **************************************/
+   template <typename T, typename A>
+   typename vector <T, A> ::iterator vector <T, A> ::erase(iterator first, iterator last)
+   {
+      size_t index = first.p - data;
+      size_t num = last.p - first.p;
+      destroy(first.p, last.p);
+      relocate(last.p, data + numElements, first.p);
+      numElements -= num;
+      return iterator(data + index);
+   }
+
+   /***************************************
+    * VECTOR :: ERASE IF
+    * Remove every element pred is true for, keeping the rest
+    * in order.  Numbers are compacted without a branch: every
+    * one is copied down and the write position only moves past
+    * the keepers, so an unpredictable pred costs nothing extra.
+    *     INPUT  : pred true for the elements to remove
+    *     OUTPUT : how many were removed
+    **************************************/
+   template <typename T, typename A>
+   template <class Pred>
+   size_t vector <T, A> ::erase_if(Pred pred)
+   {
+      // nothing moves before the first one to go
+      size_t iRead = 0;
+      while (iRead < numElements && !pred(data[iRead]))
+         iRead++;
+      if (iRead == numElements)
+         return 0;
+
+      size_t iWrite = iRead;
+      if constexpr (std::is_arithmetic<T>::value)
+         for (iRead++; iRead < numElements; iRead++)
+         {
+            T value = data[iRead];
+            data[iWrite] = value;
+            iWrite += !pred(value);
+         }
+      else
+         for (iRead++; iRead < numElements; iRead++)
+            if (!pred(data[iRead]))
+               data[iWrite++] = std::move(data[iRead]);
+
+      size_t numErased = numElements - iWrite;
+      truncate(iWrite);
+      return numErased;
+   }
+
+   /***************************************
+    * VECTOR :: RELOCATE
+    * Move-construct each element at its new home and destroy
+    * the old one, walking in whichever direction is safe when
+    * the two ranges overlap
+    **************************************/
+   template <typename T, typename A>
+   void vector <T, A> ::relocate(T* first, T* last, T* dest)
+   {
+      if (first == last || first == dest)
+         return;
+      if constexpr (std::is_trivially_copyable<T>::value)
+         std::memmove(static_cast<void*>(dest), static_cast<const void*>(first),
+                      (last - first) * sizeof(T));
+      else if (dest < first)
+         for (; first != last; first++, dest++)
+         {
+            construct(dest, std::move(*first));
+            alloc_traits::destroy(alloc, first);
+         }
+      else
+         for (T* destLast = dest + (last - first); last != first; )
+         {
+            --last;
+            --destLast;
+            construct(destLast, std::move(*last));
+            alloc_traits::destroy(alloc, last);
+         }
+   }
 
-      T* dataNew = alloc.allocate(newCapacity);
-      for (size_t i = 0; i < numElements; i++)
+   /***************************************
+    * VECTOR :: OPEN GAP
+    * Leave num raw slots at index.  When that needs a bigger
+    * buffer, each half goes straight to its place in the new one.
+    **************************************/
+   template <typename T, typename A>
+   void vector <T, A> ::openGap(size_t index, size_t num)
+   {
+      if (numElements + num <= numCapacity)
       {
-         alloc.construct(dataNew + i, std::move(data[i]));
-         alloc.destroy(data + i);
+         relocate(data + index, data + numElements, data + index + num);
+         return;
       }
-      alloc.deallocate(data, numCapacity);
+
+      size_t newCapacity = numCapacity * 2;
+      if (newCapacity < numElements + num)
+         newCapacity = numElements + num;
+      newCapacity = capacityFor(newCapacity);
+      T* dataNew = allocate(newCapacity);
+      relocate(data, data + index, dataNew);
+      relocate(data + index, data + numElements, dataNew + index + num);
+      deallocate();
 
       data = dataNew;
       numCapacity = newCapacity;
@@ -422,26 +825,27 @@ namespace custom
    template <typename T, typename A>
    void vector <T, A> ::shrink_to_fit()
    {
-      // If we have excess capacity
-      if (numCapacity > numElements)
+      // If we have excess capacity (past what the allocator rounds up to)
+      size_t fit = capacityFor(numElements);
+      if (numCapacity > fit)
       {
-         // If we have elements, reallocate to exact size
+         // If we have elements, reallocate to just what they need
          if (numElements > 0)
          {
-            T* newData = alloc.allocate(numElements);
+            T* newData = allocate(fit);
             for (size_t i = 0; i < numElements; i++)
             {
-               alloc.construct(newData + i, data[i]);
-               alloc.destroy(data + i);
+               construct(newData + i, data[i]);
+               alloc_traits::destroy(alloc, data + i);
             }
-            alloc.deallocate(data, numCapacity);
+            deallocate();
             data = newData;
-            numCapacity = numElements;
+            numCapacity = fit;
          }
          // If no elements, free all memory
          else
          {
-            alloc.deallocate(data, numCapacity);
+            deallocate();
             data = nullptr;
             numCapacity = 0;
          }
@@ -525,7 +929,7 @@ namespace custom
       {
          reserve((numCapacity != 0 ? numCapacity * 2 : 1));
       }
-      alloc.construct(data + numElements, t);
+      construct(data + numElements, t);
       numElements++;
    }
 
@@ -536,14 +940,16 @@ namespace custom
       {
          reserve((numCapacity != 0 ? numCapacity * 2 : 1));
       }
-      alloc.construct(data + numElements, std::move(t));
+      construct(data + numElements, std::move(t));
       numElements++;
    }
 
    /***************************************
     * VECTOR :: ASSIGNMENT
     * This operator will copy the contents of the
-    * rhs onto *this, growing the buffer as needed
+    * rhs onto *this, growing the buffer as needed.
+    * If the allocator propagates, we take rhs's, and a
+    * buffer the old one handed out goes back to it first.
     *     INPUT  : rhs the vector to copy from
     *     OUTPUT : *this
     **************************************/
@@ -553,22 +959,32 @@ namespace custom
       // Handle self-assignment
       if (this != &rhs)
       {
+         if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+         {
+            if (alloc != rhs.alloc)
+            {
+               clear();
+               deallocate();
+               data = nullptr;
+               numCapacity = 0;
+            }
+            alloc = rhs.alloc;
+         }
+
          // If we need more capacity
          if (numCapacity < rhs.numElements)
          {
             // Clear existing elements and reallocate
-            for (size_t i = 0; i < numElements; i++)
-               alloc.destroy(data + i);
-            if (data)
-               alloc.deallocate(data, numCapacity);
+            destroy(data, data + numElements);
+            deallocate();
 
             // Allocate new space
-            numCapacity = rhs.numElements;
-            data = alloc.allocate(numCapacity);
+            numCapacity = capacityFor(rhs.numElements);
+            data = allocate(numCapacity);
 
             // Copy construct all elements
             for (size_t i = 0; i < rhs.numElements; i++)
-               alloc.construct(data + i, rhs.data[i]);
+               construct(data + i, rhs.data[i]);
          }
          else
          {
@@ -579,14 +995,13 @@ namespace custom
             // If rhs is smaller, destroy excess elements
             if (rhs.numElements < numElements)
             {
-               for (size_t i = rhs.numElements; i < numElements; i++)
-                  alloc.destroy(data + i);
+               destroy(data + rhs.numElements, data + numElements);
             }
             // If rhs is larger, construct new elements
             else if (rhs.numElements > numElements)
             {
                for (size_t i = numElements; i < rhs.numElements; i++)
-                  alloc.construct(data + i, rhs.data[i]);
+                  construct(data + i, rhs.data[i]);
             }
          }
 
@@ -595,18 +1010,60 @@ namespace custom
 
       return *this;
    }
+
+   /***************************************
+    * VECTOR :: MOVE ASSIGNMENT
+    * Take rhs's buffer when our allocator can free it: it
+    * propagates, or the two are equal.  Otherwise the buffer
+    * belongs to someone else, so move the elements one by one.
+    *     INPUT  : rhs the vector to move from
+    *     OUTPUT : *this
+    **************************************/
    template <typename T, typename A>
    vector <T, A>& vector <T, A> :: operator = (vector&& rhs)
    {
+      if (this == &rhs)
+         return *this;
+
+      if constexpr (!alloc_traits::propagate_on_container_move_assignment::value &&
+                    !alloc_traits::is_always_equal::value)
+      {
+         if (alloc != rhs.alloc)
+         {
+            clear();
+            reserve(rhs.numElements);
+            for (size_t i = 0; i < rhs.numElements; i++)
+               construct(data + i, std::move(rhs.data[i]));
+            numElements = rhs.numElements;
+            rhs.clear();
+            return *this;
+         }
+      }
+
       clear();
-      shrink_to_fit();
-      swap(rhs);
+      deallocate();
+      if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+         alloc = std::move(rhs.alloc);
+
+      data = rhs.data;
+      rhs.data = nullptr;
+      numElements = rhs.numElements;
+      rhs.numElements = 0;
+      numCapacity = rhs.numCapacity;
+      rhs.numCapacity = 0;
 
       return *this;
    }
 
-
-
+   namespace pmr
+   {
+      /*****************************************
+       * PMR VECTOR
+       * A vector that gets its memory from a std::pmr::memory_resource
+       ****************************************/
+      template <typename T>
+      using vector = custom::vector<T, std::pmr::polymorphic_allocator<T>>;
+   }
 
 } // namespace custom
 